@@ -98,6 +98,8 @@ idCommon *			common = &commonLocal;
 
 void			Sys_Mkdir( const char *path ) {}
 ID_TIME_T		Sys_FileTimeStamp( FILE *fp ) { return 0; }
+const void *	Sys_MapFile( const char *path, int *length ) { return NULL; }
+void			Sys_UnmapFile( const void *data, int length ) {}
 ID_TIME_T       Sys_DosToUnixTime( unsigned long dostime ) { return 0; }
 
 #ifdef _WIN32
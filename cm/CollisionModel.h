@@ -126,6 +126,8 @@ public:
 	virtual void			ModelInfo( cmHandle_t model ) = 0;
 	// Lists all loaded models.
 	virtual void			ListModels( void ) = 0;
+	// Lists the build time of every model built from the map brushes and patches.
+	virtual void			ListBuildTimes( void ) = 0;
 	// Writes a collision model file for the given map entity.
 	virtual bool			WriteCollisionModelForMapEntity( const idMapEntity *mapEnt, const char *filename, const bool testTraceModel = true ) = 0;
 };
@@ -32,6 +32,12 @@
 #define CM_FILEID			"CM"
 #define CM_FILEVERSION		"1.00"
 
+#define CM_BINARY_FILE_EXT		"cmb"
+#define CM_BINARY_FILEID		"CMBinary"
+#define CM_BINARY_FILEVERSION	1
+
+idCVar cm_useBinaryFile( "cm_useBinaryFile", "1", CVAR_GAME | CVAR_BOOL, "load map collision models from a binary copy of the .cm file, written when the map is built or loaded from text" );
+
 
 /*
 ===============================================================================
@@ -517,8 +523,9 @@ bool idCollisionModelManagerLocal::ParseCollisionModel( idLexer *src ) {
 		src->Error( "ParseCollisionModel: bad token \"%s\"", token.c_str() );
 	}
 	// calculate edge normals
-	checkCount++;
+	buildCheckCount++;
 	CalculateEdgeNormals( model, model->node );
+	ClearBuildCheckCounts( model );
 	// get model bounds from brush and polygon bounds
 	CM_GetNodeBounds( &model->bounds, model->node );
 	// get model contents
@@ -545,6 +552,12 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, con
 	idToken token;
 	idLexer *src;
 	unsigned int crc;
+	int firstModel;
+
+	// the binary copy is only kept for map collision models which come with a geometry CRC
+	if ( mapFileCRC && cm_useBinaryFile.GetBool() && LoadBinaryCollisionModelFile( name, mapFileCRC ) ) {
+		return true;
+	}
 
 	// load it
 	fileName = name;
@@ -582,6 +595,7 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, con
 	}
 
 	// parse the file
+	firstModel = numModels;
 	while ( 1 ) {
 		if ( !src->ReadToken( &token ) ) {
 			break;
@@ -600,5 +614,463 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, con
 
 	delete src;
 
+	if ( mapFileCRC && cm_useBinaryFile.GetBool() ) {
+		WriteBinaryCollisionModelsToFile( name, firstModel, numModels, mapFileCRC );
+	}
+
+	return true;
+}
+
+
+/*
+===============================================================================
+
+Binary collision model cache
+
+The first build or text load of a map's collision models writes a binary copy
+next to the .cm file. The vertex and edge arrays are stored as they are in memory,
+polygons, brushes and materials are referenced by index and every node stores its
+polygon and brush references, so loading is a series of flat reads without any
+parsing or filtering into the tree. The file is only used while the map geometry
+CRC matches and ends with a CRC of its contents to reject broken files.
+
+===============================================================================
+*/
+
+/*
+================
+CM_PointerHashKey
+================
+*/
+static ID_INLINE int CM_PointerHashKey( const void *ptr ) {
+	return (int)( ( (intptr_t)ptr ) >> 4 );
+}
+
+/*
+================
+CM_BinaryFindPolygon
+================
+*/
+static int CM_BinaryFindPolygon( const cm_binaryModel_t &binary, const cm_polygon_t *p ) {
+	for ( int i = binary.polygonHash.First( CM_PointerHashKey( p ) ); i != -1; i = binary.polygonHash.Next( i ) ) {
+		if ( binary.polygons[i] == p ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+================
+CM_BinaryFindBrush
+================
+*/
+static int CM_BinaryFindBrush( const cm_binaryModel_t &binary, const cm_brush_t *b ) {
+	for ( int i = binary.brushHash.First( CM_PointerHashKey( b ) ); i != -1; i = binary.brushHash.Next( i ) ) {
+		if ( binary.brushes[i] == b ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+================
+CM_BinaryMaterialIndex
+
+Returns the index of the material in the material table, adding it if needed.
+================
+*/
+static int CM_BinaryMaterialIndex( cm_binaryModel_t &binary, const idMaterial *material ) {
+	if ( !material ) {
+		return -1;
+	}
+	for ( int i = binary.materialHash.First( CM_PointerHashKey( material ) ); i != -1; i = binary.materialHash.Next( i ) ) {
+		if ( binary.materials[i] == material ) {
+			return i;
+		}
+	}
+	int index = binary.materials.Append( material );
+	binary.materialHash.Add( CM_PointerHashKey( material ), index );
+	return index;
+}
+
+/*
+================
+idCollisionModelManagerLocal::CollectBinaryNodes_r
+
+Gathers the nodes in depth first order and all unique polygons and brushes in reference order.
+================
+*/
+void idCollisionModelManagerLocal::CollectBinaryNodes_r( cm_node_t *node, cm_binaryModel_t &binary ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+
+	while ( 1 ) {
+		binary.nodes.Append( node );
+		for ( pref = node->polygons; pref; pref = pref->next ) {
+			if ( CM_BinaryFindPolygon( binary, pref->p ) == -1 ) {
+				binary.polygonHash.Add( CM_PointerHashKey( pref->p ), binary.polygons.Append( pref->p ) );
+				binary.polygonMemory += sizeof( cm_polygon_t ) + ( pref->p->numEdges - 1 ) * sizeof( pref->p->edges[0] );
+			}
+		}
+		for ( bref = node->brushes; bref; bref = bref->next ) {
+			if ( CM_BinaryFindBrush( binary, bref->b ) == -1 ) {
+				binary.brushHash.Add( CM_PointerHashKey( bref->b ), binary.brushes.Append( bref->b ) );
+				binary.brushMemory += sizeof( cm_brush_t ) + ( bref->b->numPlanes - 1 ) * sizeof( bref->b->planes[0] );
+			}
+		}
+		if ( node->planeType == -1 ) {
+			break;
+		}
+		CollectBinaryNodes_r( node->children[0], binary );
+		node = node->children[1];
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModel
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModel( idFile *fp, cm_model_t *model ) {
+	cm_binaryModel_t binary;
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+	int i, numRefs;
+
+	binary.polygonMemory = 0;
+	binary.brushMemory = 0;
+	if ( model->node ) {
+		CollectBinaryNodes_r( model->node, binary );
+	}
+
+	// material indices are needed before the table can be written
+	idList<int> polygonMaterials, brushMaterials;
+	polygonMaterials.SetNum( binary.polygons.Num() );
+	for ( i = 0; i < binary.polygons.Num(); i++ ) {
+		polygonMaterials[i] = CM_BinaryMaterialIndex( binary, binary.polygons[i]->material );
+	}
+	brushMaterials.SetNum( binary.brushes.Num() );
+	for ( i = 0; i < binary.brushes.Num(); i++ ) {
+		brushMaterials[i] = CM_BinaryMaterialIndex( binary, binary.brushes[i]->material );
+	}
+
+	fp->WriteString( model->name );
+	fp->Write( &model->bounds, sizeof( model->bounds ) );
+	fp->WriteInt( model->contents );
+	fp->WriteBool( model->isConvex );
+	fp->WriteInt( model->numSharpEdges );
+	fp->WriteInt( model->numRemovedPolys );
+	fp->WriteInt( model->numMergedPolys );
+
+	// vertices and edges
+	fp->WriteInt( model->numVertices );
+	fp->Write( model->vertices, model->numVertices * sizeof( cm_vertex_t ) );
+	fp->WriteInt( model->numEdges );
+	fp->Write( model->edges, model->numEdges * sizeof( cm_edge_t ) );
+
+	// materials
+	fp->WriteInt( binary.materials.Num() );
+	for ( i = 0; i < binary.materials.Num(); i++ ) {
+		fp->WriteString( binary.materials[i]->GetName() );
+	}
+
+	// polygons
+	fp->WriteInt( binary.polygons.Num() );
+	fp->WriteInt( binary.polygonMemory );
+	for ( i = 0; i < binary.polygons.Num(); i++ ) {
+		const cm_polygon_t *p = binary.polygons[i];
+		fp->WriteInt( p->numEdges );
+		fp->Write( p->edges, p->numEdges * sizeof( p->edges[0] ) );
+		fp->Write( &p->plane, sizeof( p->plane ) );
+		fp->Write( &p->bounds, sizeof( p->bounds ) );
+		fp->WriteInt( p->contents );
+		fp->WriteInt( polygonMaterials[i] );
+	}
+
+	// brushes
+	fp->WriteInt( binary.brushes.Num() );
+	fp->WriteInt( binary.brushMemory );
+	for ( i = 0; i < binary.brushes.Num(); i++ ) {
+		const cm_brush_t *b = binary.brushes[i];
+		fp->WriteInt( b->numPlanes );
+		fp->Write( b->planes, b->numPlanes * sizeof( b->planes[0] ) );
+		fp->Write( &b->bounds, sizeof( b->bounds ) );
+		fp->WriteInt( b->contents );
+		fp->WriteInt( b->primitiveNum );
+		fp->WriteInt( brushMaterials[i] );
+	}
+
+	// nodes in depth first order with their references
+	fp->WriteInt( binary.nodes.Num() );
+	for ( i = 0; i < binary.nodes.Num(); i++ ) {
+		const cm_node_t *node = binary.nodes[i];
+		fp->WriteInt( node->planeType );
+		fp->WriteFloat( node->planeDist );
+		for ( numRefs = 0, pref = node->polygons; pref; pref = pref->next ) {
+			numRefs++;
+		}
+		fp->WriteInt( numRefs );
+		for ( pref = node->polygons; pref; pref = pref->next ) {
+			fp->WriteInt( CM_BinaryFindPolygon( binary, pref->p ) );
+		}
+		for ( numRefs = 0, bref = node->brushes; bref; bref = bref->next ) {
+			numRefs++;
+		}
+		fp->WriteInt( numRefs );
+		for ( bref = node->brushes; bref; bref = bref->next ) {
+			fp->WriteInt( CM_BinaryFindBrush( binary, bref->b ) );
+		}
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC ) {
+	idStr name;
+	int i;
+
+	name = filename;
+	name.SetFileExtension( CM_BINARY_FILE_EXT );
+
+	idFile_Memory fp( name );
+	fp.SetGranularity( 1 << 20 );
+
+	fp.WriteString( CM_BINARY_FILEID );
+	fp.WriteInt( CM_BINARY_FILEVERSION );
+	fp.WriteUnsignedInt( mapFileCRC );
+	// the vertex and edge arrays are stored as they are in memory
+	fp.WriteInt( sizeof( cm_vertex_t ) );
+	fp.WriteInt( sizeof( cm_edge_t ) );
+
+	fp.WriteInt( lastModel - firstModel );
+	for ( i = firstModel; i < lastModel; i++ ) {
+		WriteBinaryCollisionModel( &fp, models[i] );
+	}
+
+	fp.WriteUnsignedInt( CRC32_BlockChecksum( fp.GetDataPtr(), fp.Length() ) );
+
+	fileSystem->WriteFile( name, fp.GetDataPtr(), fp.Length() );
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryNodes_r
+================
+*/
+cm_node_t *idCollisionModelManagerLocal::ReadBinaryNodes_r( idFile *fp, cm_model_t *model, cm_node_t *parent, const cm_binaryModel_t &binary ) {
+	cm_node_t *node;
+	idList<int> refs;
+	int i, numRefs;
+
+	model->numNodes++;
+	node = AllocNode( model, model->numNodes < NODE_BLOCK_SIZE_SMALL ? NODE_BLOCK_SIZE_SMALL : NODE_BLOCK_SIZE_LARGE );
+	node->brushes = NULL;
+	node->polygons = NULL;
+	node->parent = parent;
+	fp->ReadInt( node->planeType );
+	fp->ReadFloat( node->planeDist );
+
+	// references are prepended so add them back to front to keep the original order
+	fp->ReadInt( numRefs );
+	refs.SetNum( numRefs );
+	fp->Read( refs.Ptr(), numRefs * sizeof( int ) );
+	for ( i = numRefs - 1; i >= 0; i-- ) {
+		AddPolygonToNode( model, node, binary.polygons[refs[i]] );
+	}
+	fp->ReadInt( numRefs );
+	refs.SetNum( numRefs );
+	fp->Read( refs.Ptr(), numRefs * sizeof( int ) );
+	for ( i = numRefs - 1; i >= 0; i-- ) {
+		AddBrushToNode( model, node, binary.brushes[refs[i]] );
+	}
+
+	if ( node->planeType != -1 ) {
+		node->children[0] = ReadBinaryNodes_r( fp, model, node, binary );
+		node->children[1] = ReadBinaryNodes_r( fp, model, node, binary );
+	}
+	return node;
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryCollisionModel
+================
+*/
+void idCollisionModelManagerLocal::ReadBinaryCollisionModel( idFile *fp ) {
+	cm_binaryModel_t binary;
+	cm_model_t *model;
+	idStr materialName;
+	int i, num, memory, numEdges, numPlanes, materialNum;
+
+	if ( numModels >= MAX_SUBMODELS ) {
+		common->Error( "LoadModel: no free slots" );
+		return;
+	}
+	model = AllocModel();
+	models[numModels] = model;
+	numModels++;
+
+	fp->ReadString( model->name );
+	fp->Read( &model->bounds, sizeof( model->bounds ) );
+	fp->ReadInt( model->contents );
+	fp->ReadBool( model->isConvex );
+	fp->ReadInt( model->numSharpEdges );
+	fp->ReadInt( model->numRemovedPolys );
+	fp->ReadInt( model->numMergedPolys );
+
+	// vertices
+	fp->ReadInt( model->numVertices );
+	model->maxVertices = model->numVertices;
+	model->vertices = (cm_vertex_t *) Mem_Alloc( model->maxVertices * sizeof( cm_vertex_t ) );
+	fp->Read( model->vertices, model->numVertices * sizeof( cm_vertex_t ) );
+	for ( i = 0; i < model->numVertices; i++ ) {
+		model->vertices[i].side = 0;
+		model->vertices[i].sideSet = 0;
+		model->vertices[i].checkcount = 0;
+	}
+
+	// edges, the stored normals are used as they are
+	fp->ReadInt( model->numEdges );
+	model->maxEdges = model->numEdges;
+	model->edges = (cm_edge_t *) Mem_Alloc( model->maxEdges * sizeof( cm_edge_t ) );
+	fp->Read( model->edges, model->numEdges * sizeof( cm_edge_t ) );
+	for ( i = 0; i < model->numEdges; i++ ) {
+		model->edges[i].side = 0;
+		model->edges[i].sideSet = 0;
+		model->edges[i].checkcount = 0;
+		model->numInternalEdges += model->edges[i].internal;
+	}
+
+	// materials
+	fp->ReadInt( num );
+	binary.materials.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		fp->ReadString( materialName );
+		binary.materials[i] = declManager->FindMaterial( materialName );
+	}
+
+	// polygons
+	fp->ReadInt( num );
+	fp->ReadInt( memory );
+	model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc( sizeof( cm_polygonBlock_t ) + memory );
+	model->polygonBlock->bytesRemaining = memory;
+	model->polygonBlock->next = ( (byte *) model->polygonBlock ) + sizeof( cm_polygonBlock_t );
+	binary.polygons.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		fp->ReadInt( numEdges );
+		cm_polygon_t *p = AllocPolygon( model, numEdges );
+		p->numEdges = numEdges;
+		fp->Read( p->edges, numEdges * sizeof( p->edges[0] ) );
+		fp->Read( &p->plane, sizeof( p->plane ) );
+		fp->Read( &p->bounds, sizeof( p->bounds ) );
+		fp->ReadInt( p->contents );
+		fp->ReadInt( materialNum );
+		p->material = ( materialNum >= 0 ) ? binary.materials[materialNum] : NULL;
+		p->checkcount = 0;
+		binary.polygons[i] = p;
+	}
+
+	// brushes
+	fp->ReadInt( num );
+	fp->ReadInt( memory );
+	model->brushBlock = (cm_brushBlock_t *) Mem_Alloc( sizeof( cm_brushBlock_t ) + memory );
+	model->brushBlock->bytesRemaining = memory;
+	model->brushBlock->next = ( (byte *) model->brushBlock ) + sizeof( cm_brushBlock_t );
+	binary.brushes.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		fp->ReadInt( numPlanes );
+		cm_brush_t *b = AllocBrush( model, numPlanes );
+		b->numPlanes = numPlanes;
+		fp->Read( b->planes, numPlanes * sizeof( b->planes[0] ) );
+		fp->Read( &b->bounds, sizeof( b->bounds ) );
+		fp->ReadInt( b->contents );
+		fp->ReadInt( b->primitiveNum );
+		fp->ReadInt( materialNum );
+		b->material = ( materialNum >= 0 ) ? binary.materials[materialNum] : NULL;
+		b->checkcount = 0;
+		binary.brushes[i] = b;
+	}
+
+	// nodes with their references
+	fp->ReadInt( num );
+	if ( num > 0 ) {
+		model->node = ReadBinaryNodes_r( fp, model, NULL, binary );
+	}
+
+	// total memory used by this model
+	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
+						model->numEdges * sizeof(cm_edge_t) +
+						model->polygonMemory +
+						model->brushMemory +
+						model->numNodes * sizeof(cm_node_t) +
+						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
+						model->numBrushRefs * sizeof(cm_brushRef_t);
+}
+
+/*
+================
+idCollisionModelManagerLocal::LoadBinaryCollisionModelFile
+
+Loads the collision models from the binary copy written by an earlier build.
+Returns false if the file is missing, broken or was written for different map geometry.
+================
+*/
+bool idCollisionModelManagerLocal::LoadBinaryCollisionModelFile( const char *name, const unsigned int mapFileCRC ) {
+	idStr fileName, ident;
+	const char *buffer;
+	int length, version, vertexSize, edgeSize, num, i;
+	unsigned int crc, storedCRC;
+
+	fileName = name;
+	fileName.SetFileExtension( CM_BINARY_FILE_EXT );
+
+	length = fileSystem->ReadFileView( fileName, (const void **)&buffer );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	// everything is read unchecked, so the whole file has to match its checksum
+	storedCRC = 0;
+	if ( length >= (int)sizeof( storedCRC ) ) {
+		length -= sizeof( storedCRC );
+		memcpy( &storedCRC, buffer + length, sizeof( storedCRC ) );
+	}
+	if ( length <= 0 || CRC32_BlockChecksum( buffer, length ) != storedCRC ) {
+		common->Warning( "%s is broken", fileName.c_str() );
+		fileSystem->FreeFileView( buffer );
+		return false;
+	}
+
+	idFile_Memory fp( fileName, buffer, length );
+
+	fp.ReadString( ident );
+	fp.ReadInt( version );
+	fp.ReadUnsignedInt( crc );
+	fp.ReadInt( vertexSize );
+	fp.ReadInt( edgeSize );
+	if ( ident != CM_BINARY_FILEID || version != CM_BINARY_FILEVERSION ||
+			vertexSize != sizeof( cm_vertex_t ) || edgeSize != sizeof( cm_edge_t ) ) {
+		common->Printf( "%s has a different version\n", fileName.c_str() );
+		fileSystem->FreeFileView( buffer );
+		return false;
+	}
+	if ( crc != mapFileCRC ) {
+		common->Printf( "%s is out of date\n", fileName.c_str() );
+		fileSystem->FreeFileView( buffer );
+		return false;
+	}
+
+	fp.ReadInt( num );
+	for ( i = 0; i < num; i++ ) {
+		ReadBinaryCollisionModel( &fp );
+	}
+
+	fileSystem->FreeFileView( buffer );
+
 	return true;
 }
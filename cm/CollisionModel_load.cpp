@@ -43,15 +43,46 @@
 idCollisionModelManagerLocal	collisionModelManagerLocal;
 idCollisionModelManager *		collisionModelManager = &collisionModelManagerLocal;
 
-cm_windingList_t *				cm_windingList;
-cm_windingList_t *				cm_outList;
-cm_windingList_t *				cm_tmpList;
+idCVar cm_parallelBuild( "cm_parallelBuild", "1", CVAR_GAME | CVAR_BOOL, "build the collision models of a map without a .cm file on the job threads" );
 
-idHashIndex *					cm_vertexHash;
-idHashIndex *					cm_edgeHash;
+// state used while building a model, the models of a map are built on several threads
+thread_local cm_windingList_t *	cm_windingList;
+thread_local cm_windingList_t *	cm_outList;
+thread_local cm_windingList_t *	cm_tmpList;
 
-idBounds						cm_modelBounds;
-int								cm_vertexShift;
+thread_local idHashIndex *		cm_vertexHash;
+thread_local idHashIndex *		cm_edgeHash;
+
+thread_local idBounds			cm_modelBounds;
+thread_local int				cm_vertexShift;
+
+// set while building the world model, only its polygons are pruned with the proc BSP tree
+thread_local bool				cm_worldModel;
+
+// warnings of models built on the job threads are printed once all models are done
+thread_local idStrList *		cm_buildWarnings;
+
+thread_local int				idCollisionModelManagerLocal::buildCheckCount;
+
+/*
+================
+CM_BuildWarning
+================
+*/
+static void CM_BuildWarning( const char *fmt, ... ) {
+	va_list argptr;
+	char msg[MAX_STRING_CHARS];
+
+	va_start( argptr, fmt );
+	idStr::vsnPrintf( msg, sizeof( msg ), fmt, argptr );
+	va_end( argptr );
+
+	if ( cm_buildWarnings ) {
+		cm_buildWarnings->Append( msg );
+	} else {
+		common->Warning( "%s", msg );
+	}
+}
 
 
 /*
@@ -181,6 +212,8 @@ void idCollisionModelManagerLocal::Clear( void ) {
 	contacts = NULL;
 	maxContacts = 0;
 	numContacts = 0;
+	buildTimes.Clear();
+	buildWallTime = 0.0;
 }
 
 /*
@@ -468,10 +501,10 @@ void idCollisionModelManagerLocal::CalculateEdgeNormals( cm_model_t *model, cm_n
 		for ( pref = node->polygons; pref; pref = pref->next ) {
 			p = pref->p;
 			// if we checked this polygon already
-			if ( p->checkcount == checkCount ) {
+			if ( p->checkcount == buildCheckCount ) {
 				continue;
 			}
-			p->checkcount = checkCount;
+			p->checkcount = buildCheckCount;
 
 			for ( i = 0; i < p->numEdges; i++ ) {
 				edgeNum = p->edges[i];
@@ -1029,7 +1062,7 @@ void idCollisionModelManagerLocal::ChopWindingListWithBrush( cm_windingList_t *l
 
 				if ( res == SIDE_BACK ) {
 					if ( cm_outList->numWindings >= MAX_WINDING_LIST ) {
-						common->Warning( "idCollisionModelManagerLocal::ChopWindingWithBrush: primitive %d more than %d windings", list->primitiveNum, MAX_WINDING_LIST );
+						CM_BuildWarning( "idCollisionModelManagerLocal::ChopWindingWithBrush: primitive %d more than %d windings", list->primitiveNum, MAX_WINDING_LIST );
 						return;
 					}
 					// winding and brush didn't intersect, store the original winding
@@ -1041,7 +1074,7 @@ void idCollisionModelManagerLocal::ChopWindingListWithBrush( cm_windingList_t *l
 
 				if ( res == SIDE_CROSS ) {
 					if ( cm_tmpList->numWindings >= MAX_WINDING_LIST ) {
-						common->Warning( "idCollisionModelManagerLocal::ChopWindingWithBrush: primitive %d more than %d windings", list->primitiveNum, MAX_WINDING_LIST );
+						CM_BuildWarning( "idCollisionModelManagerLocal::ChopWindingWithBrush: primitive %d more than %d windings", list->primitiveNum, MAX_WINDING_LIST );
 						return;
 					}
 					// store the front winding in the temporary list
@@ -1062,7 +1095,7 @@ void idCollisionModelManagerLocal::ChopWindingListWithBrush( cm_windingList_t *l
 				// store windings from temporary list in the out list
 				for ( i = 0; i < cm_tmpList->numWindings; i++ ) {
 					if ( cm_outList->numWindings + i >= MAX_WINDING_LIST ) {
-						common->Warning( "idCollisionModelManagerLocal::ChopWindingWithBrush: primitive %d more than %d windings", list->primitiveNum, MAX_WINDING_LIST );
+						CM_BuildWarning( "idCollisionModelManagerLocal::ChopWindingWithBrush: primitive %d more than %d windings", list->primitiveNum, MAX_WINDING_LIST );
 						return;
 					}
 					cm_outList->w[cm_outList->numWindings+i] = cm_tmpList->w[i];
@@ -1102,10 +1135,10 @@ void idCollisionModelManagerLocal::R_ChopWindingListWithTreeBrushes( cm_windingL
 		for ( bref = node->brushes; bref; bref = bref->next ) {
 			b = bref->b;
 			// if we checked this brush already
-			if ( b->checkcount == checkCount ) {
+			if ( b->checkcount == buildCheckCount ) {
 				continue;
 			}
-			b->checkcount = checkCount;
+			b->checkcount = buildCheckCount;
 			// if the windings in the list originate from this brush
 			if ( b->primitiveNum == list->primitiveNum ) {
 				continue;
@@ -1183,7 +1216,7 @@ idFixedWinding *idCollisionModelManagerLocal::WindingOutsideBrushes( idFixedWind
 	cm_windingList->contents = contents;
 	cm_windingList->primitiveNum = primitiveNum;
 	//
-	checkCount++;
+	buildCheckCount++;
 	R_ChopWindingListWithTreeBrushes( cm_windingList, headNode );
 	//
 	if ( !cm_windingList->numWindings ) {
@@ -1193,7 +1226,7 @@ idFixedWinding *idCollisionModelManagerLocal::WindingOutsideBrushes( idFixedWind
 		return &cm_windingList->w[0];
 	}
 	// if not the world model
-	if ( numModels != 0 ) {
+	if ( !cm_worldModel ) {
 		return w;
 	}
 	// check if winding fragments would be chopped away by the proc BSP tree
@@ -1538,10 +1571,10 @@ void idCollisionModelManagerLocal::MergeTreePolygons( cm_model_t *model, cm_node
 			for ( pref = node->polygons; pref; pref = pref->next ) {
 				p = pref->p;
 				// if we checked this polygon already
-				if ( p->checkcount == checkCount ) {
+				if ( p->checkcount == buildCheckCount ) {
 					continue;
 				}
-				p->checkcount = checkCount;
+				p->checkcount = buildCheckCount;
 				// try to merge this polygon with other polygons in the tree
 				if ( MergePolygonWithTreePolygons( model, model->node, p ) ) {
 					merge = true;
@@ -1792,10 +1825,10 @@ void idCollisionModelManagerLocal::FindInternalEdges( cm_model_t *model, cm_node
 		for ( pref = node->polygons; pref; pref = pref->next ) {
 			p = pref->p;
 			// if we checked this polygon already
-			if ( p->checkcount == checkCount ) {
+			if ( p->checkcount == buildCheckCount ) {
 				continue;
 			}
-			p->checkcount = checkCount;
+			p->checkcount = buildCheckCount;
 
 			FindInternalPolygonEdges( model, model->node, p );
 
@@ -2096,8 +2129,8 @@ cm_node_t *idCollisionModelManagerLocal::R_CreateAxialBSPTree( cm_model_t *model
 }
 
 /*
-int cm_numSavedPolygonLinks;
-int cm_numSavedBrushLinks;
+thread_local int cm_numSavedPolygonLinks;
+thread_local int cm_numSavedBrushLinks;
 
 int CM_R_CountChildren( cm_node_t *node ) {
 	if ( node->planeType == -1 ) {
@@ -2440,7 +2473,7 @@ void idCollisionModelManagerLocal::CreatePolygon( cm_model_t *model, idFixedWind
 	}
 	// don't overflow max edges
 	if ( numPolyEdges > CM_MAX_POLYGON_EDGES ) {
-		common->Warning( "idCollisionModelManagerLocal::CreatePolygon: polygon has more than %d edges", numPolyEdges );
+		CM_BuildWarning( "idCollisionModelManagerLocal::CreatePolygon: polygon has more than %d edges", numPolyEdges );
 		numPolyEdges = CM_MAX_POLYGON_EDGES;
 	}
 
@@ -2473,7 +2506,7 @@ void idCollisionModelManagerLocal::PolygonFromWinding( cm_model_t *model, idFixe
 	contents = material->GetContentFlags();
 
 	// if this polygon is part of the world model
-	if ( numModels == 0 ) {
+	if ( cm_worldModel ) {
 		// if the polygon is fully chopped away by the proc bsp tree
 		if ( ChoppedAwayByProcBSP( *w, plane, contents ) ) {
 			model->numRemovedPolys++;
@@ -2491,7 +2524,7 @@ void idCollisionModelManagerLocal::PolygonFromWinding( cm_model_t *model, idFixe
 	}
 
 	if ( w->IsHuge() ) {
-		common->Warning( "idCollisionModelManagerLocal::PolygonFromWinding: model %s primitive %d is degenerate", model->name.c_str(), abs(primitiveNum) );
+		CM_BuildWarning( "idCollisionModelManagerLocal::PolygonFromWinding: model %s primitive %d is degenerate", model->name.c_str(), abs(primitiveNum) );
 		return;
 	}
 
@@ -2823,10 +2856,10 @@ void idCollisionModelManagerLocal::RemapEdges( cm_node_t *node, int *edgeRemap )
 		for ( pref = node->polygons; pref; pref = pref->next ) {
 			p = pref->p;
 			// if we checked this polygon already
-			if ( p->checkcount == checkCount ) {
+			if ( p->checkcount == buildCheckCount ) {
 				continue;
 			}
-			p->checkcount = checkCount;
+			p->checkcount = buildCheckCount;
 			for ( i = 0; i < p->numEdges; i++ ) {
 				if ( p->edges[i] < 0 ) {
 					p->edges[i] = -edgeRemap[ abs(p->edges[i]) ];
@@ -2893,7 +2926,7 @@ void idCollisionModelManagerLocal::OptimizeArrays( cm_model_t *model ) {
 		}
 	}
 	// change polygon edge indexes
-	checkCount++;
+	buildCheckCount++;
 	RemapEdges( model->node, remap );
 	model->numEdges = newNumEdges;
 
@@ -2916,6 +2949,51 @@ void idCollisionModelManagerLocal::OptimizeArrays( cm_model_t *model ) {
 	}
 }
 
+/*
+================
+CM_R_ClearCheckCounts
+================
+*/
+static void CM_R_ClearCheckCounts( cm_node_t *node ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+
+	while( 1 ) {
+		for ( pref = node->polygons; pref; pref = pref->next ) {
+			pref->p->checkcount = 0;
+		}
+		for ( bref = node->brushes; bref; bref = bref->next ) {
+			bref->b->checkcount = 0;
+		}
+		if ( node->planeType == -1 ) {
+			break;
+		}
+		CM_R_ClearCheckCounts( node->children[1] );
+		node = node->children[0];
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::ClearBuildCheckCounts
+
+The build uses a per thread counter, clear its marks so they can't match the checkCount used for collision detection.
+================
+*/
+void idCollisionModelManagerLocal::ClearBuildCheckCounts( cm_model_t *model ) {
+	int i;
+
+	for ( i = 0; i < model->numVertices; i++ ) {
+		model->vertices[i].checkcount = 0;
+	}
+	for ( i = 0; i < model->numEdges; i++ ) {
+		model->edges[i].checkcount = 0;
+	}
+	if ( model->node ) {
+		CM_R_ClearCheckCounts( model->node );
+	}
+}
+
 /*
 ================
 idCollisionModelManagerLocal::FinishModel
@@ -2923,13 +3001,13 @@ idCollisionModelManagerLocal::FinishModel
 */
 void idCollisionModelManagerLocal::FinishModel( cm_model_t *model ) {
 	// try to merge polygons
-	checkCount++;
+	buildCheckCount++;
 	MergeTreePolygons( model, model->node );
 	// find internal edges (no mesh can ever collide with internal edges)
-	checkCount++;
+	buildCheckCount++;
 	FindInternalEdges( model, model->node );
 	// calculate edge normals
-	checkCount++;
+	buildCheckCount++;
 	CalculateEdgeNormals( model, model->node );
 
 	//common->Printf( "%s vertex hash spread is %d\n", model->name.c_str(), cm_vertexHash->GetSpread() );
@@ -2949,6 +3027,8 @@ void idCollisionModelManagerLocal::FinishModel( cm_model_t *model ) {
 						model->numNodes * sizeof(cm_node_t) +
 						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
 						model->numBrushRefs * sizeof(cm_brushRef_t);
+
+	ClearBuildCheckCounts( model );
 }
 
 /*
@@ -3051,6 +3131,8 @@ cm_model_t *idCollisionModelManagerLocal::LoadRenderModel( const char *fileName,
 
 	ClearHash( bounds );
 
+	cm_worldModel = ( numModels == 0 );
+
 	for ( i = 0; i < renderModel->NumSurfaces(); i++ ) {
 		surf = renderModel->Surface( i );
 		const idMaterial* shader = GetSkinnedShader( surf->shader, skin ); // #4232
@@ -3081,6 +3163,8 @@ cm_model_t *idCollisionModelManagerLocal::LoadRenderModel( const char *fileName,
 
 	FinishModel( model );
 
+	cm_worldModel = false;
+
 	// shutdown the hash
 	ShutdownHash();
 
@@ -3095,6 +3179,18 @@ idCollisionModelManagerLocal::CollisionModelForMapEntity
 ================
 */
 cm_model_t *idCollisionModelManagerLocal::CollisionModelForMapEntity( const idMapEntity *mapEnt ) {
+	// first model is always the world
+	return CollisionModelForMapEntity( mapEnt, numModels == 0 );
+}
+
+/*
+================
+idCollisionModelManagerLocal::CollisionModelForMapEntity
+
+Does not touch the model list, so models of different entities can be built at the same time.
+================
+*/
+cm_model_t *idCollisionModelManagerLocal::CollisionModelForMapEntity( const idMapEntity *mapEnt, bool worldModel ) {
 	cm_model_t *model;
 	idBounds bounds;
 	const char *name;
@@ -3110,8 +3206,7 @@ cm_model_t *idCollisionModelManagerLocal::CollisionModelForMapEntity( const idMa
 	if ( !name[0] ) {
 		mapEnt->epairs.GetString( "name", "", &name );
 		if ( !name[0] ) {
-			if ( !numModels ) {
-				// first model is always the world
+			if ( worldModel ) {
 				name = "worldMap";
 			}
 			else {
@@ -3120,6 +3215,8 @@ cm_model_t *idCollisionModelManagerLocal::CollisionModelForMapEntity( const idMa
 		}
 	}
 
+	cm_worldModel = worldModel;
+
 	model = AllocModel();
 	model->node = AllocNode( model, NODE_BLOCK_SIZE_SMALL );
 
@@ -3182,6 +3279,8 @@ cm_model_t *idCollisionModelManagerLocal::CollisionModelForMapEntity( const idMa
 
 	FinishModel( model );
 
+	cm_worldModel = false;
+
 	return model;
 }
 
@@ -3297,16 +3396,171 @@ void idCollisionModelManagerLocal::ListModels( void ) {
 
 /*
 ================
-idCollisionModelManagerLocal::BuildModels
+CM_BuildMapEntityModel
 ================
 */
-void idCollisionModelManagerLocal::BuildModels( const idMapFile *mapFile ) {
-	int i;
+void CM_BuildMapEntityModel( cm_buildJob_t *job ) {
+	// the main thread already has its hash when the models are built serially
+	bool ownHash = ( cm_vertexHash == NULL );
+	idTimer timer;
+
+	timer.Start();
+
+	if ( ownHash ) {
+		collisionModelManagerLocal.SetupHash();
+	}
+	cm_buildWarnings = &job->warnings;
+
+	job->model = collisionModelManagerLocal.CollisionModelForMapEntity( job->mapEnt, job->worldModel );
+
+	cm_buildWarnings = NULL;
+	if ( ownHash ) {
+		collisionModelManagerLocal.ShutdownHash();
+	}
+
+	timer.Stop();
+	job->msec = timer.Milliseconds();
+}
+
+REGISTER_PARALLEL_JOB( CM_BuildMapEntityModel, "CM_BuildMapEntityModel" );
+
+/*
+================
+idCollisionModelManagerLocal::BuildMapEntityModels
+
+Every entity with brushes or patches gets its own model which only depends on the
+entity and the proc BSP, so all of them are built at the same time on the job threads.
+================
+*/
+void idCollisionModelManagerLocal::BuildMapEntityModels( const idMapFile *mapFile ) {
+	idList<cm_buildJob_t> jobs;
 	const idMapEntity *mapEnt;
+	bool worldModel;
+	int i, j, k;
 
 	idTimer timer;
 	timer.Start();
 
+	worldModel = ( numModels == 0 );
+	jobs.Resize( mapFile->GetNumEntities() );
+	for ( i = 0; i < mapFile->GetNumEntities(); i++ ) {
+		mapEnt = mapFile->GetEntity( i );
+
+		// no model is created for entities without primitives
+		if ( mapEnt->GetNumPrimitives() < 1 ) {
+			continue;
+		}
+
+		if ( numModels + jobs.Num() >= MAX_SUBMODELS ) {
+			common->Error( "idCollisionModelManagerLocal::BuildModels: more than %d collision models", MAX_SUBMODELS );
+			break;
+		}
+
+		cm_buildJob_t &job = jobs.Alloc();
+		job.mapEnt = mapEnt;
+		job.worldModel = worldModel;
+		job.model = NULL;
+		job.msec = 0.0;
+		worldModel = false;
+	}
+
+	if ( cm_parallelBuild.GetBool() && jobs.Num() > 1 ) {
+		// look up all materials here, on the job threads FindMaterial then only reads the decl hash tables
+		for ( i = 0; i < jobs.Num(); i++ ) {
+			mapEnt = jobs[i].mapEnt;
+			for ( j = 0; j < mapEnt->GetNumPrimitives(); j++ ) {
+				const idMapPrimitive *mapPrim = mapEnt->GetPrimitive( j );
+				if ( mapPrim->GetType() == idMapPrimitive::TYPE_BRUSH ) {
+					const idMapBrush *mapBrush = static_cast<const idMapBrush *>( mapPrim );
+					for ( k = 0; k < mapBrush->GetNumSides(); k++ ) {
+						declManager->FindMaterial( mapBrush->GetSide( k )->GetMaterial() );
+					}
+				} else if ( mapPrim->GetType() == idMapPrimitive::TYPE_PATCH ) {
+					declManager->FindMaterial( static_cast<const idMapPatch *>( mapPrim )->GetMaterial() );
+				}
+			}
+		}
+
+		// the world model is the largest by far, it is added first so it starts first
+		idParallelJobList *jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, jobs.Num(), 0, NULL );
+		for ( i = 0; i < jobs.Num(); i++ ) {
+			jobList->AddJob( (jobRun_t)CM_BuildMapEntityModel, &jobs[i] );
+		}
+		jobList->Submit();
+		jobList->Wait();
+		parallelJobManager->FreeJobList( jobList );
+	} else {
+		for ( i = 0; i < jobs.Num(); i++ ) {
+			CM_BuildMapEntityModel( &jobs[i] );
+		}
+	}
+
+	// add the models in entity order
+	buildTimes.SetNum( jobs.Num() );
+	for ( i = 0; i < jobs.Num(); i++ ) {
+		for ( j = 0; j < jobs[i].warnings.Num(); j++ ) {
+			common->Warning( "%s", jobs[i].warnings[j].c_str() );
+		}
+		models[numModels++] = jobs[i].model;
+
+		buildTimes[i].name = jobs[i].model->name;
+		buildTimes[i].numPrimitives = jobs[i].mapEnt->GetNumPrimitives();
+		buildTimes[i].msec = jobs[i].msec;
+	}
+
+	timer.Stop();
+	buildWallTime = timer.Milliseconds();
+}
+
+/*
+================
+CM_SortBuildTimes
+================
+*/
+static int CM_SortBuildTimes( const cm_buildTime_t *a, const cm_buildTime_t *b ) {
+	if ( a->msec < b->msec ) {
+		return 1;
+	}
+	if ( a->msec > b->msec ) {
+		return -1;
+	}
+	return 0;
+}
+
+/*
+================
+idCollisionModelManagerLocal::ListBuildTimes
+================
+*/
+void idCollisionModelManagerLocal::ListBuildTimes( void ) {
+	double totalTime;
+	int i;
+
+	if ( !buildTimes.Num() ) {
+		common->Printf( "no collision models were built for the current map, they were loaded from a file\n" );
+		return;
+	}
+
+	idList<cm_buildTime_t> sorted = buildTimes;
+	sorted.Sort( CM_SortBuildTimes );
+
+	totalTime = 0.0;
+	for ( i = 0; i < sorted.Num(); i++ ) {
+		common->Printf( "%8.2f ms %6d primitives   %s\n", sorted[i].msec, sorted[i].numPrimitives, sorted[i].name.c_str() );
+		totalTime += sorted[i].msec;
+	}
+	common->Printf( "%d models built in %.2f ms, %.2f ms spent building\n", sorted.Num(), buildWallTime, totalTime );
+}
+
+/*
+================
+idCollisionModelManagerLocal::BuildModels
+================
+*/
+void idCollisionModelManagerLocal::BuildModels( const idMapFile *mapFile ) {
+	idTimer timer;
+	timer.Start();
+
 	if ( !LoadCollisionModelFile( mapFile->GetName(), mapFile->GetGeometryCRC() ) ) {
 
 		if ( !mapFile->GetNumEntities() ) {
@@ -3317,18 +3571,7 @@ void idCollisionModelManagerLocal::BuildModels( const idMapFile *mapFile ) {
 		LoadProcBSP( mapFile->GetName() );
 
 		// convert brushes and patches to collision data
-		for ( i = 0; i < mapFile->GetNumEntities(); i++ ) {
-			mapEnt = mapFile->GetEntity(i);
-
-			if ( numModels >= MAX_SUBMODELS ) {
-				common->Error( "idCollisionModelManagerLocal::BuildModels: more than %d collision models", MAX_SUBMODELS );
-				break;
-			}
-			models[numModels] = CollisionModelForMapEntity( mapEnt );
-			if ( models[ numModels] ) {
-				numModels++;
-			}
-		}
+		BuildMapEntityModels( mapFile );
 
 		// free the proc bsp which is only used for data optimization
 		Mem_Free( procNodes );
@@ -3336,6 +3579,9 @@ void idCollisionModelManagerLocal::BuildModels( const idMapFile *mapFile ) {
 
 		// write the collision models to a file
 		WriteCollisionModelsToFile( mapFile->GetName(), 0, numModels, mapFile->GetGeometryCRC() );
+		if ( mapFile->GetGeometryCRC() && cm_useBinaryFile.GetBool() ) {
+			WriteBinaryCollisionModelsToFile( mapFile->GetName(), 0, numModels, mapFile->GetGeometryCRC() );
+		}
 	}
 
 	timer.Stop();
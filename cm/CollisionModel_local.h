@@ -180,6 +180,19 @@ typedef struct cm_model_s {
 	int						usedMemory;
 } cm_model_t;
 
+// polygons, brushes and materials referenced by index in the binary copy of a .cm file
+typedef struct cm_binaryModel_s {
+	idList<cm_node_t *>			nodes;			// nodes in depth first order
+	idList<cm_polygon_t *>		polygons;		// unique polygons in reference order
+	idHashIndex					polygonHash;
+	int							polygonMemory;
+	idList<cm_brush_t *>		brushes;		// unique brushes in reference order
+	idHashIndex					brushHash;
+	int							brushMemory;
+	idList<const idMaterial *>	materials;		// material table referenced by index
+	idHashIndex					materialHash;
+} cm_binaryModel_t;
+
 /*
 ===============================================================================
 
@@ -277,7 +290,22 @@ typedef struct cm_procNode_s {
 	int children[2];				// negative numbers are (-1 - areaNumber), 0 = solid
 } cm_procNode_t;
 
+typedef struct cm_buildJob_s {
+	const idMapEntity *		mapEnt;				// entity to build the model for
+	bool					worldModel;			// first model of the map
+	cm_model_t *			model;				// built model
+	idStrList				warnings;			// printed on the main thread once all models are built
+	double					msec;				// build time
+} cm_buildJob_t;
+
+typedef struct cm_buildTime_s {
+	idStr					name;
+	int						numPrimitives;
+	double					msec;
+} cm_buildTime_t;
+
 class idCollisionModelManagerLocal : public idCollisionModelManager {
+	friend void CM_BuildMapEntityModel( cm_buildJob_t *job );
 public:
 	// load collision models from a map file
 	void			LoadMap( const idMapFile *mapFile );
@@ -329,6 +357,8 @@ public:
 	void			ModelInfo( cmHandle_t model );
 	// list all loaded models
 	void			ListModels( void );
+	// list the build time of the models built from the map
+	void			ListBuildTimes( void );
 	// write a collision model file for the map entity
 	bool			WriteCollisionModelForMapEntity( const idMapEntity *mapEnt, const char *filename, const bool testTraceModel = true );
 
@@ -452,9 +482,12 @@ private:			// CollisionMap_load.cpp
 	void			RemapEdges( cm_node_t *node, int *edgeRemap );
 	void			OptimizeArrays( cm_model_t *model );
 	void			FinishModel( cm_model_t *model );
+	void			ClearBuildCheckCounts( cm_model_t *model );
+	void			BuildMapEntityModels( const idMapFile *mapFile );
 	void			BuildModels( const idMapFile *mapFile );
 	cmHandle_t		FindModel( const char *name );
 	cm_model_t *	CollisionModelForMapEntity( const idMapEntity *mapEnt );	// brush/patch model from .map
+	cm_model_t *	CollisionModelForMapEntity( const idMapEntity *mapEnt, bool worldModel );
 	cm_model_t *	LoadRenderModel( const char *fileName, const idDeclSkin* skin = NULL );	// ASE/LWO models. skin added #4232 SteveL
 	bool			TrmFromModel_r( idTraceModel &trm, cm_node_t *node );
 	bool			TrmFromModel( const cm_model_t *model, idTraceModel &trm );
@@ -476,6 +509,13 @@ private:			// CollisionMap_files.cpp
 	void			ParseBrushes( idLexer *src, cm_model_t *model );
 	bool			ParseCollisionModel( idLexer *src );
 	bool			LoadCollisionModelFile( const char *name, const unsigned int mapFileCRC );
+					// binary copy
+	void			CollectBinaryNodes_r( cm_node_t *node, cm_binaryModel_t &binary );
+	void			WriteBinaryCollisionModel( idFile *fp, cm_model_t *model );
+	void			WriteBinaryCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC );
+	cm_node_t *		ReadBinaryNodes_r( idFile *fp, cm_model_t *model, cm_node_t *parent, const cm_binaryModel_t &binary );
+	void			ReadBinaryCollisionModel( idFile *fp );
+	bool			LoadBinaryCollisionModelFile( const char *name, const unsigned int mapFileCRC );
 	const idStr			GetSkinnedName	( const char *fileName, const idDeclSkin* skin ) const;		// #4232 SteveL
 	const idMaterial*	GetSkinnedShader( const idMaterial* shader, const idDeclSkin* skin ) const;	// #4232 SteveL
 
@@ -494,6 +534,8 @@ private:			// collision map data
 	int				loaded;
 					// for multi-check avoidance
 	int				checkCount;
+					// multi-check avoidance while building models, models are built on several threads
+	static thread_local int buildCheckCount;
 					// models
 	int				maxModels;
 	int				numModels;
@@ -510,9 +552,14 @@ private:			// collision map data
 	contactInfo_t *	contacts;
 	int				maxContacts;
 	int				numContacts;
+					// build times of the models built from the last map
+	idList<cm_buildTime_t> buildTimes;
+	double			buildWallTime;
 };
 
 // for debugging
 extern idCVar cm_debugCollision;
 
+extern idCVar cm_useBinaryFile;
+
 
@@ -1809,6 +1809,97 @@ void Com_ReloadLanguage_f( const idCmdArgs &args ) {
 	commonLocal.InitLanguageDict();
 }
 
+/*
+=================
+Com_TestLexer_f
+
+Measures idLexer throughput on the decl and map text of the current game.
+usage: testLexer [passes] [maxMaps]
+=================
+*/
+static void Com_TestLexer_f( const idCmdArgs &args ) {
+	static const struct {
+		const char *	folder;
+		const char *	extension;
+		bool			map;
+	} sets[] = {
+		{ "materials",	".mtr",		false },
+		{ "skins",		".skin",	false },
+		{ "sound",		".sndshd",	false },
+		{ "def",		".def",		false },
+		{ "fx",			".fx",		false },
+		{ "particles",	".prt",		false },
+		{ "af",			".af",		false },
+		{ "xdata",		".xd",		false },
+		{ "maps",		".map",		true },
+	};
+	const int mapLexerFlags = LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES;
+
+	int passes = args.Argc() > 1 ? Max( 1, atoi( args.Argv( 1 ) ) ) : 3;
+	int maxMaps = args.Argc() > 2 ? Max( 0, atoi( args.Argv( 2 ) ) ) : 4;
+
+	int totalBytes = 0, totalTokens = 0;
+	double totalMs = 0.0;
+
+	common->Printf( "lexing %d passes...\n", passes );
+
+	for ( int s = 0; s < sizeof( sets ) / sizeof( sets[0] ); s++ ) {
+		idFileList *fileList = fileSystem->ListFiles( sets[s].folder, sets[s].extension, true );
+		int numFiles = fileList->GetNumFiles();
+		if ( sets[s].map ) {
+			numFiles = Min( numFiles, maxMaps );
+		}
+
+		// read everything first so only the lexer is timed
+		idList<char *> buffers;
+		idList<int> lengths;
+		for ( int i = 0; i < numFiles; i++ ) {
+			idStr fileName = idStr( sets[s].folder ) + "/" + fileList->GetFile( i );
+			char *buffer;
+			int length = fileSystem->ReadFile( fileName, (void **)&buffer );
+			if ( length > 0 ) {
+				buffers.Append( buffer );
+				lengths.Append( length );
+			} else if ( length == 0 ) {
+				fileSystem->FreeFile( buffer );
+			}
+		}
+		fileSystem->FreeFileList( fileList );
+
+		int bytes = 0, tokens = 0;
+		idTimer timer;
+		timer.Start();
+		for ( int pass = 0; pass < passes; pass++ ) {
+			for ( int i = 0; i < buffers.Num(); i++ ) {
+				idLexer src;
+				idToken token;
+				src.LoadMemory( buffers[i], lengths[i], sets[s].folder );
+				src.SetFlags( ( sets[s].map ? mapLexerFlags : DECL_LEXER_FLAGS ) | LEXFL_NOWARNINGS | LEXFL_NOERRORS );
+				while ( src.ReadToken( &token ) ) {
+					tokens++;
+				}
+				bytes += lengths[i];
+			}
+		}
+		timer.Stop();
+
+		for ( int i = 0; i < buffers.Num(); i++ ) {
+			fileSystem->FreeFile( buffers[i] );
+		}
+
+		double ms = timer.Milliseconds();
+		common->Printf( "%-10s %5d files %8.2f MB %9d tokens %8.1f ms %7.1f MB/s\n", sets[s].folder, buffers.Num(),
+						bytes / ( 1024.0 * 1024.0 * passes ), tokens / passes, ms / passes, ms > 0.0 ? bytes / ( 1024.0 * 1024.0 ) / ( ms * 0.001 ) : 0.0 );
+
+		totalBytes += bytes / passes;
+		totalTokens += tokens / passes;
+		totalMs += ms / passes;
+	}
+
+	common->Printf( "%-10s %11s %8.2f MB %9d tokens %8.1f ms %7.1f MB/s\n", "total", "", totalBytes / ( 1024.0 * 1024.0 ), totalTokens,
+					totalMs, totalMs > 0.0 ? totalBytes / ( 1024.0 * 1024.0 ) / ( totalMs * 0.001 ) : 0.0 );
+}
+
 typedef idHashTable<idStrList> ListHash;
 void LoadMapLocalizeData(ListHash& listHash) {
 
@@ -2314,6 +2405,7 @@ void idCommonLocal::InitCommands( void ) {
 	cmdSystem->AddCommand( "runAAS", RunAAS_f, CMD_FL_TOOL, "compiles an AAS file for a map", idCmdSystem::ArgCompletion_MapName );
 	cmdSystem->AddCommand( "runAASDir", RunAASDir_f, CMD_FL_TOOL, "compiles AAS files for all maps in a folder", idCmdSystem::ArgCompletion_MapName );
 	cmdSystem->AddCommand( "runReach", RunReach_f, CMD_FL_TOOL, "calculates reachability for an AAS file", idCmdSystem::ArgCompletion_MapName );
+	cmdSystem->AddCommand( "convertAAS", ConvertAAS_f, CMD_FL_TOOL, "writes binary copies of the AAS files of a map, or of all maps", idCmdSystem::ArgCompletion_MapName );
 	cmdSystem->AddCommand( "roq", RoQFileEncode_f, CMD_FL_TOOL, "encodes a roq file" );
 #endif
 
@@ -2342,6 +2434,9 @@ void idCommonLocal::InitCommands( void ) {
 	cmdSystem->AddCommand( "listDictKeys", idDict::ListKeys_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "lists all keys used by dictionaries" );
 	cmdSystem->AddCommand( "listDictValues", idDict::ListValues_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "lists all values used by dictionaries" );
 	cmdSystem->AddCommand( "testSIMD", idSIMD::Test_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "test SIMD code" );
+	cmdSystem->AddCommand( "testJobs", idParallelJobManager::Test_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "test the job system" );
+	cmdSystem->AddCommand( "testLexer", Com_TestLexer_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "measures lexer throughput on the decl and map files" );
+	cmdSystem->AddCommand( "listJobs", idParallelJobManager::ListJobs_f, CMD_FL_SYSTEM, "lists job lists with their timings" );
 
 	// localization
 	cmdSystem->AddCommand( "localizeGuis", Com_LocalizeGuis_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "localize guis" );
@@ -2772,6 +2867,9 @@ void idCommonLocal::Init( int argc, const char **argv, const char *cmdline )
 		// initialize processor specific SIMD implementation
 		InitSIMD();
 
+		// start the job threads
+		parallelJobManager->Init();
+
 		// init commands
 		InitCommands();
 
@@ -2835,6 +2933,9 @@ void idCommonLocal::Shutdown( void ) {
 	// game specific shut down
 	ShutdownGame(false);
 
+	// stop the job threads
+	parallelJobManager->Shutdown();
+
 	// shut down non-portable system services
 	Sys_Shutdown();
 
@@ -142,6 +142,40 @@ private:
 	idDeclLocal *				nextInFile;				// next decl in the decl file
 };
 
+// a single declaration in the text of a decl file
+typedef struct {
+	declType_t					type;
+	idStr						name;
+	int							offset;
+	int							length;
+	int							line;
+	int							endLine;
+} declTextSpan_t;
+
+// the text of a decl file split into declarations, possibly on a job thread
+typedef struct {
+	idDeclFile *				file;
+	char *						buffer;
+	int							length;
+	int							checksum;
+	idList<declTextSpan_t>		spans;
+	int							numLines;
+	bool						clean;		// false if it has to be scanned again to print warnings
+	bool						cached;		// spans were taken from the decl cache
+} declFileScan_t;
+
+// layout of a decl file remembered across runs, see idDeclManagerLocal::LoadDeclCache
+typedef struct {
+	idStr						fileName;
+	int							checksum;
+	int							length;
+	declType_t					defaultType;
+	int							numDeclTypes;	// registered decl types when the file was scanned
+	int							numLines;
+	idList<declTextSpan_t>		spans;
+	bool						used;			// only used entries are written back
+} declCacheEntry_t;
+
 class idDeclFile {
 public:
 								idDeclFile();
@@ -150,6 +184,12 @@ public:
 	void						Reload( bool force );
 	int							LoadAndParse();
 
+								// returns false if the lexer warned or failed with printWarnings unset
+	static bool					ScanText( const char *buffer, int length, const char *fileName, declType_t defaultType,
+										bool printWarnings, idList<declTextSpan_t> &spans, int &numLines );
+	void						MergeText( const char *buffer, int length, int checksum, const idList<declTextSpan_t> &spans, int numLines );
+	void						MergeScan( declFileScan_t &scan );
+
 public:
 	idStr						fileName;
 	declType_t					defaultType;
@@ -210,6 +250,10 @@ public:
 	idDeclType *				GetDeclType( int type ) const { return declTypes[type]; }
 	const idDeclFile *			GetImplicitDeclFile( void ) const { return &implicitDecls; }
 
+	bool						UseDeclCache( void ) const { return decl_useCache.GetBool(); }
+	declCacheEntry_t *			FindDeclCache( const char *fileName, int checksum, int length, declType_t defaultType );
+	void						AddDeclCache( const declFileScan_t &scan );
+
 private:
 	idList<idDeclType *>		declTypes;
 	idList<idDeclFolder *>		declFolders;
@@ -224,15 +268,31 @@ private:
 	int							indent;			// for MediaPrint
 	bool						insideLevelLoad;
 
+	idList<declCacheEntry_t *>	declCache;
+	idHashIndex					declCacheHash;
+	bool						declCacheChanged;
+
 	static idCVar				decl_show;
+	static idCVar				decl_parallelLoad;
+	static idCVar				decl_useCache;
 
 private:
+	void						LoadDeclCache( void );
+	void						SaveDeclCache( void );
+	void						FreeDeclCache( void );
+
 	static void					ListDecls_f( const idCmdArgs &args );
 	static void					ReloadDecls_f( const idCmdArgs &args );
 	static void					TouchDecl_f( const idCmdArgs &args );
 };
 
 idCVar idDeclManagerLocal::decl_show( "decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+idCVar idDeclManagerLocal::decl_parallelLoad( "decl_parallelLoad", "1", CVAR_SYSTEM | CVAR_BOOL, "scan the files of a decl folder on the job threads" );
+idCVar idDeclManagerLocal::decl_useCache( "decl_useCache", "1", CVAR_SYSTEM | CVAR_BOOL | CVAR_INIT, "remember the declarations in unchanged decl files across runs" );
+
+#define DECL_CACHE_FILE		"declcache.dat"
+#define DECL_CACHE_IDENT	"DECLCACHE"
+#define DECL_CACHE_VERSION	1
 
 idDeclManagerLocal	declManagerLocal;
 idDeclManager *		declManager = &declManagerLocal;
@@ -581,49 +641,35 @@ void idDeclFile::Reload( bool force ) {
 
 /*
 ================
-idDeclFile::LoadAndParse
+idDeclFile::ScanText
 
-This is used during both the initial load, and any reloads
+Splits the text of a decl file into the individual declarations.
+This doesn't touch any decl manager state except for the registered
+decl types, so it can run on a job thread.
 ================
 */
-int c_savedMemory = 0;
-
-int idDeclFile::LoadAndParse() {
+bool idDeclFile::ScanText( const char *buffer, int length, const char *fileName, declType_t defaultType, bool printWarnings, idList<declTextSpan_t> &spans, int &numLines ) {
 	int			i, numTypes;
 	idLexer		src;
 	idToken		token;
 	int			startMarker;
-	char *		buffer;
-	int			length, size;
 	int			sourceLine;
-	idStr		name;
-	idDeclLocal *newDecl;
-	bool		reparse;
+	int			lexerFlags;
+	declTextSpan_t	span;
 
-	// load the text
-	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
-	length = fileSystem->ReadFile( fileName, (void **)&buffer, &timestamp );
-	if ( length == -1 ) {
-		common->FatalError( "couldn't load %s", fileName.c_str() );
-		return 0;
-	}
+	spans.Clear();
+	numLines = 0;
 
-	if ( !src.LoadMemory( buffer, length, fileName ) ) {
-		common->Error( "Couldn't parse %s", fileName.c_str() );
-		Mem_Free( buffer );
-		return 0;
+	lexerFlags = DECL_LEXER_FLAGS;
+	if ( !printWarnings ) {
+		lexerFlags |= LEXFL_NOWARNINGS | LEXFL_NOERRORS;
 	}
 
-	// mark all the defs that were from the last reload of this file
-	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
-		decl->redefinedInReload = false;
+	if ( !src.LoadMemory( buffer, length, fileName ) ) {
+		return false;
 	}
 
-	src.SetFlags( DECL_LEXER_FLAGS );
-
-	checksum = MD5_BlockChecksum( buffer, length );
-
-	fileSize = length;
+	src.SetFlags( lexerFlags );
 
 	// scan through, identifying each individual declaration
 	while( 1 ) {
@@ -672,9 +718,9 @@ int idDeclFile::LoadAndParse() {
 		// xdata needs to be allowed escape chars in string -- SteveL #4115
 		if ( identifiedType == DECL_XDATA )
 		{
-			src.SetFlags( DECL_LEXER_FLAGS & ~LEXFL_NOSTRINGESCAPECHARS );
+			src.SetFlags( lexerFlags & ~LEXFL_NOSTRINGESCAPECHARS );
 		} else {
-			src.SetFlags( DECL_LEXER_FLAGS );
+			src.SetFlags( lexerFlags );
 		}
 
 		// now parse the name
@@ -696,7 +742,8 @@ int idDeclFile::LoadAndParse() {
 			continue;
 		}
 
-		name = token;
+		span.type = identifiedType;
+		span.name = token;
 
 		// make sure there's a '{'
 		if ( !src.ReadToken( &token ) ) {
@@ -711,16 +758,52 @@ int idDeclFile::LoadAndParse() {
 
 		// now take everything until a matched closing brace
 		src.SkipBracedSection();
-		size = src.GetFileOffset() - startMarker;
+
+		span.offset = startMarker;
+		span.length = src.GetFileOffset() - startMarker;
+		span.line = sourceLine;
+		span.endLine = src.GetLineNum();
+		spans.Append( span );
+	}
+
+	numLines = src.GetLineNum();
+
+	// the caller scans the file again with warnings enabled to print them
+	return printWarnings || ( !src.HadWarning() && !src.HadError() );
+}
+
+/*
+================
+idDeclFile::MergeText
+
+Creates or updates the decls found by ScanText, must run on the main thread.
+================
+*/
+void idDeclFile::MergeText( const char *buffer, int length, int checksum, const idList<declTextSpan_t> &spans, int numLines ) {
+	idDeclLocal *newDecl;
+	bool		reparse;
+
+	// mark all the defs that were from the last reload of this file
+	for ( idDeclLocal *decl = decls; decl; decl = decl->nextInFile ) {
+		decl->redefinedInReload = false;
+	}
+
+	this->checksum = checksum;
+
+	fileSize = length;
+
+	for ( int i = 0; i < spans.Num(); i++ ) {
+		const declTextSpan_t &span = spans[i];
 
 		// look it up, possibly getting a newly created default decl
 		reparse = false;
-		newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, false );
+		newDecl = declManagerLocal.FindTypeWithoutParsing( span.type, span.name, false );
 		if ( newDecl ) {
 			// update the existing copy
 			if ( newDecl->sourceFile != this || newDecl->redefinedInReload ) {
-				src.Warning( "%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType( identifiedType ),
-								name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
+				common->Warning( "file %s, line %d: %s '%s' previously defined at %s:%i", fileName.c_str(), span.endLine,
+								declManagerLocal.GetDeclNameFromType( span.type ), span.name.c_str(),
+								newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine );
 				continue;
 			}
 			if ( newDecl->declState != DS_UNPARSED ) {
@@ -728,7 +811,7 @@ int idDeclFile::LoadAndParse() {
 			}
 		} else {
 			// allow it to be created as a default, then add it to the per-file list
-			newDecl = declManagerLocal.FindTypeWithoutParsing( identifiedType, name, true );
+			newDecl = declManagerLocal.FindTypeWithoutParsing( span.type, span.name, true );
 			newDecl->nextInFile = this->decls;
 			this->decls = newDecl;
 		}
@@ -740,11 +823,11 @@ int idDeclFile::LoadAndParse() {
 			newDecl->textSource = NULL;
 		}
 
-		newDecl->SetTextLocal( buffer + startMarker, size );
+		newDecl->SetTextLocal( buffer + span.offset, span.length );
 		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
+		newDecl->sourceTextOffset = span.offset;
+		newDecl->sourceTextLength = span.length;
+		newDecl->sourceLine = span.line;
 		newDecl->declState = DS_UNPARSED;
 
 		// if it is currently in use, reparse it immedaitely
@@ -753,9 +836,7 @@ int idDeclFile::LoadAndParse() {
 		}
 	}
 
-	numLines = src.GetLineNum();
-
-	Mem_Free( buffer );
+	this->numLines = numLines;
 
 	// any defs that weren't redefinedInReload should now be defaulted
 	for ( idDeclLocal *decl = decls ; decl ; decl = decl->nextInFile ) {
@@ -766,6 +847,86 @@ int idDeclFile::LoadAndParse() {
 			decl->sourceLine = decl->sourceFile->numLines;
 		}
 	}
+}
+
+/*
+================
+ScanDeclFile
+
+Splits a decl file into declarations, taking them from the decl cache if
+the file didn't change. This is run as a job while registering a decl folder.
+================
+*/
+static void ScanDeclFile( declFileScan_t *scan ) {
+	scan->checksum = MD5_BlockChecksum( scan->buffer, scan->length );
+	scan->cached = false;
+
+	if ( declManagerLocal.UseDeclCache() ) {
+		const declCacheEntry_t *entry = declManagerLocal.FindDeclCache( scan->file->fileName, scan->checksum, scan->length, scan->file->defaultType );
+		if ( entry ) {
+			scan->spans = entry->spans;
+			scan->numLines = entry->numLines;
+			scan->clean = true;
+			scan->cached = true;
+			return;
+		}
+	}
+
+	if ( !idDeclFile::ScanText( scan->buffer, scan->length, scan->file->fileName, scan->file->defaultType, false, scan->spans, scan->numLines ) ) {
+		scan->clean = false;
+		return;
+	}
+	scan->clean = true;
+}
+
+REGISTER_PARALLEL_JOB( ScanDeclFile, "ScanDeclFile" );
+
+/*
+================
+idDeclFile::MergeScan
+
+Finishes a scan made by ScanDeclFile on the main thread and frees the text.
+================
+*/
+void idDeclFile::MergeScan( declFileScan_t &scan ) {
+	if ( !scan.clean ) {
+		// scan again to print the warnings, these files are never cached
+		if ( !ScanText( scan.buffer, scan.length, fileName, defaultType, true, scan.spans, scan.numLines ) ) {
+			common->Error( "Couldn't parse %s", fileName.c_str() );
+		}
+	} else if ( !scan.cached && declManagerLocal.UseDeclCache() ) {
+		declManagerLocal.AddDeclCache( scan );
+	}
+
+	MergeText( scan.buffer, scan.length, scan.checksum, scan.spans, scan.numLines );
+
+	Mem_Free( scan.buffer );
+	scan.buffer = NULL;
+}
+
+/*
+================
+idDeclFile::LoadAndParse
+
+This is used during both the initial load, and any reloads
+================
+*/
+int c_savedMemory = 0;
+
+int idDeclFile::LoadAndParse() {
+	declFileScan_t scan;
+
+	// load the text
+	common->DPrintf( "...loading '%s'\n", fileName.c_str() );
+	scan.file = this;
+	scan.length = fileSystem->ReadFile( fileName, (void **)&scan.buffer, &timestamp );
+	if ( scan.length == -1 ) {
+		common->FatalError( "couldn't load %s", fileName.c_str() );
+		return 0;
+	}
+
+	ScanDeclFile( &scan );
+	MergeScan( scan );
 
 	return checksum;
 }
@@ -811,6 +972,8 @@ void idDeclManagerLocal::Init( void ) {
 	RegisterDeclType( "particle",			DECL_PARTICLE,		idDeclAllocator<idDeclParticle> );
 	RegisterDeclType( "articulatedFigure",	DECL_AF,			idDeclAllocator<idDeclAF> );
 
+	LoadDeclCache();
+
 	RegisterDeclFolder( "materials",		".mtr",				DECL_MATERIAL );
 	RegisterDeclFolder( "skins",			".skin",			DECL_SKIN );
 	RegisterDeclFolder( "sound",			".sndshd",			DECL_SOUND );
@@ -855,6 +1018,9 @@ void idDeclManagerLocal::Shutdown( void ) {
 	int			i, j;
 	idDeclLocal *decl;
 
+	SaveDeclCache();
+	FreeDeclCache();
+
 	// free decls
 	for ( i = 0; i < DECL_MAX_TYPES; i++ ) {
 		for ( j = 0; j < linearLists[i].Num(); j++ ) {
@@ -891,6 +1057,9 @@ idDeclManagerLocal::Reload
 ===================
 */
 void idDeclManagerLocal::Reload( bool force ) {
+	// loose files might have been added in front of the paks
+	fileSystem->ClearDirCache();
+
 	for ( int i = 0; i < loadedFiles.Num(); i++ ) {
 		loadedFiles[i]->Reload( force );
 	}
@@ -923,6 +1092,9 @@ idDeclManagerLocal::EndLevelLoad
 void idDeclManagerLocal::EndLevelLoad() {
 	insideLevelLoad = false;
 
+	// remember the decl files scanned since startup or the last level
+	SaveDeclCache();
+
 	// we don't need to do anything here, but the image manager, model manager,
 	// and sound sample manager will need to free media that was not referenced
 }
@@ -962,6 +1134,8 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 	idDeclFolder *declFolder;
 	idFileList *fileList;
 	idDeclFile *df;
+	idList<idDeclFile *> files;
+	idTimer listTimer, readTimer, scanTimer, mergeTimer;
 
 	// check whether this folder / extension combination already exists
 	for ( i = 0; i < declFolders.Num(); i++ ) {
@@ -980,9 +1154,10 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 	}
 
 	// scan for decl files
+	listTimer.Start();
 	fileList = fileSystem->ListFiles( declFolder->folder, declFolder->extension, true );
 
-	// load and parse decl files
+	files.SetGranularity( 256 );
 	for ( i = 0; i < fileList->GetNumFiles(); i++ ) {
 		fileName = declFolder->folder + "/" + fileList->GetFile( i );
 
@@ -998,10 +1173,260 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 			df = new idDeclFile( fileName, defaultType );
 			loadedFiles.Append( df );
 		}
-		df->LoadAndParse();
+		files.Append( df );
 	}
 
 	fileSystem->FreeFileList( fileList );
+	listTimer.Stop();
+
+	if ( !decl_parallelLoad.GetBool() || files.Num() < 2 ) {
+		scanTimer.Start();
+		for ( i = 0; i < files.Num(); i++ ) {
+			files[i]->LoadAndParse();
+		}
+		scanTimer.Stop();
+		common->Printf( "%s/*%s: %d files, list %.1f ms, parse %.1f ms\n", folder, extension, files.Num(),
+						listTimer.Milliseconds(), scanTimer.Milliseconds() );
+		return;
+	}
+
+	// the file system isn't thread safe, so the files are read here
+	readTimer.Start();
+	idList<declFileScan_t> scans;
+	scans.SetNum( files.Num() );
+	for ( i = 0; i < files.Num(); i++ ) {
+		declFileScan_t &scan = scans[i];
+		scan.file = files[i];
+		common->DPrintf( "...loading '%s'\n", scan.file->fileName.c_str() );
+		scan.length = fileSystem->ReadFile( scan.file->fileName, (void **)&scan.buffer, &scan.file->timestamp );
+		if ( scan.length == -1 ) {
+			common->FatalError( "couldn't load %s", scan.file->fileName.c_str() );
+		}
+	}
+	readTimer.Stop();
+
+	// split the texts into declarations on the job threads
+	scanTimer.Start();
+	idParallelJobList *jobs = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, scans.Num(), 0, NULL );
+	for ( i = 0; i < scans.Num(); i++ ) {
+		jobs->AddJob( (jobRun_t)ScanDeclFile, &scans[i] );
+	}
+	jobs->Submit();
+	jobs->Wait();
+	parallelJobManager->FreeJobList( jobs );
+	scanTimer.Stop();
+
+	// create the decls in file list order, so redefinitions resolve just like a serial load
+	mergeTimer.Start();
+	int numCached = 0;
+	for ( i = 0; i < scans.Num(); i++ ) {
+		if ( scans[i].cached ) {
+			numCached++;
+		}
+		scans[i].file->MergeScan( scans[i] );
+	}
+	mergeTimer.Stop();
+
+	common->Printf( "%s/*%s: %d files (%d cached), list %.1f ms, read %.1f ms, scan %.1f ms, merge %.1f ms\n", folder, extension,
+					files.Num(), numCached, listTimer.Milliseconds(), readTimer.Milliseconds(), scanTimer.Milliseconds(), mergeTimer.Milliseconds() );
+}
+
+/*
+===================
+idDeclManagerLocal::FindDeclCache
+
+Can be called from the job threads while registering a decl folder, the cache
+is only modified on the main thread.
+===================
+*/
+declCacheEntry_t *idDeclManagerLocal::FindDeclCache( const char *fileName, int checksum, int length, declType_t defaultType ) {
+	int hash = declCacheHash.GenerateKey( fileName, false );
+	for ( int i = declCacheHash.First( hash ); i != -1; i = declCacheHash.Next( i ) ) {
+		declCacheEntry_t *entry = declCache[i];
+		if ( entry->checksum == checksum && entry->length == length && entry->defaultType == defaultType &&
+				entry->numDeclTypes == declTypes.Num() && entry->fileName.Icmp( fileName ) == 0 ) {
+			entry->used = true;
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/*
+===================
+idDeclManagerLocal::AddDeclCache
+===================
+*/
+void idDeclManagerLocal::AddDeclCache( const declFileScan_t &scan ) {
+	declCacheEntry_t *entry = new declCacheEntry_t;
+	entry->fileName = scan.file->fileName;
+	entry->checksum = scan.checksum;
+	entry->length = scan.length;
+	entry->defaultType = scan.file->defaultType;
+	entry->numDeclTypes = declTypes.Num();
+	entry->numLines = scan.numLines;
+	entry->spans = scan.spans;
+	entry->used = true;
+
+	declCacheHash.Add( declCacheHash.GenerateKey( entry->fileName, false ), declCache.Append( entry ) );
+	declCacheChanged = true;
+}
+
+/*
+===================
+ReadDeclCacheInt
+===================
+*/
+static bool ReadDeclCacheInt( idFile *f, int &value ) {
+	return f->ReadInt( value ) == sizeof( value );
+}
+
+/*
+===================
+ReadDeclCacheString
+===================
+*/
+static bool ReadDeclCacheString( idFile *f, idStr &string ) {
+	int len;
+	if ( !ReadDeclCacheInt( f, len ) || len < 0 || len > f->Length() - f->Tell() ) {
+		return false;
+	}
+	string.Fill( ' ', len );
+	return f->Read( &string[0], len ) == len;
+}
+
+/*
+===================
+idDeclManagerLocal::LoadDeclCache
+
+The cache remembers where the declarations of each decl file are, so unchanged
+files don't have to be tokenized again.
+===================
+*/
+void idDeclManagerLocal::LoadDeclCache( void ) {
+	idFile *f;
+	idStr ident;
+	int version, num, numSpans;
+
+	FreeDeclCache();
+
+	if ( !decl_useCache.GetBool() ) {
+		return;
+	}
+
+	f = fileSystem->OpenExplicitFileRead( fileSystem->RelativePathToOSPath( DECL_CACHE_FILE, "fs_savepath" ) );
+	if ( !f ) {
+		return;
+	}
+
+	if ( !ReadDeclCacheString( f, ident ) || ident != DECL_CACHE_IDENT || !ReadDeclCacheInt( f, version ) || version != DECL_CACHE_VERSION ||
+			!ReadDeclCacheInt( f, num ) ) {
+		common->Printf( "ignoring outdated %s\n", DECL_CACHE_FILE );
+		fileSystem->CloseFile( f );
+		return;
+	}
+
+	for ( int i = 0; i < num; i++ ) {
+		declCacheEntry_t *entry = new declCacheEntry_t;
+		int defaultType;
+		bool ok = ReadDeclCacheString( f, entry->fileName ) && ReadDeclCacheInt( f, entry->checksum ) && ReadDeclCacheInt( f, entry->length ) &&
+					ReadDeclCacheInt( f, defaultType ) && ReadDeclCacheInt( f, entry->numDeclTypes ) && ReadDeclCacheInt( f, entry->numLines ) &&
+					ReadDeclCacheInt( f, numSpans ) && numSpans >= 0 && numSpans <= f->Length() - f->Tell();
+		if ( ok ) {
+			entry->defaultType = (declType_t)defaultType;
+			entry->spans.SetNum( numSpans );
+			for ( int j = 0; j < numSpans && ok; j++ ) {
+				declTextSpan_t &span = entry->spans[j];
+				int type;
+				ok = ReadDeclCacheInt( f, type ) && ReadDeclCacheString( f, span.name ) && ReadDeclCacheInt( f, span.offset ) &&
+						ReadDeclCacheInt( f, span.length ) && ReadDeclCacheInt( f, span.line ) && ReadDeclCacheInt( f, span.endLine ) &&
+						type >= 0 && type < DECL_MAX_TYPES && span.offset >= 0 && span.length >= 0 && span.offset + span.length <= entry->length;
+				span.type = (declType_t)type;
+			}
+		}
+		if ( !ok ) {
+			common->Warning( "%s is corrupt, ignoring the rest of it", DECL_CACHE_FILE );
+			delete entry;
+			break;
+		}
+		entry->used = false;
+		declCacheHash.Add( declCacheHash.GenerateKey( entry->fileName, false ), declCache.Append( entry ) );
+	}
+
+	fileSystem->CloseFile( f );
+
+	common->Printf( "%d decl files in %s\n", declCache.Num(), DECL_CACHE_FILE );
+}
+
+/*
+===================
+idDeclManagerLocal::SaveDeclCache
+
+Only writes the entries used since the cache was loaded, the others belong to
+files that were changed or removed.
+===================
+*/
+void idDeclManagerLocal::SaveDeclCache( void ) {
+	idFile *f;
+	int num;
+
+	if ( !declCacheChanged || !decl_useCache.GetBool() ) {
+		return;
+	}
+	declCacheChanged = false;
+
+	f = fileSystem->OpenFileWrite( DECL_CACHE_FILE, "fs_savepath" );
+	if ( !f ) {
+		common->Warning( "couldn't write %s", DECL_CACHE_FILE );
+		return;
+	}
+
+	num = 0;
+	for ( int i = 0; i < declCache.Num(); i++ ) {
+		if ( declCache[i]->used ) {
+			num++;
+		}
+	}
+
+	f->WriteString( DECL_CACHE_IDENT );
+	f->WriteInt( DECL_CACHE_VERSION );
+	f->WriteInt( num );
+
+	for ( int i = 0; i < declCache.Num(); i++ ) {
+		const declCacheEntry_t *entry = declCache[i];
+		if ( !entry->used ) {
+			continue;
+		}
+		f->WriteString( entry->fileName );
+		f->WriteInt( entry->checksum );
+		f->WriteInt( entry->length );
+		f->WriteInt( entry->defaultType );
+		f->WriteInt( entry->numDeclTypes );
+		f->WriteInt( entry->numLines );
+		f->WriteInt( entry->spans.Num() );
+		for ( int j = 0; j < entry->spans.Num(); j++ ) {
+			const declTextSpan_t &span = entry->spans[j];
+			f->WriteInt( span.type );
+			f->WriteString( span.name );
+			f->WriteInt( span.offset );
+			f->WriteInt( span.length );
+			f->WriteInt( span.line );
+			f->WriteInt( span.endLine );
+		}
+	}
+
+	fileSystem->CloseFile( f );
+}
+
+/*
+===================
+idDeclManagerLocal::FreeDeclCache
+===================
+*/
+void idDeclManagerLocal::FreeDeclCache( void ) {
+	declCache.DeleteContents( true );
+	declCacheHash.Free();
+	declCacheChanged = false;
 }
 
 /*
@@ -1139,6 +1564,8 @@ idDeclManagerLocal::ReloadFile
 ===============
 */
 void idDeclManagerLocal::ReloadFile( const char* filename, bool force ) {
+	fileSystem->ClearDirCache();
+
 	for ( int i = 0; i < loadedFiles.Num(); i++ ) {
 		if(!loadedFiles[i]->fileName.Icmp(filename)) {
 			checksum ^= loadedFiles[i]->checksum;
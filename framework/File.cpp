@@ -19,6 +19,7 @@
 
 
 #include "minizip/unzip.h"
+#include "../ExtLibs/zlib.h"
 
 /*
 =================
@@ -1432,3 +1433,233 @@ int idFile_InZip::Seek( long offset, fsOrigin_t origin ) {
 	}
 	return -1;
 }
+
+
+/*
+=================================================================================
+
+idFile_InZipMapped
+
+=================================================================================
+*/
+
+/*
+=================
+idFile_InZipMapped::idFile_InZipMapped
+=================
+*/
+idFile_InZipMapped::idFile_InZipMapped( void ) {
+	name = "invalid";
+	compressed = false;
+	data = NULL;
+	dataSize = 0;
+	fileSize = 0;
+	filePos = 0;
+	fileLastMod = 0;
+	stream = NULL;
+}
+
+/*
+=================
+idFile_InZipMapped::~idFile_InZipMapped
+=================
+*/
+idFile_InZipMapped::~idFile_InZipMapped( void ) {
+	EndInflate();
+}
+
+/*
+=================
+idFile_InZipMapped::Inflate
+
+Inflates the next bytes of a deflated file, the inflate state is created on demand
+=================
+*/
+int idFile_InZipMapped::Inflate( void *buffer, int len ) {
+	z_stream *zs = static_cast<z_stream *>( stream );
+
+	if ( !zs ) {
+		zs = new z_stream;
+		memset( zs, 0, sizeof( *zs ) );
+		zs->next_in = const_cast<Bytef *>( data );
+		zs->avail_in = dataSize;
+		if ( ExtLibs::inflateInit2( zs, -MAX_WBITS ) != Z_OK ) {
+			delete zs;
+			common->Warning( "idFile_InZipMapped::Inflate: inflateInit2 failed for %s", name.c_str() );
+			return 0;
+		}
+		stream = zs;
+	}
+
+	zs->next_out = static_cast<Bytef *>( buffer );
+	zs->avail_out = len;
+
+	const int err = ExtLibs::inflate( zs, Z_SYNC_FLUSH );
+	if ( err != Z_OK && err != Z_STREAM_END ) {
+		common->Warning( "idFile_InZipMapped::Inflate: error %d in %s", err, name.c_str() );
+	}
+
+	return len - zs->avail_out;
+}
+
+/*
+=================
+idFile_InZipMapped::EndInflate
+=================
+*/
+void idFile_InZipMapped::EndInflate( void ) {
+	z_stream *zs = static_cast<z_stream *>( stream );
+
+	if ( zs ) {
+		ExtLibs::inflateEnd( zs );
+		delete zs;
+		stream = NULL;
+	}
+}
+
+/*
+=================
+idFile_InZipMapped::Read
+
+Properly handles partial reads
+=================
+*/
+int idFile_InZipMapped::Read( void *buffer, int len ) {
+	if ( len > fileSize - filePos ) {
+		len = fileSize - filePos;
+	}
+	if ( len <= 0 ) {
+		return 0;
+	}
+
+	if ( compressed ) {
+		len = Inflate( buffer, len );
+	} else {
+		memcpy( buffer, data + filePos, len );
+	}
+
+	filePos += len;
+	fileSystem->AddToReadCount( len );
+
+	return len;
+}
+
+/*
+=================
+idFile_InZipMapped::Write
+=================
+*/
+int idFile_InZipMapped::Write( const void *buffer, int len ) {
+	common->FatalError( "idFile_InZipMapped::Write: cannot write to the zipped file %s", name.c_str() );
+	return 0;
+}
+
+/*
+=================
+idFile_InZipMapped::ForceFlush
+=================
+*/
+void idFile_InZipMapped::ForceFlush( void ) {
+	common->FatalError( "idFile_InZipMapped::ForceFlush: cannot flush the zipped file %s", name.c_str() );
+}
+
+/*
+=================
+idFile_InZipMapped::Flush
+=================
+*/
+void idFile_InZipMapped::Flush( void ) {
+	common->FatalError( "idFile_InZipMapped::Flush: cannot flush the zipped file %s", name.c_str() );
+}
+
+/*
+=================
+idFile_InZipMapped::Tell
+=================
+*/
+int idFile_InZipMapped::Tell( void ) {
+	return filePos;
+}
+
+/*
+================
+idFile_InZipMapped::Length
+================
+*/
+int idFile_InZipMapped::Length( void ) {
+	return fileSize;
+}
+
+/*
+================
+idFile_InZipMapped::Timestamp
+================
+*/
+ID_TIME_T idFile_InZipMapped::Timestamp( void ) {
+	return fileLastMod;
+}
+
+/*
+================
+idFile_InZipMapped::IsCompressed
+================
+*/
+bool idFile_InZipMapped::IsCompressed( void ) {
+	return compressed;
+}
+
+/*
+=================
+idFile_InZipMapped::Seek
+
+  returns zero on success and -1 on failure
+=================
+*/
+int idFile_InZipMapped::Seek( long offset, fsOrigin_t origin ) {
+	int pos;
+
+	switch( origin ) {
+		case FS_SEEK_END: {
+			pos = fileSize - offset;
+			break;
+		}
+		case FS_SEEK_CUR: {
+			pos = filePos + offset;
+			break;
+		}
+		case FS_SEEK_SET: {
+			pos = offset;
+			break;
+		}
+		default: {
+			common->FatalError( "idFile_InZipMapped::Seek: bad origin for %s\n", name.c_str() );
+			return -1;
+		}
+	}
+
+	if ( pos < 0 || pos > fileSize ) {
+		return -1;
+	}
+
+	if ( !compressed ) {
+		filePos = pos;
+		return 0;
+	}
+
+	// deflated data can only be skipped forward, restart from the beginning if needed
+	if ( pos < filePos ) {
+		EndInflate();
+		filePos = 0;
+	}
+
+	char *buf = (char *) _alloca16( ZIP_SEEK_BUF_SIZE );
+	while ( filePos < pos ) {
+		const int res = Inflate( buf, Min( pos - filePos, ZIP_SEEK_BUF_SIZE ) );
+		if ( res <= 0 ) {
+			return -1;
+		}
+		filePos += res;
+	}
+
+	return 0;
+}
@@ -238,4 +238,46 @@ private:
 	void *					z;				// unzip info
 };
 
+
+/*
+	File inside a memory mapped pk4. Stored files are read straight out of the mapping,
+	deflated files are inflated from it directly into the destination buffer.
+*/
+class idFile_InZipMapped : public idFile {
+	friend class			idFileSystemLocal;
+
+public:
+							idFile_InZipMapped( void );
+	virtual					~idFile_InZipMapped( void );
+
+	virtual const char *	GetName( void ) { return name.c_str(); }
+	virtual const char *	GetFullPath( void ) { return fullPath.c_str(); }
+	virtual int				Read( void *buffer, int len );
+	virtual int				Write( const void *buffer, int len );
+	virtual int				Length( void );
+	virtual ID_TIME_T		Timestamp( void );
+	virtual int				Tell( void );
+	virtual void			ForceFlush( void );
+	virtual void			Flush( void );
+	virtual int				Seek( long offset, fsOrigin_t origin );
+	virtual bool			IsCompressed( void );
+
+							// returns the file contents inside the mapping, NULL if the file is deflated
+	const byte *			GetDataPtr( void ) const { return compressed ? NULL : data; }
+
+private:
+	idStr					name;			// name of the file in the pak
+	idStr					fullPath;		// full file path including pak file name
+	bool					compressed;		// whether the data is deflated
+	const byte *			data;			// file data inside the mapped pak
+	int						dataSize;		// size of the data inside the pak
+	int						fileSize;		// uncompressed size of the file
+	int						filePos;		// current position in the uncompressed file
+	ID_TIME_T				fileLastMod;	// last modified date/time of the file
+	void *					stream;			// inflate state of deflated files, NULL until the first read
+
+	int						Inflate( void *buffer, int len );
+	void					EndInflate( void );
+};
+
 #endif /* !__FILE_H__ */
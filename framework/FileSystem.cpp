@@ -22,6 +22,9 @@
 //stgatilov: for pk4 repacking
 #include "minizip/zip.h"
 
+#include <atomic>
+#include <mutex>
+
 #ifdef WIN32
 	#include <io.h>	// for _read
     #include <sys/utime.h> // for _utime
@@ -155,6 +158,8 @@ typedef struct {
 	bool				isNew;						// for downloaded paks
 	fileInPack_t		*hashTable[FILE_HASH_SIZE];
 	fileInPack_t		*buildBuffer;
+	const byte *		mapping;					// whole pk4 mapped read only, NULL if not mapped
+	int					mappingLength;
 } pack_t;
 
 typedef struct {
@@ -168,6 +173,16 @@ typedef struct searchpath_s {
 	struct searchpath_s *next;
 } searchpath_t;
 
+// entry of the global file index, maps a lowercase relative path to the first search path holding it
+typedef struct {
+	idStr				name;						// lowercase with forward slashes
+	pack_t *			pak;						// first pak on the search path holding the file, NULL if none
+	fileInPack_t *		pakFile;
+	int					pakOrder;					// position of that pak on the search path
+	directory_t *		dir;						// first directory before the pak holding the file, NULL if none
+	int					dirGeneration;				// dir is only valid while this matches fileIndexGeneration
+} fileIndexEntry_t;
+
 // search flags when opening a file
 #define FSFLAG_SEARCH_DIRS		( 1 << 0 )
 #define FSFLAG_SEARCH_PAKS		( 1 << 1 )
@@ -220,6 +235,8 @@ public:
 	virtual int				GetOSMask( void );
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp );
 	virtual void			FreeFile( void *buffer );
+	virtual int				ReadFileView( const char *relativePath, const void **buffer, ID_TIME_T *timestamp );
+	virtual void			FreeFileView( const void *buffer );
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_modSavePath", const char *gamedir = NULL );
 	virtual void			RemoveFile( const char *relativePath, const char *gamedir = NULL);
     virtual idFile *		OpenFileReadFlags( const char *relativePath, int searchFlags, pack_t **foundInPak = NULL, const char* gamedir = NULL );
@@ -234,6 +251,7 @@ public:
 	virtual void			ResetReadCount( void ) { readCount = 0; }
 	virtual void			AddToReadCount( int c ) { readCount += c; }
 	virtual int				GetReadCount( void ) { return readCount; }
+	virtual int				GetOSCallCount( void ) { return osCallCount; }
 	virtual void			FindDLL( const char *basename, char dllPath[ MAX_OSPATH ], bool updateChecksum );
 	virtual void			ClearDirCache( void );
 	virtual bool			CopyFile( const char *fromOSPath, const char *toOSPath );
@@ -253,14 +271,17 @@ public:
 	static void				Path_f( const idCmdArgs &args );
 	static void				TouchFile_f( const idCmdArgs &args );
 	static void				TouchFileList_f( const idCmdArgs &args );
+	static void				FileIndexStats_f( const idCmdArgs &args );
+	static void				BenchmarkPaks_f( const idCmdArgs &args );
 
 private:
     friend THREAD_RETURN_TYPE 			BackgroundDownloadThread(void *parms);
 
 	searchpath_t *			searchPaths;
-	int						readCount;			// total bytes read
+	std::atomic<int>		readCount;			// total bytes read, also counted by the background download thread
 	int						loadCount;			// total files read
 	int						loadStack;			// total files in memory
+	int						osCallCount;		// stat, fopen and directory listing calls made to find files
 	idStr					gameFolder;			// this will be a single name without separators
 
 	searchpath_t			*addonPaks;			// not loaded up, but we saw them
@@ -273,6 +294,8 @@ private:
 	static idCVar			fs_devpath;
 	static idCVar			fs_caseSensitiveOS;
 	static idCVar			fs_searchAddons;
+	static idCVar			fs_useIndex;
+	static idCVar			fs_mapPaks;
 
     // taaaki: fs_game and fs_game_base have been removed as TDM is no longer a mod and these fs cvars were causing
     // confusion due to inconsistent usage. fs_mod has been added to allow for mods of TDM.
@@ -302,6 +325,19 @@ private:
 	int						dir_cache_index;
 	int						dir_cache_count;
 
+	// global lookup index over all search paths, rebuilt at Startup and extended by AddZipFile
+	idList<fileIndexEntry_t> fileIndex;				// all files in the paks plus cached lookups
+	idHashIndex				fileIndexHash;
+	idList<directory_t *>	fileIndexDirs;			// loose directories on the search path, in search order
+	idList<int>				fileIndexDirOrder;		// search path position of each directory
+	int						fileIndexOrder;			// search path position of the next pak appended, 0 if there is no index
+	int						fileIndexGeneration;	// bumped whenever loose files may have changed
+	int						fileIndexLookups;
+	int						fileIndexMisses;		// lookups answered by a cached miss
+	// files are opened from the game, frontend and backend threads, guards the index and the dir cache,
+	// recursive because the index probes directories through ListOSFiles
+	std::recursive_mutex	fileIndexMutex;
+
 private:
 	void					ReplaceSeparators( idStr &path, char sep = PATHSEPERATOR_CHAR );
     int 					HashFileName(const char *fname) const;
@@ -326,10 +362,21 @@ private:
 							// searches all the paks
 	pack_t *				FindPakForFileChecksum( const char *relativePath, int fileChecksum, bool bReference );
 	idFile_InZip *			ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
+	idFile_InZipMapped *	ReadFileFromMappedZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
+	idFile *				OpenFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
 	int						GetFileChecksum( idFile *file );
 	addonInfo_t *			ParseAddonDef( const char *buf, const int len );
 	void					FollowAddonDependencies( pack_t *pak );
 
+	void					ClearFileIndex( void );
+	void					BuildFileIndex( void );
+	void					AddPakToFileIndex( pack_t *pak, int order );
+	fileIndexEntry_t *		FindFileIndexEntry( const char *name );
+	idFile *				OpenFileReadFromIndex( const char *relativePath, int searchFlags, pack_t **foundInPak );
+	idFile *				OpenFileInDir( directory_t *dir, const char *relativePath );
+	idFile *				OpenFileInPak( pack_t *pak, fileInPack_t *pakFile, const char *relativePath, pack_t **foundInPak );
+	idFile *				OpenFileInAddons( const char *relativePath, int hash, pack_t **foundInPak );
+
 	static size_t			CurlWriteFunction( void *ptr, size_t size, size_t nmemb, void *stream );
 							// curl_progress_callback in curl.h
 	static int				CurlProgressFunction( void *clientp, double dltotal, double dlnow, double ultotal, double ulnow );
@@ -349,6 +396,8 @@ idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "0", CVAR_SY
 idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "1", CVAR_SYSTEM | CVAR_BOOL, "" );
 #endif
 idCVar	idFileSystemLocal::fs_searchAddons( "fs_searchAddons", "0", CVAR_SYSTEM | CVAR_BOOL, "search all addon pk4s ( disables addon functionality )" );
+idCVar	idFileSystemLocal::fs_mapPaks( "fs_mapPaks", sizeof( void * ) == 8 ? "1" : "0", CVAR_SYSTEM | CVAR_BOOL | CVAR_INIT, "memory map pk4 files and read them without going through minizip" );
+idCVar	idFileSystemLocal::fs_useIndex( "fs_useIndex", "1", CVAR_SYSTEM | CVAR_BOOL, "look up files through the global file index instead of walking the search path" );
 
 // greebo: Custom savepath in darkmod/fms/
 idCVar	idFileSystemLocal::fs_modSavePath( "fs_modSavePath", "", CVAR_SYSTEM | CVAR_INIT, "This is where all screenshots and savegames will be written to." );
@@ -366,8 +415,13 @@ idFileSystemLocal::idFileSystemLocal( void ) {
 	readCount = 0;
 	loadCount = 0;
 	loadStack = 0;
+	osCallCount = 0;
 	dir_cache_index = 0;
 	dir_cache_count = 0;
+	fileIndexOrder = 0;
+	fileIndexGeneration = 0;
+	fileIndexLookups = 0;
+	fileIndexMisses = 0;
 	loadedFileFromDir = false;
 	restartGamePakChecksum = 0;
 	memset( &backgroundThread, 0, sizeof( backgroundThread ) );
@@ -452,15 +506,23 @@ FILE *idFileSystemLocal::OpenOSFile( const char *fileName, const char *mode, idS
 	idStr fpath, entry;
 	idStrList list;
 
+	if ( mode[0] != 'r' ) {
+		// a loose file might be created, directory hits in the file index are stale now
+		std::lock_guard<std::recursive_mutex> lock( fileIndexMutex );
+		fileIndexGeneration++;
+	}
+
 #ifndef __MWERKS__
 #ifndef WIN32 
 	// some systems will let you fopen a directory
 	struct stat buf;
+	osCallCount++;
 	if ( stat( fileName, &buf ) != -1 && !S_ISREG(buf.st_mode) ) {
 		return NULL;
 	}
 #endif
 #endif
+	osCallCount++;
 	fp = fopen( fileName, mode );
 	if ( !fp && fs_caseSensitiveOS.GetBool() ) {
 		fpath = fileName;
@@ -473,6 +535,7 @@ FILE *idFileSystemLocal::OpenOSFile( const char *fileName, const char *mode, idS
 		for ( int i = 0; i < list.Num(); i++ ) {
 			entry = fpath + PATHSEPERATOR_CHAR + list[i];
 			if ( !entry.Icmp( fileName ) ) {
+				osCallCount++;
 				fp = fopen( entry, mode );
 				if ( fp ) {
 					if ( caseSensitiveName ) {
@@ -998,6 +1061,83 @@ void idFileSystemLocal::FreeFile( void *buffer ) {
 	Mem_Free( buffer );
 }
 
+/*
+============
+idFileSystemLocal::ReadFileView
+============
+*/
+int idFileSystemLocal::ReadFileView( const char *relativePath, const void **buffer, ID_TIME_T *timestamp ) {
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	} else if ( !relativePath || !relativePath[0] ) {
+		common->FatalError( "idFileSystemLocal::ReadFileView: NULL 'relativePath' parameter passed\n" );
+	}
+
+	*buffer = NULL;
+	if ( timestamp ) {
+		*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+	}
+
+	idFile *f = OpenFileRead( relativePath );
+	if ( f == NULL ) {
+		return -1;
+	}
+
+	if ( timestamp ) {
+		*timestamp = f->Timestamp();
+	}
+
+	const int len = f->Length();
+
+	loadCount++;
+	loadStack++;
+
+	idFile_InZipMapped *mapped = dynamic_cast<idFile_InZipMapped *>( f );
+	if ( mapped && mapped->GetDataPtr() ) {
+		// stored in a mapped pak, hand out the mapping itself
+		*buffer = mapped->GetDataPtr();
+	} else {
+		byte *buf = (byte *)Mem_Alloc( Max( len, 1 ) );
+		f->Read( buf, len );
+		*buffer = buf;
+	}
+
+	CloseFile( f );
+
+	return len;
+}
+
+/*
+=============
+idFileSystemLocal::FreeFileView
+=============
+*/
+void idFileSystemLocal::FreeFileView( const void *buffer ) {
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	} else if ( !buffer ) {
+		common->FatalError( "idFileSystemLocal::FreeFileView( NULL )" );
+	}
+	loadStack--;
+
+	// views into a mapped pak are not owned by the caller
+	const byte *ptr = (const byte *)buffer;
+	for ( searchpath_t *search = searchPaths; search; search = search->next ) {
+		const pack_t *pak = search->pack;
+		if ( pak && pak->mapping && ptr >= pak->mapping && ptr < pak->mapping + pak->mappingLength ) {
+			return;
+		}
+	}
+	for ( searchpath_t *search = addonPaks; search; search = search->next ) {
+		const pack_t *pak = search->pack;
+		if ( pak && pak->mapping && ptr >= pak->mapping && ptr < pak->mapping + pak->mappingLength ) {
+			return;
+		}
+	}
+
+	Mem_Free( const_cast<void *>( buffer ) );
+}
+
 /*
 ============
 idFileSystemLocal::WriteFile
@@ -1270,6 +1410,8 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	pack->addon_search = false;
 	pack->addon_info = NULL;
 	pack->isNew = false;
+	pack->mapping = NULL;
+	pack->mappingLength = 0;
 
 	pack->length = len;
 
@@ -1311,6 +1453,13 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 			return NULL;	//repacking error
 	}
 
+	if ( fs_mapPaks.GetBool() ) {
+		pack->mapping = (const byte *)Sys_MapFile( zipfile, &pack->mappingLength );
+		if ( !pack->mapping ) {
+			common->Warning( "Couldn't map %s, reading it through minizip", zipfile );
+		}
+	}
+
 	// check if this is an addon pak
 	pack->addon = false;
 	confHash = HashFileName( ADDON_CONFIG );
@@ -1373,6 +1522,9 @@ int idFileSystemLocal::AddZipFile( const char *path ) {
 	}
 
 	last->next = search;
+	if ( fileIndexOrder ) {
+		AddPakToFileIndex( pak, fileIndexOrder++ );
+	}
 	common->Printf( "Appended %s (checksum 0x%x)\n", pak->pakFilename.c_str(), pak->checksum );
 	return pak->checksum;
 }
@@ -1772,9 +1924,12 @@ int	idFileSystemLocal::ListOSFiles( const char *directory, const char *extension
 	}
 
 	if ( !fs_caseSensitiveOS.GetBool() ) {
+		osCallCount++;
 		return Sys_ListFiles( directory, extension, list );
 	}
 
+	std::lock_guard<std::recursive_mutex> lock( fileIndexMutex );
+
 	// try in cache
 	for ( int i = dir_cache_index - 1; i >= (dir_cache_index - dir_cache_count); i-- ) {
 		j = (i+MAX_CACHED_DIRS) % MAX_CACHED_DIRS;
@@ -1793,6 +1948,7 @@ int	idFileSystemLocal::ListOSFiles( const char *directory, const char *extension
 	}
 #endif
 
+	osCallCount++;
 	ret = Sys_ListFiles( directory, extension, list );
 
 	if ( ret == -1 ) {
@@ -2287,10 +2443,14 @@ void idFileSystemLocal::Startup( void ) {
 	cmdSystem->AddCommand( "path", Path_f, CMD_FL_SYSTEM, "lists search paths" );
 	cmdSystem->AddCommand( "touchFile", TouchFile_f, CMD_FL_SYSTEM, "touches a file" );
 	cmdSystem->AddCommand( "touchFileList", TouchFileList_f, CMD_FL_SYSTEM, "touches a list of files" );
+	cmdSystem->AddCommand( "fs_indexStats", FileIndexStats_f, CMD_FL_SYSTEM, "prints file index statistics, use 'reset' to clear the counters" );
+	cmdSystem->AddCommand( "fs_benchmarkPaks", BenchmarkPaks_f, CMD_FL_SYSTEM, "reads all files in the pk4s through minizip and through the mapping and compares the times" );
 
 	// print the current search paths
 	Path_f( idCmdArgs() );
 
+	BuildFileIndex();
+
 	common->Printf( "File System Initialized.\n" );
 	common->Printf( "--------------------------------------\n" );
 }
@@ -2551,6 +2711,7 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	gamePakChecksum = 0;
 
 	ClearDirCache();
+	ClearFileIndex();
 
 	// free everything - loop through searchPaths and addonPaks
 	for ( loop = searchPaths; loop; loop == searchPaths ? loop = addonPaks : loop = NULL ) {
@@ -2559,6 +2720,7 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 
 			if ( sp->pack ) {
 				unzClose( sp->pack->handle );
+				Sys_UnmapFile( sp->pack->mapping, sp->pack->mappingLength );
 				delete [] sp->pack->buildBuffer;
 				if ( sp->pack->addon_info ) {
 					sp->pack->addon_info->mapDecls.DeleteContents( true );
@@ -2581,6 +2743,8 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 	cmdSystem->RemoveCommand( "dir" );
 	cmdSystem->RemoveCommand( "dirtree" );
 	cmdSystem->RemoveCommand( "touchFile" );
+	cmdSystem->RemoveCommand( "fs_indexStats" );
+	cmdSystem->RemoveCommand( "fs_benchmarkPaks" );
 
 	mapDict.Clear();
 }
@@ -2689,6 +2853,109 @@ idFile_InZip * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pa
 	return file;
 }
 
+/*
+===========
+ZipReadShort / ZipReadInt
+
+little endian fields of zip headers, which are not necessarily aligned
+===========
+*/
+static ID_INLINE unsigned int ZipReadShort( const byte *p ) {
+	return p[0] | ( p[1] << 8 );
+}
+
+static ID_INLINE unsigned int ZipReadInt( const byte *p ) {
+	return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 );
+}
+
+#define ZIP_CENTRAL_HEADER_MAGIC	0x02014b50
+#define ZIP_CENTRAL_HEADER_SIZE		46
+#define ZIP_LOCAL_HEADER_MAGIC		0x04034b50
+#define ZIP_LOCAL_HEADER_SIZE		30
+
+/*
+===========
+idFileSystemLocal::ReadFileFromMappedZip
+
+Locates the file data inside the mapped pak by parsing the zip headers directly.
+Returns NULL if the pak is not mapped or the entry can't be served from the mapping
+(zip64, encrypted or unusual compression), the caller falls back to minizip then.
+===========
+*/
+idFile_InZipMapped * idFileSystemLocal::ReadFileFromMappedZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
+	if ( !pak->mapping ) {
+		return NULL;
+	}
+
+	// pakFile->pos is the position of the central directory entry
+	if ( pakFile->pos + ZIP_CENTRAL_HEADER_SIZE > (ZPOS64_T)pak->mappingLength ) {
+		return NULL;
+	}
+	const byte *central = pak->mapping + pakFile->pos;
+	if ( ZipReadInt( central ) != ZIP_CENTRAL_HEADER_MAGIC ) {
+		return NULL;
+	}
+
+	const unsigned int flags = ZipReadShort( central + 8 );
+	const unsigned int method = ZipReadShort( central + 10 );
+	const unsigned int dosDate = ZipReadInt( central + 12 );
+	const unsigned int compressedSize = ZipReadInt( central + 20 );
+	const unsigned int uncompressedSize = ZipReadInt( central + 24 );
+	const unsigned int localOffset = ZipReadInt( central + 42 );
+
+	if ( flags & 1 ) {
+		return NULL;	// encrypted
+	}
+	if ( method != 0 && method != Z_DEFLATED ) {
+		return NULL;
+	}
+	if ( compressedSize >= 0x7fffffff || uncompressedSize >= 0x7fffffff || localOffset >= 0x7fffffff ) {
+		return NULL;	// zip64 or too large
+	}
+	if ( method == 0 && compressedSize != uncompressedSize ) {
+		return NULL;
+	}
+
+	if ( (ZPOS64_T)localOffset + ZIP_LOCAL_HEADER_SIZE > (ZPOS64_T)pak->mappingLength ) {
+		return NULL;
+	}
+	const byte *local = pak->mapping + localOffset;
+	if ( ZipReadInt( local ) != ZIP_LOCAL_HEADER_MAGIC ) {
+		return NULL;
+	}
+
+	const ZPOS64_T dataOffset = (ZPOS64_T)localOffset + ZIP_LOCAL_HEADER_SIZE + ZipReadShort( local + 26 ) + ZipReadShort( local + 28 );
+	if ( dataOffset + compressedSize > (ZPOS64_T)pak->mappingLength ) {
+		return NULL;
+	}
+
+	idFile_InZipMapped *file = new idFile_InZipMapped();
+	file->name = relativePath;
+	file->fullPath = pak->pakFilename + "/" + relativePath;
+	file->compressed = ( method != 0 );
+	file->data = pak->mapping + dataOffset;
+	file->dataSize = compressedSize;
+	file->fileSize = uncompressedSize;
+	file->fileLastMod = Sys_DosToUnixTime( dosDate );
+
+	return file;
+}
+
+/*
+===========
+idFileSystemLocal::OpenFileFromZip
+
+Opens a file in a pak, from the mapping if possible
+===========
+*/
+idFile * idFileSystemLocal::OpenFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
+	idFile *file = ReadFileFromMappedZip( pak, pakFile, relativePath );
+	if ( !file ) {
+		file = ReadFileFromZip( pak, pakFile, relativePath );
+	}
+	return file;
+}
+
 /*
 ===========
 idFileSystemLocal::OpenFileReadFlags
@@ -2701,12 +2968,10 @@ separate file or a ZIP file.
 */
 idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int searchFlags, pack_t **foundInPak, const char* gamedir ) {
 	searchpath_t *	search;
-	idStr			netpath;
 	pack_t *		pak;
 	fileInPack_t *	pakFile;
 	directory_t *	dir;
 	int			hash;
-	FILE *			fp;
 	
 	if ( !searchPaths ) {
 		common->FatalError( "Filesystem call made without initialization\n" );
@@ -2731,6 +2996,19 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 		return NULL;
 	}
 	
+	// the index covers the regular search path only
+	if ( fileIndexOrder && fs_useIndex.GetBool() && ( searchFlags & FSFLAG_SEARCH_PAKS ) && !( searchFlags & FSFLAG_BINARY_ONLY )
+			&& !serverPaks.Num() && !( gamedir && gamedir[0] ) ) {
+		idFile *file = OpenFileReadFromIndex( relativePath, searchFlags, foundInPak );
+		if ( !file && ( searchFlags & FSFLAG_SEARCH_ADDONS ) ) {
+			file = OpenFileInAddons( relativePath, HashFileName( relativePath ), foundInPak );
+		}
+		if ( !file && fs_debug.GetInteger( ) ) {
+			common->Printf( "Can't find %s\n", relativePath );
+		}
+		return file;
+	}
+
 	// search through the path, one element at a time
 	hash = HashFileName( relativePath );
 
@@ -2753,21 +3031,10 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 					continue;
 				}
 			}
-			
-			netpath = BuildOSPath( dir->path, dir->gamedir, relativePath );
-			fp = OpenOSFileCorrectName( netpath, "rb" );
-			if ( !fp ) {
-				continue;
-			}
 
-			idFile_Permanent *file = new idFile_Permanent();
-			file->o = fp;
-			file->name = relativePath;
-			file->fullPath = netpath;
-			file->mode = ( 1 << FS_READ );
-			file->fileSize = DirectFileLength( file->o );
-			if ( fs_debug.GetInteger() ) {
-				common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s/%s')\n", relativePath, dir->path.c_str(), dir->gamedir.c_str() );
+			idFile *file = OpenFileInDir( dir, relativePath );
+			if ( !file ) {
+				continue;
 			}
 
 			return file;
@@ -2800,56 +3067,391 @@ idFile *idFileSystemLocal::OpenFileReadFlags( const char *relativePath, int sear
 			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
 				// case and separator insensitive comparisons
 				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
+					return OpenFileInPak( pak, pakFile, relativePath, foundInPak );
+				}
+			}
+		}
+	}
 
-					if ( foundInPak ) {
-						*foundInPak = pak;
-					}
+	if ( searchFlags & FSFLAG_SEARCH_ADDONS ) {
+		idFile *file = OpenFileInAddons( relativePath, hash, foundInPak );
+		if ( file ) {
+			return file;
+		}
+	}
+	
+	if ( fs_debug.GetInteger( ) ) {
+		common->Printf( "Can't find %s\n", relativePath );
+	}
+	
+	return NULL;
+}
 
-					if ( !pak->referenced ) {
-						// mark this pak referenced
-						if ( fs_debug.GetInteger( ) ) {
-							common->Printf( "idFileSystem::OpenFileRead: %s -> adding %s to referenced paks\n", relativePath, pak->pakFilename.c_str() );
-						}
-						pak->referenced = true;
+/*
+===========
+idFileSystemLocal::OpenFileInDir
+
+Opens a loose file from the given search directory, returns NULL if it doesn't exist there
+===========
+*/
+idFile *idFileSystemLocal::OpenFileInDir( directory_t *dir, const char *relativePath ) {
+	idStr netpath = BuildOSPath( dir->path, dir->gamedir, relativePath );
+	FILE *fp = OpenOSFileCorrectName( netpath, "rb" );
+	if ( !fp ) {
+		return NULL;
+	}
+
+	idFile_Permanent *file = new idFile_Permanent();
+	file->o = fp;
+	file->name = relativePath;
+	file->fullPath = netpath;
+	file->mode = ( 1 << FS_READ );
+	file->fileSize = DirectFileLength( file->o );
+	if ( fs_debug.GetInteger() ) {
+		common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s/%s')\n", relativePath, dir->path.c_str(), dir->gamedir.c_str() );
+	}
+
+	return file;
+}
+
+/*
+===========
+idFileSystemLocal::OpenFileInPak
+===========
+*/
+idFile *idFileSystemLocal::OpenFileInPak( pack_t *pak, fileInPack_t *pakFile, const char *relativePath, pack_t **foundInPak ) {
+	idFile *file = OpenFileFromZip( pak, pakFile, relativePath );
+
+	if ( foundInPak ) {
+		*foundInPak = pak;
+	}
+
+	if ( !pak->referenced ) {
+		// mark this pak referenced
+		if ( fs_debug.GetInteger( ) ) {
+			common->Printf( "idFileSystem::OpenFileRead: %s -> adding %s to referenced paks\n", relativePath, pak->pakFilename.c_str() );
+		}
+		pak->referenced = true;
+	}
+
+	if ( fs_debug.GetInteger( ) ) {
+		common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s')\n", relativePath, pak->pakFilename.c_str() );
+	}
+	return file;
+}
+
+/*
+===========
+idFileSystemLocal::OpenFileInAddons
+
+Searches the addon paks which are not on the search path
+===========
+*/
+idFile *idFileSystemLocal::OpenFileInAddons( const char *relativePath, int hash, pack_t **foundInPak ) {
+	searchpath_t *search = addonPaks;
+	while ( search && search->pack ) {
+		pack_t *pak = search->pack;
+		for ( fileInPack_t *pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
+			if ( !FilenameCompare( pakFile->name, relativePath ) ) {
+				idFile *file = OpenFileFromZip( pak, pakFile, relativePath );
+				if ( foundInPak ) {
+					*foundInPak = pak;
+				}
+#ifdef _DEBUG
+				if ( fs_debug.GetInteger( ) ) {
+					common->Printf( "idFileSystem::OpenFileRead: %s (found in addon pk4 '%s')\n", relativePath, search->pack->pakFilename.c_str() );
+				}
+#endif
+				return file;
+			}
+		}
+		search = search->next;
+	}
+	return NULL;
+}
+
+/*
+===========
+idFileSystemLocal::ClearFileIndex
+===========
+*/
+void idFileSystemLocal::ClearFileIndex( void ) {
+	std::lock_guard<std::recursive_mutex> lock( fileIndexMutex );
+
+	fileIndex.Clear();
+	fileIndexHash.Free();
+	fileIndexDirs.Clear();
+	fileIndexDirOrder.Clear();
+	fileIndexOrder = 0;
+}
+
+/*
+===========
+idFileSystemLocal::BuildFileIndex
+
+Maps every file in the paks on the search path to the first pak holding it, so that
+a lookup is a single hash probe instead of a walk over all search paths.
+Loose directories are not scanned, the directory hit or miss of each looked up file
+is cached instead until a file is written or the dir cache is cleared.
+===========
+*/
+void idFileSystemLocal::BuildFileIndex( void ) {
+	std::lock_guard<std::recursive_mutex> lock( fileIndexMutex );
+
+	ClearFileIndex();
+
+	int numPakFiles = 0;
+	for ( searchpath_t *search = searchPaths; search; search = search->next ) {
+		if ( search->pack ) {
+			numPakFiles += search->pack->numfiles;
+		}
+	}
+
+	fileIndex.SetGranularity( 4096 );
+	fileIndex.Resize( numPakFiles );
+	fileIndexHash.Clear( 65536, Max( numPakFiles, 1024 ) );
+
+	int order = 0;
+	for ( searchpath_t *search = searchPaths; search; search = search->next, order++ ) {
+		if ( search->dir ) {
+			fileIndexDirs.Append( search->dir );
+			fileIndexDirOrder.Append( order );
+		} else if ( search->pack ) {
+			AddPakToFileIndex( search->pack, order );
+		}
+	}
+
+	// order 0 is reserved for "no index"
+	fileIndexOrder = order + 1;
+
+	common->Printf( "%d files in file index\n", fileIndex.Num() );
+}
+
+/*
+===========
+idFileSystemLocal::AddPakToFileIndex
+
+Paks must be added in search order, files already found in an earlier pak are left alone
+===========
+*/
+void idFileSystemLocal::AddPakToFileIndex( pack_t *pak, int order ) {
+	std::lock_guard<std::recursive_mutex> lock( fileIndexMutex );
+
+	for ( int i = 0; i < pak->numfiles; i++ ) {
+		fileInPack_t *pakFile = &pak->buildBuffer[i];
+		fileIndexEntry_t *entry = FindFileIndexEntry( pakFile->name );
+
+		if ( !entry ) {
+			entry = &fileIndex.Alloc();
+			entry->name = pakFile->name;
+			entry->dir = NULL;
+			entry->dirGeneration = fileIndexGeneration - 1;
+			entry->pak = NULL;
+			fileIndexHash.Add( fileIndexHash.GenerateKey( entry->name.c_str() ), fileIndex.Num() - 1 );
+		}
+
+		if ( !entry->pak ) {
+			entry->pak = pak;
+			entry->pakFile = pakFile;
+			entry->pakOrder = order;
+		}
+	}
+}
+
+/*
+===========
+idFileSystemLocal::FindFileIndexEntry
+
+<name> must already be lowercase with forward slashes
+===========
+*/
+fileIndexEntry_t *idFileSystemLocal::FindFileIndexEntry( const char *name ) {
+	const int key = fileIndexHash.GenerateKey( name );
+
+	for ( int i = fileIndexHash.First( key ); i != -1; i = fileIndexHash.Next( i ) ) {
+		if ( fileIndex[i].name.Cmp( name ) == 0 ) {
+			return &fileIndex[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+===========
+idFileSystemLocal::OpenFileReadFromIndex
+
+Resolves a file through the global index. The pak holding a file is known from the index,
+only the directories in front of it on the search path need to be probed. The result of
+that probe is cached per file, so misses don't go to the OS again.
+Lookups change the index, it is only touched under fileIndexMutex. Held fileIndexEntry_t
+pointers become invalid as soon as it is released, a miss may grow the list.
+===========
+*/
+idFile *idFileSystemLocal::OpenFileReadFromIndex( const char *relativePath, int searchFlags, pack_t **foundInPak ) {
+	char name[MAX_OSPATH];
+	int i;
+
+	for ( i = 0; relativePath[i] && i < MAX_OSPATH - 1; i++ ) {
+		char c = idStr::ToLower( relativePath[i] );
+		name[i] = ( c == '\\' ) ? '/' : c;
+	}
+	name[i] = '\0';
+
+	pack_t *pak;
+	fileInPack_t *pakFile;
+	{
+		std::lock_guard<std::recursive_mutex> lock( fileIndexMutex );
+
+		fileIndexLookups++;
+
+		fileIndexEntry_t *entry = FindFileIndexEntry( name );
+		if ( !entry ) {
+			// not in any pak, remember the lookup for the directory check below
+			entry = &fileIndex.Alloc();
+			entry->name = name;
+			entry->pak = NULL;
+			entry->pakFile = NULL;
+			entry->pakOrder = INT_MAX;
+			entry->dir = NULL;
+			entry->dirGeneration = fileIndexGeneration - 1;
+			fileIndexHash.Add( fileIndexHash.GenerateKey( name ), fileIndex.Num() - 1 );
+		}
+
+		if ( searchFlags & FSFLAG_SEARCH_DIRS ) {
+			if ( entry->dirGeneration == fileIndexGeneration ) {
+				if ( entry->dir ) {
+					idFile *file = OpenFileInDir( entry->dir, relativePath );
+					if ( file ) {
+						return file;
 					}
+					// removed behind our back, probe the directories again
+					entry->dirGeneration = fileIndexGeneration - 1;
+				}
+			}
 
-					if ( fs_debug.GetInteger( ) ) {
-						common->Printf( "idFileSystem::OpenFileRead: %s (found in '%s')\n", relativePath, pak->pakFilename.c_str() );
+			if ( entry->dirGeneration != fileIndexGeneration ) {
+				const int generation = fileIndexGeneration;
+
+				entry->dir = NULL;
+				for ( i = 0; i < fileIndexDirs.Num() && fileIndexDirOrder[i] < entry->pakOrder; i++ ) {
+					idFile *file = OpenFileInDir( fileIndexDirs[i], relativePath );
+					if ( file ) {
+						entry->dir = fileIndexDirs[i];
+						entry->dirGeneration = generation;
+						return file;
 					}
-					return file;
 				}
+				entry->dirGeneration = generation;
 			}
 		}
+
+		if ( !entry->pak ) {
+			fileIndexMisses++;
+			return NULL;
+		}
+		pak = entry->pak;
+		pakFile = entry->pakFile;
 	}
 
-	if ( searchFlags & FSFLAG_SEARCH_ADDONS ) {
-		search = addonPaks;
-		while ( search && search->pack ) {
-			pak = search->pack;
-			for ( pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
-				if ( !FilenameCompare( pakFile->name, relativePath ) ) {
-					idFile_InZip *file = ReadFileFromZip( pak, pakFile, relativePath );
-					if ( foundInPak ) {
-						*foundInPak = pak;
+	// the pak entries stay valid until the search paths are shut down
+	return OpenFileInPak( pak, pakFile, relativePath, foundInPak );
+}
+
+/*
+================
+idFileSystemLocal::BenchmarkPaks_f
+
+Reads every file of the paks on the search path once through minizip and once through
+the mapping, alternating the order so that neither path profits from a warmer cache.
+================
+*/
+void idFileSystemLocal::BenchmarkPaks_f( const idCmdArgs &args ) {
+	const int maxFiles = args.Argc() > 1 ? atoi( args.Argv( 1 ) ) : 0;
+
+	idTimer zipTimer, mappedTimer;
+	zipTimer.Clear();
+	mappedTimer.Clear();
+
+	int numFiles = 0, numStored = 0, numFallback = 0;
+	uint64 numBytes = 0;
+	idList<byte> buffer;
+
+	for ( searchpath_t *search = fileSystemLocal.searchPaths; search; search = search->next ) {
+		pack_t *pak = search->pack;
+		if ( !pak ) {
+			continue;
+		}
+		if ( !pak->mapping ) {
+			common->Printf( "%s is not mapped, skipped\n", pak->pakFilename.c_str() );
+			continue;
+		}
+
+		for ( int i = 0; i < pak->numfiles && ( maxFiles <= 0 || numFiles < maxFiles ); i++ ) {
+			fileInPack_t *pakFile = &pak->buildBuffer[i];
+
+			for ( int pass = 0; pass < 2; pass++ ) {
+				const bool mapped = ( ( i + pass ) & 1 ) != 0;
+				idTimer &timer = mapped ? mappedTimer : zipTimer;
+
+				timer.Start();
+				idFile *file;
+				if ( mapped ) {
+					file = fileSystemLocal.ReadFileFromMappedZip( pak, pakFile, pakFile->name );
+					if ( !file ) {
+						numFallback++;
+						file = fileSystemLocal.ReadFileFromZip( pak, pakFile, pakFile->name );
 					}
-#ifdef _DEBUG
-					if ( fs_debug.GetInteger( ) ) {
-						common->Printf( "idFileSystem::OpenFileRead: %s (found in addon pk4 '%s')\n", relativePath, search->pack->pakFilename.c_str() );
+				} else {
+					file = fileSystemLocal.ReadFileFromZip( pak, pakFile, pakFile->name );
+				}
+				const int len = file->Length();
+				buffer.SetNum( len + 1, false );
+				file->Read( buffer.Ptr(), len );
+				if ( mapped ) {
+					numBytes += len;
+					if ( !file->IsCompressed() ) {
+						numStored++;
 					}
-#endif
-					return file;
 				}
+				delete file;
+				timer.Stop();
 			}
-			search = search->next;
+			numFiles++;
 		}
 	}
-	
-	if ( fs_debug.GetInteger( ) ) {
-		common->Printf( "Can't find %s\n", relativePath );
+
+	common->Printf( "%d files, %d stored, %d not mappable, %.2f MB\n", numFiles, numStored, numFallback, numBytes / ( 1024.0 * 1024.0 ) );
+	common->Printf( "minizip: %.1f ms\n", zipTimer.Milliseconds() );
+	common->Printf( "mapped:  %.1f ms\n", mappedTimer.Milliseconds() );
+}
+
+/*
+================
+idFileSystemLocal::FileIndexStats_f
+================
+*/
+void idFileSystemLocal::FileIndexStats_f( const idCmdArgs &args ) {
+	std::lock_guard<std::recursive_mutex> lock( fileSystemLocal.fileIndexMutex );
+
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "reset" ) ) {
+		fileSystemLocal.fileIndexLookups = 0;
+		fileSystemLocal.fileIndexMisses = 0;
+		fileSystemLocal.osCallCount = 0;
+		return;
 	}
-	
-	return NULL;
+
+	int numPakFiles = 0;
+	for ( int i = 0; i < fileSystemLocal.fileIndex.Num(); i++ ) {
+		if ( fileSystemLocal.fileIndex[i].pak ) {
+			numPakFiles++;
+		}
+	}
+
+	common->Printf( "%d index entries (%d in paks, %d cached lookups), %d directories\n",
+		fileSystemLocal.fileIndex.Num(), numPakFiles, fileSystemLocal.fileIndex.Num() - numPakFiles, fileSystemLocal.fileIndexDirs.Num() );
+	common->Printf( "%d lookups, %d answered as missing, %d OS calls\n",
+		fileSystemLocal.fileIndexLookups, fileSystemLocal.fileIndexMisses, fileSystemLocal.osCallCount );
 }
 
 /*
@@ -3115,13 +3717,16 @@ THREAD_RETURN_TYPE BackgroundDownloadThread(void *parms) {
 		bgl->next = NULL;
 
 		if ( bgl->opcode == DLTYPE_FILE ) {
-			// use the low level read function, because fread may allocate memory
-#ifdef WIN32
-			fread(bgl->file.buffer, bgl->file.length, 1, static_cast<idFile_Permanent*>(bgl->f)->GetFilePtr());
-			//_read( static_cast<idFile_Permanent*>(bgl->f)->GetFilePtr()->_file, bgl->file.buffer, bgl->file.length );
-#else
-			fread( bgl->file.buffer, bgl->file.length, 1, static_cast<idFile_Permanent*>(bgl->f)->GetFilePtr() );
-#endif
+			// the file handle belongs to this download, so it can be used from here until it completes
+			bgl->f->Seek( bgl->file.position, FS_SEEK_SET );
+			idFile_Permanent *permanent = dynamic_cast<idFile_Permanent *>( bgl->f );
+			if ( permanent ) {
+				// use the low level read function, because fread may allocate memory
+				fread( bgl->file.buffer, bgl->file.length, 1, permanent->GetFilePtr() );
+			} else {
+				// entries in pk4s, seeking in a compressed entry decompresses up to the position
+				bgl->f->Read( bgl->file.buffer, bgl->file.length );
+			}
 			bgl->completed = true;
 		} else {
 #if ID_ENABLE_CURL
@@ -3239,18 +3844,13 @@ idFileSystemLocal::BackgroundDownload
 */
 void idFileSystemLocal::BackgroundDownload( backgroundDownload_t *bgl ) {
 	if ( bgl->opcode == DLTYPE_FILE ) {
-		if ( dynamic_cast<idFile_Permanent *>(bgl->f) ) {
-			// add the bgl to the background download list
+		if ( bgl->f ) {
+			// add the bgl to the background download list, zipped files are read there as well
 			Sys_EnterCriticalSection();
 			bgl->next = backgroundDownloads;
 			backgroundDownloads = bgl;
 			Sys_TriggerEvent();
 			Sys_LeaveCriticalSection();
-		} else if ( bgl->f ) {
-			// read zipped file directly
-			bgl->f->Seek( bgl->file.position, FS_SEEK_SET );
-			bgl->f->Read( bgl->file.buffer, bgl->file.length );
-			bgl->completed = true;
 		}
 	} else {
 		Sys_EnterCriticalSection();
@@ -3475,6 +4075,10 @@ idFileSystemLocal::ClearDirCache
 ================
 */
 void idFileSystemLocal::ClearDirCache( void ) {
+	std::lock_guard<std::recursive_mutex> lock( fileIndexMutex );
+
+	// loose files might have changed
+	fileIndexGeneration++;
 
 	dir_cache_index = 0;
 	dir_cache_count = 0;
@@ -176,6 +176,12 @@ public:
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
 							// Frees the memory allocated by ReadFile.
 	virtual void			FreeFile( void *buffer ) = 0;
+							// Reads a complete file for binary parsing, without the trailing 0 byte.
+							// Files stored uncompressed in a memory mapped pak are returned as a view into
+							// the mapping instead of a copy, so the buffer is strictly read-only and has
+							// to be released with FreeFileView before the file system is restarted.
+	virtual int				ReadFileView( const char *relativePath, const void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
+	virtual void			FreeFileView( const void *buffer ) = 0;
 							// Writes a complete file, will create any needed subdirectories.
 							// Returns the length of the file, or -1 on failure. 
 							// greebo: By default use the mod save path to write stuff
@@ -204,11 +210,15 @@ public:
 	virtual int				GetReadCount( void ) = 0;
 							// adds to the read count
 	virtual void			AddToReadCount( int c ) = 0;
+							// number of stat, fopen and directory listing calls made so far
+	virtual int				GetOSCallCount( void ) = 0;
 							// look for a dynamic module
 	virtual void			FindDLL( const char *basename, char dllPath[ MAX_OSPATH ], bool updateChecksum ) = 0;
 							// case sensitive filesystems use an internal directory cache
 							// the cache is cleared when calling OpenFileWrite and RemoveFile
 							// in some cases you may need to use this directly
+							// also forgets which loose directories the file index found files in,
+							// call it before reloading so that files added in the meantime are found
 	virtual void			ClearDirCache( void ) = 0;
 
 							// don't use for large copies - allocates a single memory block for the copy
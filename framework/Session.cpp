@@ -1535,6 +1535,10 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 	
 	int start = Sys_Milliseconds();
 
+	// pick up loose files that were added since the last map
+	fileSystem->ClearDirCache();
+	const int startOSCalls = fileSystem->GetOSCallCount();
+
 	common->Printf( "--------- Map Initialization ---------\n" );
 	common->Printf( "Map: %s\n", mapString.c_str() );
 
@@ -1623,6 +1627,7 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 
 	int	msec = Sys_Milliseconds() - start;
 	common->Printf( "%6d msec to load %s\n", msec, mapString.c_str() );
+	common->Printf( "%6d file system OS calls\n", fileSystem->GetOSCallCount() - startOSCalls );
 
 	// let the renderSystem generate interactions now that everything is spawned
 	rw->GenerateAllInteractions();
@@ -263,6 +263,8 @@ void idGameLocal::Clear( void )
 	m_Timer.Clear();
 	m_StimEntity.Clear();
 	m_RespEntity.Clear();
+	m_ResponseGrid.Clear();
+	m_AIThinkScheduler.Clear();
 
 	m_sndPropLoader = &g_SoundPropLoader;
 	m_sndProp = &g_SoundProp;
@@ -2355,6 +2357,12 @@ bool idGameLocal::InitFromSaveGame( const char *mapName, idRenderWorld *renderWo
 		m_RespEntity[i].Restore(&savegame);
 	}
 
+	// The grid is rebuilt from m_RespEntity once all entities are restored
+	m_ResponseGrid.Invalidate();
+
+	// The think frames of the AI are restored, the planned load of the frames isn't
+	m_AIThinkScheduler.Clear();
+
 	m_EscapePointManager->Restore(&savegame);
 
 	m_searchManager->Restore(&savegame); // grayman #3857
@@ -3373,6 +3381,8 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 			timer_think.Clear();
 			timer_think.Start();
 
+			m_AIThinkScheduler.BeginFrame(framenum);
+
 			// let entities think
 			if ( g_timeentities.GetFloat() ) {
 				num = 0;
@@ -3435,6 +3445,8 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 				numEntitiesToDeactivate = 0;
 			}
 
+			m_AIThinkScheduler.EndFrame();
+
 			timer_think.Stop();
 		
 			//DM_LOG(LC_ENTITY, LT_INFO)LOGSTRING("Thinking timer: %lfms\r", timer_think.Milliseconds());
@@ -7241,6 +7253,7 @@ bool idGameLocal::AddResponse(idEntity *e)
 		idEntityPtr<idEntity> entPtr;
 		entPtr = e;
 		m_RespEntity.Append(entPtr);
+		m_ResponseGrid.Add(e);
 	}
 
 	return rc;
@@ -7254,6 +7267,7 @@ void idGameLocal::RemoveResponse(idEntity *e)
 	if (i != -1)
 	{
 		m_RespEntity.RemoveIndex(i);
+		m_ResponseGrid.Remove(e);
 	}
 }
 
@@ -7753,6 +7767,16 @@ void idGameLocal::ProcessStimResponse(unsigned int ticks)
 	int n;
 	idBounds bounds;
 
+	// The stats cover the relinks and the queries of this frame
+	m_ResponseGrid.ClearStats();
+
+	bool useResponseGrid = cv_sr_broadphase.GetBool();
+	if (useResponseGrid)
+	{
+		// Relink the responders which moved since the last frame
+		m_ResponseGrid.Update(m_RespEntity);
+	}
+
 	// Now check the rest of the stims.
 	for (int i = 0; i < m_StimEntity.Num(); i++)
 	{
@@ -7873,6 +7897,11 @@ void idGameLocal::ProcessStimResponse(unsigned int ticks)
 					stim->m_bCollisionFired = false;
 					stim->m_CollisionEnts.Clear();
 				}
+				else if (useResponseGrid)
+				{
+					// Radius based stims, only the responders in the cells touched by the bounds are tested
+					n = m_ResponseGrid.EntitiesTouchingBounds(bounds, srEntities, MAX_GENTITIES);
+				}
 				else 
 				{
 					// Radius based stims
@@ -7903,6 +7932,15 @@ void idGameLocal::ProcessStimResponse(unsigned int ticks)
 
 	srTimer.Stop();
 	DM_LOG(LC_STIM_RESPONSE, LT_INFO)LOGSTRING("Processing S/R took %lf\r", srTimer.Milliseconds());
+
+	if (cv_sr_stats.GetBool())
+	{
+		gameLocal.Printf("S/R: %i stim entities, %i response entities, %.3f ms\n", m_StimEntity.Num(), m_RespEntity.Num(), srTimer.Milliseconds());
+		if (useResponseGrid)
+		{
+			m_ResponseGrid.PrintStats();
+		}
+	}
 }
 
 /*
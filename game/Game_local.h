@@ -454,6 +454,8 @@ struct SuspiciousEvent
 };
 
 #include "SearchManager.h" // grayman #3857 - must follow the definition of "EventType"
+#include "StimResponse/ResponseGrid.h" // must follow the definition of idEntityPtr
+#include "ai/AIThinkScheduler.h"
 
 class idDeclEntityDef;
 
@@ -655,6 +657,9 @@ public:
 	idList<CStim *>			m_StimTimer;			// All stims that have a timer associated. 
 	idList< idEntityPtr<idEntity> >		m_StimEntity;			// all entities that currently have a stim regardless of it's state
 	idList< idEntityPtr<idEntity> >		m_RespEntity;			// all entities that currently have a response regardless of it's state
+	CResponseGrid			m_ResponseGrid;			// broadphase over m_RespEntity, used to find the responders in reach of a stim
+
+	CAIThinkScheduler		m_AIThinkScheduler;		// spreads the interleaved AI thinks over the frames and enforces the AI think budget
 
 	int						cinematicSkipTime;		// don't allow skipping cinemetics until this time has passed so player doesn't skip out accidently from a firefight
 	int						cinematicStopTime;		// cinematics have several camera changes, so keep track of when we stop them so that we don't reset cinematicSkipTime unnecessarily
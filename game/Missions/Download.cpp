@@ -152,7 +152,8 @@ void CDownload::Perform()
 				}
 			}
 
-			// Make sure the destination file is overwritten
+			// Make sure the destination file is overwritten. It is removed rather than
+			// rewritten in place because the file system keeps the loaded pk4s memory mapped.
 			if (fs::exists(_destFilename.c_str()))
 			{
 				CMissionManager::DoRemoveFile(_destFilename.c_str());
@@ -0,0 +1,480 @@
+/*****************************************************************************
+                    The Dark Mod GPL Source Code
+ 
+ This file is part of the The Dark Mod Source Code, originally based 
+ on the Doom 3 GPL Source Code as published in 2011.
+ 
+ The Dark Mod Source Code is free software: you can redistribute it 
+ and/or modify it under the terms of the GNU General Public License as 
+ published by the Free Software Foundation, either version 3 of the License, 
+ or (at your option) any later version. For details, see LICENSE.TXT.
+ 
+ Project: The Dark Mod (http://www.thedarkmod.com/)
+ 
+******************************************************************************/
+#include "precompiled.h"
+#pragma hdrstop
+
+
+
+#include "ResponseGrid.h"
+
+/********************************************************************/
+/*                 CResponseGrid                                    */
+/********************************************************************/
+CResponseGrid::CResponseGrid() :
+	m_QueryCount(0),
+	m_Invalid(false)
+{
+	m_Responders.SetGranularity(256);
+	m_Cells.SetGranularity(256);
+	m_CellHash.Clear(1024, 1024);
+	ClearStats();
+}
+
+CResponseGrid::~CResponseGrid()
+{
+	Clear();
+}
+
+void CResponseGrid::Clear()
+{
+	m_Cells.DeleteContents(true);
+	m_CellHash.Free();
+	m_Responders.Clear();
+	m_FreeResponders.Clear();
+	m_Oversized.Clear();
+	m_Moved.Clear();
+	m_EntityResponder.Clear();
+	m_QueryCount = 0;
+	m_Invalid = false;
+}
+
+void CResponseGrid::Invalidate()
+{
+	Clear();
+	m_Invalid = true;
+}
+
+int CResponseGrid::CellHashKey(int x, int y, int z)
+{
+	return ( x * 73856093 ) ^ ( y * 19349663 ) ^ ( z * 83492791 );
+}
+
+void CResponseGrid::CellRangeForBounds(const idBounds& bounds, int cellBounds[2][3])
+{
+	for (int i = 0; i < 3; i++)
+	{
+		cellBounds[0][i] = static_cast<int>(idMath::Floor(bounds[0][i] / SR_GRID_CELL_SIZE));
+		cellBounds[1][i] = static_cast<int>(idMath::Floor(bounds[1][i] / SR_GRID_CELL_SIZE));
+	}
+}
+
+bool CResponseGrid::CalcEntityCellBounds(idEntity* ent, int cellBounds[2][3]) const
+{
+	idPhysics* physics = ent->GetPhysics();
+
+	idBounds bounds;
+	bounds.Clear();
+
+	// Only linked clip models can be found by the clip sectors either
+	int numClipModels = physics->GetNumClipModels();
+	for (int i = 0; i < numClipModels; i++)
+	{
+		idClipModel* clipModel = physics->GetClipModel(i);
+
+		if (clipModel != NULL && clipModel->IsLinked())
+		{
+			bounds.AddBounds(clipModel->GetAbsBounds());
+		}
+	}
+
+	if (bounds.IsCleared())
+	{
+		cellBounds[0][0] = cellBounds[0][1] = cellBounds[0][2] = 0;
+		cellBounds[1][0] = cellBounds[1][1] = cellBounds[1][2] = -1;
+		return false;
+	}
+
+	CellRangeForBounds(bounds, cellBounds);
+	return true;
+}
+
+CResponseGrid::Cell* CResponseGrid::FindCell(int x, int y, int z) const
+{
+	int key = CellHashKey(x, y, z);
+
+	for (int i = m_CellHash.First(key); i != -1; i = m_CellHash.Next(i))
+	{
+		Cell* cell = m_Cells[i];
+
+		if (cell->coords[0] == x && cell->coords[1] == y && cell->coords[2] == z)
+		{
+			return cell;
+		}
+	}
+
+	return NULL;
+}
+
+CResponseGrid::Cell* CResponseGrid::FindOrCreateCell(int x, int y, int z)
+{
+	Cell* cell = FindCell(x, y, z);
+
+	if (cell == NULL)
+	{
+		cell = new Cell;
+		cell->coords[0] = x;
+		cell->coords[1] = y;
+		cell->coords[2] = z;
+
+		m_CellHash.Add(CellHashKey(x, y, z), m_Cells.Append(cell));
+	}
+
+	return cell;
+}
+
+void CResponseGrid::Link(int index)
+{
+	Responder& responder = m_Responders[index];
+
+	if (responder.cellBounds[0][0] > responder.cellBounds[1][0])
+	{
+		return; // no linked clip models
+	}
+
+	int numCells = 1;
+	for (int i = 0; i < 3; i++)
+	{
+		numCells *= responder.cellBounds[1][i] - responder.cellBounds[0][i] + 1;
+	}
+
+	if (numCells > SR_GRID_MAX_ENTITY_CELLS)
+	{
+		// Large triggers and such would clutter lots of cells, keep them separate
+		responder.oversized = true;
+		m_Oversized.Append(index);
+		return;
+	}
+
+	for (int x = responder.cellBounds[0][0]; x <= responder.cellBounds[1][0]; x++)
+	{
+		for (int y = responder.cellBounds[0][1]; y <= responder.cellBounds[1][1]; y++)
+		{
+			for (int z = responder.cellBounds[0][2]; z <= responder.cellBounds[1][2]; z++)
+			{
+				FindOrCreateCell(x, y, z)->responders.Append(index);
+			}
+		}
+	}
+}
+
+void CResponseGrid::Unlink(int index)
+{
+	Responder& responder = m_Responders[index];
+
+	if (responder.oversized)
+	{
+		m_Oversized.Remove(index);
+		responder.oversized = false;
+		return;
+	}
+
+	for (int x = responder.cellBounds[0][0]; x <= responder.cellBounds[1][0]; x++)
+	{
+		for (int y = responder.cellBounds[0][1]; y <= responder.cellBounds[1][1]; y++)
+		{
+			for (int z = responder.cellBounds[0][2]; z <= responder.cellBounds[1][2]; z++)
+			{
+				Cell* cell = FindCell(x, y, z);
+
+				if (cell != NULL)
+				{
+					cell->responders.Remove(index);
+				}
+			}
+		}
+	}
+}
+
+void CResponseGrid::Relink(int index)
+{
+	Responder& responder = m_Responders[index];
+
+	int cellBounds[2][3];
+	CalcEntityCellBounds(responder.entity, cellBounds);
+
+	if (memcmp(cellBounds, responder.cellBounds, sizeof(cellBounds)) == 0)
+	{
+		return; // still covering the same cells
+	}
+
+	Unlink(index);
+	memcpy(responder.cellBounds, cellBounds, sizeof(cellBounds));
+	Link(index);
+
+	m_NumRelinks++;
+}
+
+void CResponseGrid::Add(idEntity* ent)
+{
+	if (ent == NULL)
+	{
+		return;
+	}
+
+	int entityNum = ent->entityNumber;
+
+	if (entityNum >= m_EntityResponder.Num())
+	{
+		int oldNum = m_EntityResponder.Num();
+		m_EntityResponder.SetNum(entityNum + 1);
+
+		for (int i = oldNum; i < m_EntityResponder.Num(); i++)
+		{
+			m_EntityResponder[i] = -1;
+		}
+	}
+
+	if (m_EntityResponder[entityNum] != -1)
+	{
+		return; // already registered
+	}
+
+	int index;
+	if (m_FreeResponders.Num() > 0)
+	{
+		index = m_FreeResponders[m_FreeResponders.Num() - 1];
+		m_FreeResponders.RemoveIndex(m_FreeResponders.Num() - 1);
+	}
+	else
+	{
+		index = m_Responders.Append(Responder());
+	}
+
+	Responder& responder = m_Responders[index];
+	responder.entity = ent;
+	responder.oversized = false;
+	responder.queryCount = m_QueryCount;
+	responder.moved = false;
+	CalcEntityCellBounds(ent, responder.cellBounds);
+
+	m_EntityResponder[entityNum] = index;
+
+	Link(index);
+}
+
+void CResponseGrid::Remove(idEntity* ent)
+{
+	if (ent == NULL || ent->entityNumber >= m_EntityResponder.Num())
+	{
+		return;
+	}
+
+	int index = m_EntityResponder[ent->entityNumber];
+
+	if (index == -1 || m_Responders[index].entity != ent)
+	{
+		return;
+	}
+
+	Unlink(index);
+
+	m_Responders[index].entity = NULL;
+	m_EntityResponder[ent->entityNumber] = -1;
+	m_FreeResponders.Append(index);
+}
+
+void CResponseGrid::EntityMoved(idEntity* ent)
+{
+	if (ent == NULL || ent->entityNumber >= m_EntityResponder.Num())
+	{
+		return;
+	}
+
+	int index = m_EntityResponder[ent->entityNumber];
+
+	if (index == -1 || m_Responders[index].moved)
+	{
+		return;
+	}
+
+	m_Responders[index].moved = true;
+	m_Moved.Append(index);
+}
+
+void CResponseGrid::Update(const idList< idEntityPtr<idEntity> >& responders)
+{
+	if (m_Invalid)
+	{
+		m_Invalid = false;
+
+		for (int i = 0; i < responders.Num(); i++)
+		{
+			Add(responders[i].GetEntity());
+		}
+
+		return;
+	}
+
+	for (int i = 0; i < m_Moved.Num(); i++)
+	{
+		Responder& responder = m_Responders[m_Moved[i]];
+		responder.moved = false;
+
+		// the responder may have been removed since
+		if (responder.entity != NULL)
+		{
+			Relink(m_Moved[i]);
+		}
+	}
+
+	m_Moved.SetNum(0, false);
+}
+
+bool CResponseGrid::TouchesBounds(idEntity* ent, const idBounds& bounds) const
+{
+	idPhysics* physics = ent->GetPhysics();
+
+	int numClipModels = physics->GetNumClipModels();
+	for (int i = 0; i < numClipModels; i++)
+	{
+		idClipModel* clipModel = physics->GetClipModel(i);
+
+		if (clipModel == NULL || !clipModel->IsLinked() || !clipModel->IsEnabled())
+		{
+			continue;
+		}
+
+		if (!(clipModel->GetContents() & CONTENTS_RESPONSE))
+		{
+			continue;
+		}
+
+		if (clipModel->GetAbsBounds().IntersectsBounds(bounds))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int CResponseGrid::EntitiesTouchingBounds(const idBounds& bounds, idEntity** entityList, int maxCount)
+{
+	m_QueryCount++;
+	m_NumQueries++;
+
+	int count = 0;
+
+	int cellBounds[2][3];
+	CellRangeForBounds(bounds, cellBounds);
+
+	int numQueryCells = 1;
+	for (int i = 0; i < 3; i++)
+	{
+		numQueryCells *= cellBounds[1][i] - cellBounds[0][i] + 1;
+	}
+
+	if (numQueryCells > SR_GRID_MAX_QUERY_CELLS)
+	{
+		// Huge stim, testing all responders is cheaper than walking the cells
+		for (int i = 0; i < m_Responders.Num() && count < maxCount; i++)
+		{
+			Responder& responder = m_Responders[i];
+
+			if (responder.entity == NULL)
+			{
+				continue;
+			}
+
+			responder.queryCount = m_QueryCount;
+			m_NumCandidates++;
+
+			if (TouchesBounds(responder.entity, bounds))
+			{
+				entityList[count++] = responder.entity;
+			}
+		}
+
+		m_NumResults += count;
+		return count;
+	}
+
+	for (int i = 0; i < m_Oversized.Num() && count < maxCount; i++)
+	{
+		Responder& responder = m_Responders[m_Oversized[i]];
+
+		responder.queryCount = m_QueryCount;
+		m_NumCandidates++;
+
+		if (TouchesBounds(responder.entity, bounds))
+		{
+			entityList[count++] = responder.entity;
+		}
+	}
+
+	for (int x = cellBounds[0][0]; x <= cellBounds[1][0]; x++)
+	{
+		for (int y = cellBounds[0][1]; y <= cellBounds[1][1]; y++)
+		{
+			for (int z = cellBounds[0][2]; z <= cellBounds[1][2]; z++)
+			{
+				const Cell* cell = FindCell(x, y, z);
+
+				if (cell == NULL)
+				{
+					continue;
+				}
+
+				m_NumCellsVisited++;
+
+				for (int i = 0; i < cell->responders.Num(); i++)
+				{
+					Responder& responder = m_Responders[cell->responders[i]];
+
+					if (responder.queryCount == m_QueryCount)
+					{
+						continue; // already tested via another cell
+					}
+
+					responder.queryCount = m_QueryCount;
+					m_NumCandidates++;
+
+					if (!TouchesBounds(responder.entity, bounds))
+					{
+						continue;
+					}
+
+					if (count >= maxCount)
+					{
+						gameLocal.Warning("CResponseGrid::EntitiesTouchingBounds: max count (%i) reached.", maxCount);
+						m_NumResults += count;
+						return count;
+					}
+
+					entityList[count++] = responder.entity;
+				}
+			}
+		}
+	}
+
+	m_NumResults += count;
+	return count;
+}
+
+void CResponseGrid::ClearStats()
+{
+	m_NumQueries = 0;
+	m_NumCellsVisited = 0;
+	m_NumCandidates = 0;
+	m_NumResults = 0;
+	m_NumRelinks = 0;
+}
+
+void CResponseGrid::PrintStats() const
+{
+	gameLocal.Printf("S/R grid: %i responders (%i oversized) in %i cells, %i relinked, %i queries, %i cells visited, %i candidates tested, %i found\n",
+		m_Responders.Num() - m_FreeResponders.Num(), m_Oversized.Num(), m_Cells.Num(),
+		m_NumRelinks, m_NumQueries, m_NumCellsVisited, m_NumCandidates, m_NumResults);
+}
@@ -0,0 +1,121 @@
+/*****************************************************************************
+                    The Dark Mod GPL Source Code
+ 
+ This file is part of the The Dark Mod Source Code, originally based 
+ on the Doom 3 GPL Source Code as published in 2011.
+ 
+ The Dark Mod Source Code is free software: you can redistribute it 
+ and/or modify it under the terms of the GNU General Public License as 
+ published by the Free Software Foundation, either version 3 of the License, 
+ or (at your option) any later version. For details, see LICENSE.TXT.
+ 
+ Project: The Dark Mod (http://www.thedarkmod.com/)
+ 
+******************************************************************************/
+#ifndef SR_RESPONSEGRID__H
+#define SR_RESPONSEGRID__H
+
+class idEntity;
+
+// Edge length of a broadphase cell in world units
+#define SR_GRID_CELL_SIZE			256.0f
+// Responders covering more cells than this are kept in a separate list that every query tests
+#define SR_GRID_MAX_ENTITY_CELLS	64
+// Queries covering more cells than this test all responders directly
+#define SR_GRID_MAX_QUERY_CELLS		512
+
+/**
+ * Uniform grid broadphase over all entities that currently carry a response.
+ *
+ * The world clip sectors contain every clip model in the map, so asking them for
+ * CONTENTS_RESPONSE entities walks lots of unrelated geometry for each stim.
+ * This grid only knows about the entities in idGameLocal::m_RespEntity and is kept
+ * up to date incrementally: idClipModel::Link/Unlink mark the responder of the entity,
+ * and Update() only looks at the marked ones, relinking those whose range of
+ * covered cells changed.
+ *
+ * Query results match idClip::EntitiesTouchingBounds with CONTENTS_RESPONSE,
+ * the final test is done against the linked and enabled clip models of the responder.
+ */
+class CResponseGrid
+{
+public:
+	CResponseGrid();
+	~CResponseGrid();
+
+	// Removes all responders and frees the cells
+	void			Clear();
+
+	// Drops all responders, they are added again from the given list on the next Update()
+	void			Invalidate();
+
+	// Registers/unregisters an entity with a response
+	void			Add(idEntity* ent);
+	void			Remove(idEntity* ent);
+
+	// Marks the responder of the entity for Update(), called when one of its clip models is (un)linked
+	void			EntityMoved(idEntity* ent);
+
+	// Relinks all responders which moved since the last call. <responders> is only used
+	// to rebuild the grid after Invalidate().
+	void			Update(const idList< idEntityPtr<idEntity> >& responders);
+
+	// Fills <entityList> with all responders touching the given bounds, returns the number of entities
+	int				EntitiesTouchingBounds(const idBounds& bounds, idEntity** entityList, int maxCount);
+
+	// Resets the per-frame statistics
+	void			ClearStats();
+	void			PrintStats() const;
+
+private:
+	struct Responder
+	{
+		idEntity*	entity;
+		int			cellBounds[2][3];	// inclusive cell range, mins > maxs if not in any cell
+		bool		oversized;			// stored in m_Oversized instead of the cells
+		int			queryCount;			// avoids duplicate results for entities spanning several cells
+		bool		moved;				// in m_Moved
+	};
+
+	struct Cell
+	{
+		int			coords[3];
+		idList<int>	responders;			// indices into m_Responders
+	};
+
+	static int		CellHashKey(int x, int y, int z);
+	static void		CellRangeForBounds(const idBounds& bounds, int cellBounds[2][3]);
+
+	bool			CalcEntityCellBounds(idEntity* ent, int cellBounds[2][3]) const;
+	Cell*			FindCell(int x, int y, int z) const;
+	Cell*			FindOrCreateCell(int x, int y, int z);
+
+	void			Link(int index);
+	void			Unlink(int index);
+	void			Relink(int index);
+
+	// Final check equivalent to the clip sector query
+	bool			TouchesBounds(idEntity* ent, const idBounds& bounds) const;
+
+	idList<Responder>	m_Responders;
+	idList<int>			m_FreeResponders;
+	idList<int>			m_Oversized;
+	idList<int>			m_Moved;			// responders marked by EntityMoved() since the last Update()
+	idList<Cell*>		m_Cells;
+	idHashIndex			m_CellHash;
+
+	// Maps entity numbers to indices into m_Responders, -1 if not registered
+	idList<int>			m_EntityResponder;
+
+	int					m_QueryCount;
+	bool				m_Invalid;
+
+	// Statistics, reset by ClearStats()
+	int					m_NumQueries;
+	int					m_NumCellsVisited;
+	int					m_NumCandidates;
+	int					m_NumResults;
+	int					m_NumRelinks;
+};
+
+#endif /* SR_RESPONSEGRID__H */
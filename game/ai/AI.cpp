@@ -615,6 +615,8 @@ idAI::idAI()
 	m_maxInterleaveThinkDist = 3000;
 	m_lastThinkTime = 0;
 	m_nextThinkFrame = 0;
+	m_thinkCost = 0;
+	m_thinkDeferrals = 0;
 
 	INIT_TIMER_HANDLE(aiThinkTimer);
 	INIT_TIMER_HANDLE(aiMindTimer);
@@ -2353,6 +2355,8 @@ void idAI::Think( void )
 
 	SetNextThinkFrame();
 
+	CAIThinkScheduler::ThinkTimer thinkCostTimer(m_thinkCost);
+
 	//PrintGoalData(move.moveDest, 10);
 	// grayman #2416 - don't let origin slip below the floor when getting up from lying down
 	if ( ( gameLocal.time <= m_getupEndTime ) &&
@@ -2712,25 +2716,25 @@ idAI::ThinkingIsAllowed
 */
 bool idAI::ThinkingIsAllowed()
 {
-	int frameNum = gameLocal.framenum;
-	if (frameNum < m_nextThinkFrame)
+	// Ragdolls think every frame to avoid physics weirdness, the think budget doesn't apply to them either.
+	if ( ( health <= 0 ) || IsKnockedOut() ) // grayman #2840 - you're also a ragdoll if you're KO'ed
 	{
-		// Ragdolls think every frame to avoid physics weirdness.
-		if ( ( health <= 0 ) || IsKnockedOut() ) // grayman #2840 - you're also a ragdoll if you're KO'ed
-		{
-			return true;
-		}
+		return true;
+	}
 
-		// angua: AI think every frame while sitting/laying down and getting up
-		// otherwise, the AI might end up in a different sleeping position
-		if (move.moveType == MOVETYPE_SIT_DOWN
-			|| move.moveType == MOVETYPE_FALL_ASLEEP // grayman #3820 - was MOVETYPE_LAY_DOWN
-			|| move.moveType == MOVETYPE_GET_UP
-			|| move.moveType == MOVETYPE_WAKE_UP) // grayman #3820 - was MOVETYPE_GET_UP_FROM_LYING
-		{
-			return true;
-		}
+	// angua: AI think every frame while sitting/laying down and getting up
+	// otherwise, the AI might end up in a different sleeping position
+	if (move.moveType == MOVETYPE_SIT_DOWN
+		|| move.moveType == MOVETYPE_FALL_ASLEEP // grayman #3820 - was MOVETYPE_LAY_DOWN
+		|| move.moveType == MOVETYPE_GET_UP
+		|| move.moveType == MOVETYPE_WAKE_UP) // grayman #3820 - was MOVETYPE_GET_UP_FROM_LYING
+	{
+		return true;
+	}
 
+	int frameNum = gameLocal.framenum;
+	if (frameNum < m_nextThinkFrame)
+	{
 		// skips PVS check, AI will also do interleaved thinking when in player view.
 		bool skipPVScheck = cv_ai_opt_interleavethinkskippvscheck.GetBool();
 		if (skipPVScheck)
@@ -2745,6 +2749,35 @@ bool idAI::ThinkingIsAllowed()
 			return false;
 		}
 	}
+	return ThinkBudgetAllows();
+}
+
+/*
+=====================
+idAI::ThinkBudgetAllows
+=====================
+*/
+bool idAI::ThinkBudgetAllows()
+{
+	// AI that were deferred long enough, are alerted or close to the player think in any case
+	bool priority = (m_thinkDeferrals >= cv_ai_think_maxdefer.GetInteger()) || (AI_AlertIndex >= ai::ESuspicious);
+
+	if (!priority)
+	{
+		idPlayer* player = gameLocal.GetLocalPlayer();
+		float priorityDist = cv_ai_think_prioritydist.GetFloat();
+
+		priority = (player == NULL) ||
+			(physicsObj.GetOrigin() - player->GetPhysics()->GetOrigin()).LengthSqr() < Square(priorityDist);
+	}
+
+	if (!gameLocal.m_AIThinkScheduler.AllowThink(m_thinkCost, priority))
+	{
+		m_thinkDeferrals++;
+		return false;
+	}
+
+	m_thinkDeferrals = 0;
 	return true;
 }
 
@@ -2822,7 +2855,8 @@ void idAI::SetNextThinkFrame()
 		}
 	}
 
-	m_nextThinkFrame = frameNum + thinkDelta;
+	// The scheduler may move the think up to a quarter of the interval later to even out the load
+	m_nextThinkFrame = gameLocal.m_AIThinkScheduler.ScheduleThink(frameNum, thinkDelta, m_thinkCost);
 }
 
 /*
@@ -1398,6 +1398,9 @@ public: // greebo: Made these public for now, I didn't want to write an accessor
 	// Sets the frame number when the AI should think next time
 	void					SetNextThinkFrame();
 
+	// Checks the per-frame AI think budget for an AI that is due to think
+	bool					ThinkBudgetAllows();
+
 	// returns interleave think frames
 	// the AI will only think once in this number of frames
 	int						GetThinkInterleave() const; // grayman 2414 - add 'const'
@@ -1413,6 +1416,12 @@ public: // greebo: Made these public for now, I didn't want to write an accessor
 	// the last time where the AI did its thinking (used for physics)
 	int						m_lastThinkTime;
 
+	// moving average of the time one think takes in msec, measured by CAIThinkScheduler::ThinkTimer
+	float					m_thinkCost;
+
+	// number of frames in a row this AI was deferred by the think budget
+	int						m_thinkDeferrals;
+
 	// grayman #2691 - this checks if a doorway is large enough to fit through when the door is fully open
 	bool					CanPassThroughDoor(CFrobDoor* frobDoor);
 
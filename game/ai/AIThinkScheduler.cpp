@@ -0,0 +1,232 @@
+/*****************************************************************************
+                    The Dark Mod GPL Source Code
+ 
+ This file is part of the The Dark Mod Source Code, originally based 
+ on the Doom 3 GPL Source Code as published in 2011.
+ 
+ The Dark Mod Source Code is free software: you can redistribute it 
+ and/or modify it under the terms of the GNU General Public License as 
+ published by the Free Software Foundation, either version 3 of the License, 
+ or (at your option) any later version. For details, see LICENSE.TXT.
+ 
+ Project: The Dark Mod (http://www.thedarkmod.com/)
+ 
+******************************************************************************/
+#include "precompiled.h"
+#pragma hdrstop
+
+
+
+#include "AIThinkScheduler.h"
+#include "AI.h"
+
+#define AI_THINK_SCHEDULE_MASK	( AI_THINK_SCHEDULE_FRAMES - 1 )
+
+// AI without a measured think yet still count a little, so that they spread out by number
+#define AI_THINK_MIN_COST		0.01f
+
+CAIThinkScheduler::CAIThinkScheduler()
+{
+	Clear();
+}
+
+void CAIThinkScheduler::Clear()
+{
+	memset(m_PlannedCost, 0, sizeof(m_PlannedCost));
+	m_FrameNum = -1;
+
+	memset(&m_Current, 0, sizeof(m_Current));
+	memset(m_History, 0, sizeof(m_History));
+	m_NextHistory = 0;
+	m_NumHistory = 0;
+}
+
+void CAIThinkScheduler::BeginFrame(int frameNum)
+{
+	if (m_FrameNum >= 0)
+	{
+		// The slots of the frames that passed are reused for the frames coming up
+		for (int frame = m_FrameNum; frame < frameNum && frame < m_FrameNum + AI_THINK_SCHEDULE_FRAMES; frame++)
+		{
+			m_PlannedCost[frame & AI_THINK_SCHEDULE_MASK] = 0;
+		}
+	}
+
+	m_FrameNum = frameNum;
+	memset(&m_Current, 0, sizeof(m_Current));
+}
+
+void CAIThinkScheduler::EndFrame()
+{
+	m_History[m_NextHistory] = m_Current;
+	m_NextHistory = (m_NextHistory + 1) % AI_THINK_HISTORY_FRAMES;
+
+	if (m_NumHistory < AI_THINK_HISTORY_FRAMES)
+	{
+		m_NumHistory++;
+	}
+}
+
+int CAIThinkScheduler::ScheduleThink(int frameNum, int thinkDelta, float cost)
+{
+	if (thinkDelta <= 1 || !cv_ai_think_scheduler.GetBool())
+	{
+		return frameNum + thinkDelta;
+	}
+
+	// Intervals beyond the planned frames are rare and kept as they are
+	if (thinkDelta >= AI_THINK_SCHEDULE_FRAMES)
+	{
+		return frameNum + thinkDelta;
+	}
+
+	// Look for the least loaded frame among the first quarter of an interval after the
+	// requested one, preferring the earlier frames. The AI never thinks more often than
+	// asked for, and at most a quarter of an interval later.
+	int best = frameNum + thinkDelta;
+	int last = Min(best + thinkDelta / 4, frameNum + AI_THINK_SCHEDULE_FRAMES - 1);
+	float bestCost = m_PlannedCost[best & AI_THINK_SCHEDULE_MASK];
+
+	for (int frame = best + 1; frame <= last; frame++)
+	{
+		float planned = m_PlannedCost[frame & AI_THINK_SCHEDULE_MASK];
+
+		if (planned < bestCost)
+		{
+			best = frame;
+			bestCost = planned;
+		}
+	}
+
+	m_PlannedCost[best & AI_THINK_SCHEDULE_MASK] += Max(cost, AI_THINK_MIN_COST);
+
+	return best;
+}
+
+bool CAIThinkScheduler::AllowThink(float cost, bool priority)
+{
+	float budget = cv_ai_think_budget.GetFloat();
+
+	// The first AI of a frame always gets to think, even if it alone exceeds the budget
+	if (priority || budget <= 0 || m_Current.numThinks == 0 || m_Current.msec + cost <= budget)
+	{
+		return true;
+	}
+
+	m_Current.numDeferred++;
+	return false;
+}
+
+void CAIThinkScheduler::AddThinkCost(float msec)
+{
+	m_Current.msec += msec;
+	m_Current.numThinks++;
+}
+
+static int CompareFloatAscending(const float* a, const float* b)
+{
+	return (*a < *b) ? -1 : ((*a > *b) ? 1 : 0);
+}
+
+static int CompareAIThinkCost(idAI* const* a, idAI* const* b)
+{
+	return CompareFloatAscending(&(*b)->m_thinkCost, &(*a)->m_thinkCost);
+}
+
+void CAIThinkScheduler::PrintReport() const
+{
+	if (m_NumHistory == 0)
+	{
+		gameLocal.Printf("No frames recorded yet.\n");
+		return;
+	}
+
+	static const float bucketLimits[] = { 0.5f, 1.0f, 2.0f, 4.0f, 8.0f };
+	static const int numBuckets = sizeof(bucketLimits) / sizeof(bucketLimits[0]) + 1;
+
+	int bucketCount[numBuckets] = { 0 };
+	float totalMsec = 0;
+	int totalThinks = 0;
+	int totalDeferred = 0;
+
+	idList<float> frameCost;
+	frameCost.SetNum(m_NumHistory);
+
+	for (int i = 0; i < m_NumHistory; i++)
+	{
+		const FrameStats& stats = m_History[i];
+
+		frameCost[i] = stats.msec;
+		totalMsec += stats.msec;
+		totalThinks += stats.numThinks;
+		totalDeferred += stats.numDeferred;
+
+		int bucket = 0;
+		while (bucket < numBuckets - 1 && stats.msec >= bucketLimits[bucket])
+		{
+			bucket++;
+		}
+		bucketCount[bucket]++;
+	}
+
+	frameCost.Sort(CompareFloatAscending);
+
+	gameLocal.Printf("AI think cost over the last %d frames (budget: %.2f ms, 0 = unlimited):\n", m_NumHistory, cv_ai_think_budget.GetFloat());
+	gameLocal.Printf("  average %.3f ms, median %.3f ms, 90%% %.3f ms, 99%% %.3f ms, max %.3f ms\n",
+		totalMsec / m_NumHistory,
+		frameCost[(m_NumHistory - 1) / 2],
+		frameCost[(m_NumHistory - 1) * 90 / 100],
+		frameCost[(m_NumHistory - 1) * 99 / 100],
+		frameCost[m_NumHistory - 1]);
+	gameLocal.Printf("  %.1f thinks per frame, %d thinks deferred\n", static_cast<float>(totalThinks) / m_NumHistory, totalDeferred);
+
+	for (int i = 0; i < numBuckets; i++)
+	{
+		float from = (i > 0) ? bucketLimits[i - 1] : 0.0f;
+		float percent = 100.0f * bucketCount[i] / m_NumHistory;
+
+		if (i < numBuckets - 1)
+		{
+			gameLocal.Printf("  %4.1f - %4.1f ms: %5d frames (%5.1f%%)\n", from, bucketLimits[i], bucketCount[i], percent);
+		}
+		else
+		{
+			gameLocal.Printf("  %4.1f ms and up: %5d frames (%5.1f%%)\n", from, bucketCount[i], percent);
+		}
+	}
+
+	// List the AI with the most expensive thinks
+	idList<idAI*> ais;
+	for (idEntity* ent = gameLocal.spawnedEntities.Next(); ent != NULL; ent = ent->spawnNode.Next())
+	{
+		if (ent->IsType(idAI::Type) && static_cast<idAI*>(ent)->m_thinkCost > 0)
+		{
+			ais.Append(static_cast<idAI*>(ent));
+		}
+	}
+
+	ais.Sort(CompareAIThinkCost);
+
+	for (int i = 0; i < ais.Num() && i < 5; i++)
+	{
+		gameLocal.Printf("  %-32s %.3f ms per think\n", ais[i]->name.c_str(), ais[i]->m_thinkCost);
+	}
+}
+
+CAIThinkScheduler::ThinkTimer::ThinkTimer(float& cost) :
+	m_Cost(cost)
+{
+	m_Timer.Start();
+}
+
+CAIThinkScheduler::ThinkTimer::~ThinkTimer()
+{
+	m_Timer.Stop();
+
+	float msec = static_cast<float>(m_Timer.Milliseconds());
+
+	// Moving average, a single expensive think (e.g. pathfinding) shouldn't dominate
+	m_Cost = (m_Cost > 0) ? m_Cost * 0.75f + msec * 0.25f : msec;
+
+	gameLocal.m_AIThinkScheduler.AddThinkCost(msec);
+}
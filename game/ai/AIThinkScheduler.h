@@ -0,0 +1,99 @@
+/*****************************************************************************
+                    The Dark Mod GPL Source Code
+ 
+ This file is part of the The Dark Mod Source Code, originally based 
+ on the Doom 3 GPL Source Code as published in 2011.
+ 
+ The Dark Mod Source Code is free software: you can redistribute it 
+ and/or modify it under the terms of the GNU General Public License as 
+ published by the Free Software Foundation, either version 3 of the License, 
+ or (at your option) any later version. For details, see LICENSE.TXT.
+ 
+ Project: The Dark Mod (http://www.thedarkmod.com/)
+ 
+******************************************************************************/
+#ifndef AI_THINKSCHEDULER__H
+#define AI_THINKSCHEDULER__H
+
+// Number of future frames the scheduler keeps the planned think cost for, power of two
+#define AI_THINK_SCHEDULE_FRAMES	64
+// Number of past frames kept for the cost report
+#define AI_THINK_HISTORY_FRAMES		1024
+
+/**
+ * Coordinates the interleaved thinking of all AI.
+ *
+ * Every AI still decides on its own how many frames it may skip (idAI::GetThinkInterleave),
+ * but instead of thinking again exactly that many frames later, the next think is put
+ * into the least loaded of the frames from that one up to a quarter of the interval later.
+ * The load of a frame is the sum of the measured think costs of the AI planned for it,
+ * so AI that started thinking on the same frame drift apart instead of spiking together
+ * forever. Intervals of AI_THINK_SCHEDULE_FRAMES and more are not spread.
+ *
+ * On top of that an optional per-frame budget (tdm_ai_think_budget) defers due AI to the
+ * next frame once the AI that already thought this frame used up the budget. AI close to
+ * the player or alerted, ragdolls and AI sitting down or getting up are never deferred,
+ * and no AI is deferred more than tdm_ai_think_maxdefer frames in a row.
+ */
+class CAIThinkScheduler
+{
+public:
+	CAIThinkScheduler();
+
+	// Forgets all planned thinks and the recorded history, called on map start
+	void			Clear();
+
+	// Called by idGameLocal around the entity think loop
+	void			BeginFrame(int frameNum);
+	void			EndFrame();
+
+	// Returns the frame the AI should think next, thinkDelta is the interleave it asked for
+	// and cost the estimated time of one think in msec
+	int				ScheduleThink(int frameNum, int thinkDelta, float cost);
+
+	// Returns false if a due AI with the given estimated cost should wait for the next frame
+	bool			AllowThink(float cost, bool priority);
+
+	// Adds the measured time of one AI think to the current frame
+	void			AddThinkCost(float msec);
+
+	// Prints the distribution of the per-frame AI think cost over the recorded frames
+	void			PrintReport() const;
+
+	/**
+	 * Measures an AI think from construction to destruction and feeds the result into
+	 * the moving average <cost> and the scheduler of gameLocal.
+	 */
+	class ThinkTimer
+	{
+	public:
+		ThinkTimer(float& cost);
+		~ThinkTimer();
+
+	private:
+		float&		m_Cost;
+		idTimer		m_Timer;
+	};
+
+private:
+	struct FrameStats
+	{
+		float		msec;			// measured think time of all AI
+		int			numThinks;
+		int			numDeferred;
+	};
+
+	// Estimated think cost of the AI planned for the next frames, indexed by frame number
+	float			m_PlannedCost[AI_THINK_SCHEDULE_FRAMES];
+	int				m_FrameNum;
+
+	// The frame being run
+	FrameStats		m_Current;
+
+	// Ring buffer of the last frames, m_NumHistory of them are valid
+	FrameStats		m_History[AI_THINK_HISTORY_FRAMES];
+	int				m_NextHistory;
+	int				m_NumHistory;
+};
+
+#endif /* AI_THINKSCHEDULER__H */
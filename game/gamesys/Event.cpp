@@ -226,10 +226,38 @@ void idEventDef::SortEventDefs() {
 
 ***********************************************************************/
 
+/*
+
+Scheduled events are kept in a hashed timer wheel with one slot per millisecond of game
+time.  Each slot holds the events due at times congruent to its index, sorted by time with
+events of equal time in the order they were posted, so inserting is constant time unless
+the slot also holds events a full wheel turn or more in the future.  serviceTime is the
+next game time the wheel will fire, events posted for an earlier time go to the sorted
+overdue list, which is always serviced first.  An object hash over the event pool makes
+cancelling the events of an object independent of the total number of events.
+
+*/
+
+#define EVENT_WHEEL_SIZE			4096		// must be a power of two
+#define EVENT_OBJECT_HASH_SIZE		4096
+
 static idLinkList<idEvent> FreeEvents;
-static idLinkList<idEvent> EventQueue;
+static idLinkList<idEvent> EventWheel[ EVENT_WHEEL_SIZE ];
+static idLinkList<idEvent> OverdueEvents;
+static idHashIndex EventObjectHash( EVENT_OBJECT_HASH_SIZE, MAX_EVENTS );
+static int numQueuedEvents;
+static int serviceTime;
 static idEvent EventPool[ MAX_EVENTS ];
 
+/*
+================
+EventObjectKey
+================
+*/
+static ID_INLINE int EventObjectKey( const idClass *obj ) {
+	return static_cast<int>( reinterpret_cast<size_t>( obj ) >> 4 );
+}
+
 bool idEvent::initialized = false;
 
 idDynamicBlockAlloc<byte, 16 * 1024, 256>	idEvent::eventDataAllocator;
@@ -373,6 +401,10 @@ idEvent::Free
 ================
 */
 void idEvent::Free( void ) {
+	if ( scheduled ) {
+		Unschedule();
+	}
+
 	if ( data ) {
 		eventDataAllocator.Free( data );
 		data = NULL;
@@ -393,48 +425,203 @@ idEvent::Schedule
 ================
 */
 void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
-	idEvent *event;
-
 	assert( initialized );
 	if ( !initialized ) {
 		return;
 	}
 
+	if ( scheduled ) {
+		Unschedule();
+	}
+
 	object = obj;
 	typeinfo = type;
 
 	// wraps after 24 days...like I care. ;)
 	this->time = gameLocal.time + time;
 
+	Enqueue();
+}
+
+/*
+================
+idEvent::Enqueue
+
+Links the event into the timer wheel, or the overdue list if it is due
+before the wheel position, behind any events with the same time.
+================
+*/
+void idEvent::Enqueue( void ) {
+	assert( !scheduled );
+
 	eventNode.Remove();
+	EventObjectHash.Add( EventObjectKey( object ), static_cast<int>( this - EventPool ) );
+	scheduled = true;
 
-	event = EventQueue.Next();
-	while( ( event != NULL ) && ( this->time >= event->time ) ) {
-		event = event->eventNode.Next();
+	// restart the wheel when the queue was empty, the game time may have jumped since it last ran
+	if ( numQueuedEvents++ == 0 ) {
+		serviceTime = Min( time, gameLocal.time );
 	}
 
-	if ( event ) {
-		eventNode.InsertBefore( event->eventNode );
+	idLinkList<idEvent> &list = ( time >= serviceTime ) ? EventWheel[ time & ( EVENT_WHEEL_SIZE - 1 ) ] : OverdueEvents;
+
+	idEvent *prev = list.Prev();
+	while( ( prev != NULL ) && ( prev->time > time ) ) {
+		prev = prev->eventNode.Prev();
+	}
+
+	if ( prev ) {
+		eventNode.InsertAfter( prev->eventNode );
 	} else {
-		eventNode.AddToEnd( EventQueue );
+		eventNode.AddToFront( list );
 	}
 }
 
+/*
+================
+idEvent::Unschedule
+================
+*/
+void idEvent::Unschedule( void ) {
+	assert( scheduled );
+
+	eventNode.Remove();
+	EventObjectHash.Remove( EventObjectKey( object ), static_cast<int>( this - EventPool ) );
+	scheduled = false;
+	numQueuedEvents--;
+}
+
+/*
+================
+idEvent::NextDueEvent
+
+Returns the event to fire next, or NULL if no event is due at the current game time.
+================
+*/
+idEvent *idEvent::NextDueEvent( void ) {
+	idEvent *event;
+
+	// all the events in the wheel are due after the overdue ones
+	event = OverdueEvents.Next();
+	if ( event != NULL ) {
+		return ( event->time <= gameLocal.time ) ? event : NULL;
+	}
+
+	while( ( numQueuedEvents > 0 ) && ( serviceTime <= gameLocal.time ) ) {
+		event = EventWheel[ serviceTime & ( EVENT_WHEEL_SIZE - 1 ) ].Next();
+		if ( ( event != NULL ) && ( event->time == serviceTime ) ) {
+			return event;
+		}
+		serviceTime++;
+	}
+
+	return NULL;
+}
+
+typedef struct {
+	idEvent *	event;
+	int			time;
+	int			order;
+} queuedEvent_t;
+
+/*
+================
+CompareQueuedEvents
+================
+*/
+static int CompareQueuedEvents( const queuedEvent_t *a, const queuedEvent_t *b ) {
+	if ( a->time != b->time ) {
+		return ( a->time < b->time ) ? -1 : 1;
+	}
+	return a->order - b->order;
+}
+
+/*
+================
+idEvent::GetQueuedEvents
+
+Returns all scheduled events in the order they will fire.
+================
+*/
+void idEvent::GetQueuedEvents( idList<idEvent *> &events ) {
+	idList<queuedEvent_t> queued;
+	idEvent *event;
+	int i;
+
+	queued.SetGranularity( 1024 );
+
+	// events of equal time are always in the same list, so the order
+	// they are gathered in keeps them in the order they were posted
+	for( event = OverdueEvents.Next(); event != NULL; event = event->eventNode.Next() ) {
+		queuedEvent_t &q = queued.Alloc();
+		q.event = event;
+		q.time = event->time;
+		q.order = queued.Num();
+	}
+	for( i = 0; i < EVENT_WHEEL_SIZE; i++ ) {
+		for( event = EventWheel[ i ].Next(); event != NULL; event = event->eventNode.Next() ) {
+			queuedEvent_t &q = queued.Alloc();
+			q.event = event;
+			q.time = event->time;
+			q.order = queued.Num();
+		}
+	}
+
+	queued.Sort( CompareQueuedEvents );
+
+	events.SetNum( queued.Num() );
+	for( i = 0; i < queued.Num(); i++ ) {
+		events[ i ] = queued[ i ].event;
+	}
+}
+
+/*
+================
+idEvent::CheckQueue
+
+Verifies that every list is sorted and the wheel holds no event due before serviceTime.
+================
+*/
+bool idEvent::CheckQueue( void ) {
+	idEvent *event;
+	int num = 0;
+	int i;
+
+	for( event = OverdueEvents.Next(); event != NULL; event = event->eventNode.Next(), num++ ) {
+		if ( event->time >= serviceTime || ( event->eventNode.Prev() && event->eventNode.Prev()->time > event->time ) ) {
+			return false;
+		}
+	}
+	for( i = 0; i < EVENT_WHEEL_SIZE; i++ ) {
+		for( event = EventWheel[ i ].Next(); event != NULL; event = event->eventNode.Next(), num++ ) {
+			if ( event->time < serviceTime || ( event->time & ( EVENT_WHEEL_SIZE - 1 ) ) != i ) {
+				return false;
+			}
+			if ( event->eventNode.Prev() && event->eventNode.Prev()->time > event->time ) {
+				return false;
+			}
+		}
+	}
+
+	return ( num == numQueuedEvents );
+}
+
 /*
 ================
 idEvent::CancelEvents
 ================
 */
 void idEvent::CancelEvents( const idClass *obj, const idEventDef *evdef ) {
-	idEvent *event;
-	idEvent *next;
+	int i;
+	int next;
 
 	if ( !initialized ) {
 		return;
 	}
 
-	for( event = EventQueue.Next(); event != NULL; event = next ) {
-		next = event->eventNode.Next();
+	for( i = EventObjectHash.First( EventObjectKey( obj ) ); i != -1; i = next ) {
+		next = EventObjectHash.Next( i );
+		idEvent *event = &EventPool[ i ];
 		if ( event->object == obj ) {
 			if ( !evdef || ( evdef == event->eventdef ) ) {
 				event->Free();
@@ -455,12 +642,19 @@ void idEvent::ClearEventList( void ) {
 	// initialize lists
 	//
 	FreeEvents.Clear();
-	EventQueue.Clear();
+	OverdueEvents.Clear();
+	for( i = 0; i < EVENT_WHEEL_SIZE; i++ ) {
+		EventWheel[ i ].Clear();
+	}
+	EventObjectHash.Clear();
+	numQueuedEvents = 0;
+	serviceTime = 0;
    
 	// 
 	// add the events to the free list
 	//
 	for( i = 0; i < MAX_EVENTS; i++ ) {
+		EventPool[ i ].scheduled = false;
 		EventPool[ i ].Free();
 	}
 }
@@ -484,13 +678,7 @@ void idEvent::ServiceEvents( void ) {
 	const char  *materialName;
 
 	num = 0;
-	while( !EventQueue.IsListEmpty() ) {
-		event = EventQueue.Next();
-		assert( event );
-
-		if ( event->time > gameLocal.time ) {
-			break;
-		}
+	while( ( event = NextDueEvent() ) != NULL ) {
 
 		// copy the data into the local args array and set up pointers
 		ev = event->eventdef;
@@ -540,7 +728,7 @@ void idEvent::ServiceEvents( void ) {
 
 		// the event is removed from its list so that if then object
 		// is deleted, the event won't be freed twice
-		event->eventNode.Remove();
+		event->Unschedule();
 		assert( event->object );
 		event->object->ProcessEventArgPtr( ev, args );
 
@@ -628,11 +816,14 @@ void idEvent::Save( idSaveGame *savefile ) {
 	byte *dataPtr;
 	bool validTrace;
 	const char	*format;
+	idList<idEvent *> events;
+
+	GetQueuedEvents( events );
 
-	savefile->WriteInt( EventQueue.Num() );
+	savefile->WriteInt( events.Num() );
 
-	event = EventQueue.Next();
-	while( event != NULL ) {
+	for ( int e = 0; e < events.Num(); e++ ) {
+		event = events[ e ];
 		savefile->WriteInt( event->time );
 		savefile->WriteString( event->eventdef->GetName() );
 		savefile->WriteString( event->typeinfo->classname );
@@ -684,7 +875,6 @@ void idEvent::Save( idSaveGame *savefile ) {
 			}
 		}
 		assert( size == event->eventdef->GetArgSize() );
-		event = event->eventNode.Next();
 	}
 }
 
@@ -710,7 +900,6 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		event = FreeEvents.Next();
 		event->eventNode.Remove();
-		event->eventNode.AddToEnd( EventQueue );
 
 		savefile->ReadInt( event->time );
 
@@ -786,6 +975,9 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 		} else {
 			event->data = NULL;
 		}
+
+		// the events were saved in firing order, so this appends them
+		event->Enqueue();
 	}
 }
 
@@ -839,6 +1031,76 @@ void idEvent::SaveTrace( idSaveGame *savefile, const trace_t &trace ) {
 
 
 
+/*
+================
+idEvent::StressTest_f
+
+Posts events with random delays to a set of dummy objects in batches that fit
+in the event pool, cancels them again object by object, and reports the time
+spent and whether the queue stayed consistent.
+================
+*/
+void idEvent::StressTest_f( const idCmdArgs &args ) {
+	const int NUM_OBJECTS = 1024;
+	const int MAX_DELAY = 20000;
+
+	if ( !initialized ) {
+		gameLocal.Printf( "Event system not initialized\n" );
+		return;
+	}
+
+	int numEvents = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 100000;
+	if ( numEvents < 1 ) {
+		gameLocal.Printf( "usage: testEvents [numEvents]\n" );
+		return;
+	}
+
+	// leave room for the events of the running game
+	const int batchSize = ( MAX_EVENTS - numQueuedEvents ) / 2;
+	if ( batchSize < 1 ) {
+		gameLocal.Printf( "Event queue is full (%d events)\n", numQueuedEvents );
+		return;
+	}
+	const int startQueued = numQueuedEvents;
+
+	idList<idClass *> objects;
+	objects.SetNum( NUM_OBJECTS );
+	for ( int i = 0; i < NUM_OBJECTS; i++ ) {
+		objects[ i ] = new idClass;
+	}
+
+	idRandom random( 0 );
+	idTimer scheduleTimer, cancelTimer;
+	bool ok = true;
+
+	for ( int posted = 0; posted < numEvents; ) {
+		const int num = Min( batchSize, numEvents - posted );
+
+		scheduleTimer.Start();
+		for ( int i = 0; i < num; i++ ) {
+			objects[ random.RandomInt( NUM_OBJECTS ) ]->PostEventMS( &EV_Remove, random.RandomInt( MAX_DELAY ) );
+		}
+		scheduleTimer.Stop();
+		posted += num;
+
+		ok &= CheckQueue() && ( numQueuedEvents == startQueued + num );
+
+		cancelTimer.Start();
+		for ( int i = 0; i < NUM_OBJECTS; i++ ) {
+			objects[ i ]->CancelEvents( &EV_Remove );
+		}
+		cancelTimer.Stop();
+
+		ok &= ( numQueuedEvents == startQueued );
+	}
+
+	objects.DeleteContents( true );
+
+	gameLocal.Printf( "%d events on %d objects in batches of %d: %s\n", numEvents, NUM_OBJECTS, batchSize, ok ? "ok" : S_COLOR_RED"X" );
+	gameLocal.Printf( "  schedule: %8.2f ms (%.3f us per event)\n", scheduleTimer.Milliseconds(), scheduleTimer.Milliseconds() * 1000.0 / numEvents );
+	gameLocal.Printf( "  cancel:   %8.2f ms\n", cancelTimer.Milliseconds() );
+}
+
 #ifdef CREATE_EVENT_CODE
 /*
 ================
@@ -118,9 +118,17 @@ private:
 	const idTypeInfo			*typeinfo;
 
 	idLinkList<idEvent>			eventNode;
+	bool						scheduled;		// linked into the timer wheel or the overdue list
 
 	static idDynamicBlockAlloc<byte, 16 * 1024, 256> eventDataAllocator;
 
+	void						Enqueue( void );
+	void						Unschedule( void );
+
+	static idEvent *			NextDueEvent( void );
+	static void					GetQueuedEvents( idList<idEvent *> &events );
+	static bool					CheckQueue( void );
+
 
 public:
 	static bool					initialized;
@@ -146,6 +154,9 @@ public:
 
 	static void					SaveTrace( idSaveGame *savefile, const trace_t &trace );
 	static void					RestoreTrace( idRestoreGame *savefile, trace_t &trace );
+
+	// schedules and cancels events on dummy objects and reports the time taken
+	static void					StressTest_f( const idCmdArgs &args );
 	
 };
 
@@ -59,34 +59,124 @@ The caching mechanism works in the following way. On game saving, there are two
 		//	gameSoundWorld->WriteToSaveGame( file ) - closed source
 		//	WriteBuildNumber() and WriteCodeRevision() - vital, should not be compressed
 		This data is written directly to the file.
+The cache is split into blocks of SAVEGAME_BLOCK_SIZE bytes. Each full block is deflated on the job list
+while the following ones are being written, and its uncompressed data is freed right after.
 After all the data has been passed to idSaveGame, FinalizeCache must be called.
-Depending on the settings it may compress the cache. Then it is finally dumped to idFile.
+It compresses the last block, waits for the jobs and dumps the block index and the blocks to idFile.
 After that the last 4 bytes are written to the file - offset to cache start from the end of file.
 The final file layout is then:
 	1. Doom3 header (level info, we cannot change it)
 	2. Special data (including version numbers)
-	3. Cache image, maybe compressed (consists of ordinary data)
+	3. Cache image: SAVEGAME_BLOCKS_MARKER, uncompressed size, number of blocks,
+	   compressed and uncompressed size of each block, then the compressed blocks
 	4. Offset from EOF to cache image (is negative)
+Older savegames store the cache image as its compressed size, uncompressed size and a single zlib stream.
 Restoring works almost the same way, but the cache must be retrieved at the very beginning.
 The InitializeCache must be called before any ordinary data is read from the file.
-It uses fseek to get offset to cache image, then reads it, probably decompresses it.
+It uses fseek to get offset to cache image, then reads it and decompresses the blocks on the job list.
 Afterwards it fseeks to the file position on the moment of call.
 Then all the Read* happens which reads ordinary data from cache and special data from file.
 */
 
-idSaveGame::idSaveGame( idFile *savefile ) {
+// the cache is compressed in independent blocks of this size
+#define SAVEGAME_BLOCK_SIZE		( 1 << 20 )
+
+// written in place of the compressed size of the old single stream cache image
+#define SAVEGAME_BLOCKS_MARKER	-1
+
+struct saveGameBlock_t {
+	CRawVector	data;		// uncompressed until the job has run, compressed afterwards
+	int			size;		// uncompressed size
+	int			zipError;
+};
+
+/*
+================
+CompressSaveGameBlock
+================
+*/
+static void CompressSaveGameBlock( saveGameBlock_t *block ) {
+	CRawVector zipped;
+	uLongf zipSize = ExtLibs::compressBound( (uLongf)block->size );
+	zipped.resize( zipSize );
+
+	block->zipError = ExtLibs::compress(
+		(Bytef *)&zipped[0], &zipSize,
+		(const Bytef *)&block->data[0], (uLongf)block->size
+	);
+	zipped.resize( zipSize );
+
+	// the uncompressed data is freed along with zipped
+	std::swap( block->data, zipped );
+}
+
+REGISTER_PARALLEL_JOB( CompressSaveGameBlock, "CompressSaveGameBlock" );
+
+struct restoreGameBlock_t {
+	const char *	zipped;
+	int				zipSize;
+	char *			data;
+	int				size;
+	int				zipError;
+};
+
+/*
+================
+UncompressSaveGameBlock
+================
+*/
+static void UncompressSaveGameBlock( restoreGameBlock_t *block ) {
+	uLongf size = block->size;
+	block->zipError = ExtLibs::uncompress(
+		(Bytef *)block->data, &size,
+		(const Bytef *)block->zipped, (uLongf)block->zipSize
+	);
+	if ( block->zipError == Z_OK && (int)size != block->size ) {
+		block->zipError = Z_DATA_ERROR;
+	}
+}
+
+REGISTER_PARALLEL_JOB( UncompressSaveGameBlock, "UncompressSaveGameBlock" );
+
+// keep the chains short for missions with thousands of objects
+#define SAVEGAME_OBJECTS_HASH_SIZE	4096
+
+/*
+================
+SaveGameObjectKey
+
+Objects are heap allocated, so the low pointer bits carry no information.
+================
+*/
+static ID_INLINE int SaveGameObjectKey( const idClass *obj ) {
+	return static_cast<int>( reinterpret_cast<size_t>( obj ) >> 4 );
+}
+
+idSaveGame::idSaveGame( idFile *savefile ) :
+	objectsHash( SAVEGAME_OBJECTS_HASH_SIZE, SAVEGAME_OBJECTS_HASH_SIZE ) {
 
 	file = savefile;
 
 	// Put NULL at the start of the list so we can skip over it.
 	objects.Clear();
+	objects.SetGranularity( SAVEGAME_OBJECTS_HASH_SIZE );
 	objects.Append( NULL );
+	objectsHash.Add( SaveGameObjectKey( NULL ), 0 );
+
+	isCompressed = false;
+	numSubmittedBlocks = 0;
+	compressJobs = NULL;
 }
 
 idSaveGame::~idSaveGame() {
 	if ( objects.Num() ) {
 		Close();
 	}
+	if ( compressJobs != NULL ) {
+		compressJobs->Wait();
+		parallelJobManager->FreeJobList( compressJobs );
+	}
+	blocks.DeleteContents( true );
 }
 
 void idSaveGame::Close( void ) {
@@ -102,6 +192,7 @@ void idSaveGame::Close( void ) {
 	}
 
 	objects.Clear();
+	objectsHash.Free();
 
 #ifdef ID_USE_TYPEINFO
 	idStr gameState = file->GetName();
@@ -110,34 +201,90 @@ void idSaveGame::Close( void ) {
 #endif
 }
 
+/*
+================
+idSaveGame::FlushCacheBlock
+
+Moves the filled cache into a new block and queues it for compression.
+================
+*/
+void idSaveGame::FlushCacheBlock( void ) {
+	if ( cache.size() == 0 ) {
+		return;
+	}
+
+	saveGameBlock_t *block = new saveGameBlock_t;
+	block->size = cache.size();
+	block->zipError = Z_OK;
+	std::swap( block->data, cache );
+	blocks.Append( block );
+
+	SubmitCacheBlocks();
+}
+
+/*
+================
+idSaveGame::SubmitCacheBlocks
+
+Submits the pending blocks unless the previous batch is still being compressed,
+in which case they are picked up by the next call.
+================
+*/
+void idSaveGame::SubmitCacheBlocks( void ) {
+	if ( compressJobs == NULL ) {
+		compressJobs = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, 64, 0, NULL );
+	}
+	if ( compressJobs->IsSubmitted() && !compressJobs->TryWait() ) {
+		return;
+	}
+	if ( numSubmittedBlocks == blocks.Num() ) {
+		return;
+	}
+	for ( ; numSubmittedBlocks < blocks.Num(); numSubmittedBlocks++ ) {
+		compressJobs->AddJob( (jobRun_t)CompressSaveGameBlock, blocks[numSubmittedBlocks] );
+	}
+	compressJobs->Submit();
+}
+
 void idSaveGame::FinalizeCache( void ) {
 	if (!isCompressed) return;
-		
-	int offset = sizeof(int);
 
-	//resize destination buffer
-	CRawVector zipped;
-	uLongf zipsize = ExtLibs::compressBound((uLongf)cache.size());
-	zipped.resize(zipsize);
+	//compress the last block and wait for all of them
+	FlushCacheBlock();
+	if ( compressJobs != NULL ) {
+		compressJobs->Wait();
+		SubmitCacheBlocks();
+		compressJobs->Wait();
+	}
 
-	//compress the cache
-	int err = ExtLibs::compress(
-		(Bytef *)&zipped[0], &zipsize,
-		(const Bytef *)&cache[0], (uLongf)cache.size()
-	);
-	if (err != Z_OK)
-		gameLocal.Error("idSaveGame::FinalizeCache: compress failed with code %d", err);
-	zipped.resize(zipsize);
+	int offset = sizeof(int);
+	int cacheSize = 0;
+	for ( int i = 0; i < blocks.Num(); i++ ) {
+		if ( blocks[i]->zipError != Z_OK )
+			gameLocal.Error("idSaveGame::FinalizeCache: compress failed with code %d", blocks[i]->zipError);
+		cacheSize += blocks[i]->size;
+	}
 
-	//write compressed size and uncompressed size
-	file->WriteInt(zipped.size());				offset += sizeof(int);
-	file->WriteInt(cache.size());				offset += sizeof(int);
+	//write block index
+	file->WriteInt(SAVEGAME_BLOCKS_MARKER);		offset += sizeof(int);
+	file->WriteInt(cacheSize);					offset += sizeof(int);
+	file->WriteInt(blocks.Num());				offset += sizeof(int);
+	for ( int i = 0; i < blocks.Num(); i++ ) {
+		file->WriteInt(blocks[i]->data.size());	offset += sizeof(int);
+		file->WriteInt(blocks[i]->size);		offset += sizeof(int);
+	}
 	//write compressed data
-	file->Write(&zipped[0], zipped.size());		offset += zipped.size();
+	for ( int i = 0; i < blocks.Num(); i++ ) {
+		file->Write(&blocks[i]->data[0], blocks[i]->data.size());
+		offset += blocks[i]->data.size();
+	}
 	//write offset from EOF to cache start
 	file->WriteInt(-offset);
 
-	cache.clear();
+	blocks.DeleteContents( true );
+	numSubmittedBlocks = 0;
+	parallelJobManager->FreeJobList( compressJobs );
+	compressJobs = NULL;
 }
 
 void idSaveGame::WriteObjectList( void ) {
@@ -161,8 +308,26 @@ void idSaveGame::CallSave_r( const idTypeInfo *cls, const idClass *obj ) {
 	( obj->*cls->Save )( this );
 }
 
+/*
+================
+idSaveGame::FindObjectIndex
+
+Returns -1 if the object has not been added.
+================
+*/
+int idSaveGame::FindObjectIndex( const idClass *obj ) const {
+	for ( int i = objectsHash.First( SaveGameObjectKey( obj ) ); i != -1; i = objectsHash.Next( i ) ) {
+		if ( objects[ i ] == obj ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
 void idSaveGame::AddObject( const idClass *obj ) {
-	objects.AddUnique( obj );
+	if ( FindObjectIndex( obj ) < 0 ) {
+		objectsHash.Add( SaveGameObjectKey( obj ), objects.Append( obj ) );
+	}
 }
 
 void idSaveGame::Write( const void *buffer, int len ) {
@@ -171,6 +336,8 @@ void idSaveGame::Write( const void *buffer, int len ) {
 		int sz = cache.size();
 		cache.resize(sz + len);
 		memcpy(&cache[sz], buffer, len);
+		if (cache.size() >= SAVEGAME_BLOCK_SIZE)
+			FlushCacheBlock();
 	}
 	else
 		file->Write(buffer, len);
@@ -218,7 +385,7 @@ void idSaveGame::WriteWinding( const idWinding &w ) {
 void idSaveGame::WriteObject( const idClass *obj ) {
 	int index;
 
-	index = objects.FindIndex( obj );
+	index = FindObjectIndex( obj );
 	if ( index < 0 ) {
 		//gameLocal.Warning( "idSaveGame::WriteObject - WriteObject FindIndex failed" ); // grayman #4340
 
@@ -584,6 +751,12 @@ void idRestoreGame::InitializeCache() {
 	//read compressed cache size
 	int zipSize = -1;
 	file->ReadInt(zipSize);
+	if (zipSize == SAVEGAME_BLOCKS_MARKER) {
+		InitializeBlockCache();
+		cachePointer = 0;
+		file->Seek(position, FS_SEEK_SET);
+		return;
+	}
 	if (zipSize <= 0)
 		Error("idRestoreGame::InitializeCache: bad compressed cache size (%d)", zipSize);
 
@@ -617,6 +790,81 @@ void idRestoreGame::InitializeCache() {
 	file->Seek(position, FS_SEEK_SET);
 }
 
+/*
+================
+idRestoreGame::InitializeBlockCache
+
+Reads the block index and the compressed blocks and decompresses them
+into the cache on the job list.
+================
+*/
+void idRestoreGame::InitializeBlockCache( void ) {
+	//read uncompressed cache size and block count
+	int cacheSize = -1;
+	file->ReadInt(cacheSize);
+	if (cacheSize < 0)
+		Error("idRestoreGame::InitializeBlockCache: bad uncompressed cache size (%d)", cacheSize);
+	int numBlocks = -1;
+	file->ReadInt(numBlocks);
+	if (numBlocks < 0)
+		Error("idRestoreGame::InitializeBlockCache: bad number of blocks (%d)", numBlocks);
+
+	//read block index
+	idList<restoreGameBlock_t> blockList;
+	blockList.SetNum(numBlocks);
+	int zipSize = 0;
+	int dataSize = 0;
+	for ( int i = 0; i < numBlocks; i++ ) {
+		restoreGameBlock_t &block = blockList[i];
+		file->ReadInt(block.zipSize);
+		file->ReadInt(block.size);
+		if (block.zipSize <= 0 || block.size <= 0)
+			Error("idRestoreGame::InitializeBlockCache: bad size of block %d (%d, %d)", i, block.zipSize, block.size);
+		zipSize += block.zipSize;
+		dataSize += block.size;
+	}
+	if (dataSize != cacheSize)
+		Error("idRestoreGame::InitializeBlockCache: blocks hold %d bytes instead of %d", dataSize, cacheSize);
+
+	cache.resize(cacheSize);
+	if (numBlocks == 0)
+		return;
+
+	//read compressed data
+	CRawVector zipped;
+	zipped.resize(zipSize);
+	file->Read(&zipped[0], zipped.size());
+
+	zipSize = 0;
+	dataSize = 0;
+	for ( int i = 0; i < numBlocks; i++ ) {
+		restoreGameBlock_t &block = blockList[i];
+		block.zipped = &zipped[zipSize];
+		block.data = &cache[dataSize];
+		block.zipError = Z_OK;
+		zipSize += block.zipSize;
+		dataSize += block.size;
+	}
+
+	//decompress data
+	if (numBlocks == 1) {
+		UncompressSaveGameBlock(&blockList[0]);
+	} else {
+		idParallelJobList *jobs = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, numBlocks, 0, NULL );
+		for ( int i = 0; i < numBlocks; i++ ) {
+			jobs->AddJob( (jobRun_t)UncompressSaveGameBlock, &blockList[i] );
+		}
+		jobs->Submit();
+		jobs->Wait();
+		parallelJobManager->FreeJobList( jobs );
+	}
+
+	for ( int i = 0; i < numBlocks; i++ ) {
+		if (blockList[i].zipError != Z_OK)
+			Error("idRestoreGame::InitializeBlockCache: uncompress failed with code %d in block %d", blockList[i].zipError, i);
+	}
+}
+
 void idRestoreGame::CreateObjects( void ) {
 	int i, num;
 	idStr classname;
@@ -1155,6 +1403,8 @@ void idSaveGame::Write##name_type (const cpp_type value)					\
 		cache.resize(sz + sizeof(cpp_type));								\
 		cpp_type *value_ptr = (cpp_type*)&cache[sz];						\
 		*value_ptr = Little##conv_type (value);								\
+		if (cache.size() >= SAVEGAME_BLOCK_SIZE)							\
+			FlushCacheBlock();												\
 	}																		\
 	else																	\
 		file->Write##name_type(value);										\
@@ -38,6 +38,7 @@ class idUserInterface;
 typedef struct renderEntity_s renderEntity_t;
 typedef struct renderLight_s renderLight_t;
 struct refSound_t;
+struct saveGameBlock_t;
 typedef struct renderView_s renderView_t;
 class usercmd_t;
 struct contactInfo_t;
@@ -114,11 +115,20 @@ private:
 	idFile *				file;
 
 	idList<const idClass *>	objects;
+	idHashIndex				objectsHash;	// object pointer to index in objects
 
 	bool					isCompressed;
-	CRawVector				cache;
+	CRawVector				cache;			// block currently being filled
+
+	// full blocks are deflated on the job list while the next ones are written
+	idList<saveGameBlock_t *>	blocks;
+	int						numSubmittedBlocks;
+	idParallelJobList *		compressJobs;
 
 	void					CallSave_r( const idTypeInfo *cls, const idClass *obj );
+	void					FlushCacheBlock( void );
+	void					SubmitCacheBlocks( void );
+	int						FindObjectIndex( const idClass *obj ) const;
 };
 
 class idRestoreGame {
@@ -203,6 +213,7 @@ private:
 	int						cachePointer;
 
 	void					CallRestore_r( const idTypeInfo *cls, idClass *obj );
+	void					InitializeBlockCache( void );
 };
 
 #endif /* !__SAVEGAME_H__*/
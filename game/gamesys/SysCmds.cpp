@@ -71,6 +71,16 @@ void Cmd_PrintAIRelations_f( const idCmdArgs &args )
 	return;
 }
 
+/*
+==================
+Cmd_AIThinkReport_f
+==================
+*/
+void Cmd_AIThinkReport_f( const idCmdArgs &args ) 
+{
+	gameLocal.m_AIThinkScheduler.PrintReport();
+}
+
 /**
  * greebo: This is a helper command, used by the restart.gui
  */
@@ -216,6 +226,102 @@ void Cmd_GenScriptEventDoc_f(const idCmdArgs& args)
 	fileSystem->CloseFile(file);
 }
 
+/*
+==================
+Cmd_TestSaveGameObjects_f
+
+Saves a synthetic world of plain idClass objects into memory, each object
+writing a few references to others like entities do, and reports how long
+the object registration and the reference lookups take.  The same pattern
+is timed with linear idList lookups for comparison.
+==================
+*/
+void Cmd_TestSaveGameObjects_f( const idCmdArgs &args )
+{
+	const int NUM_REFERENCES = 8;
+
+	// idSaveGame::Close writes the sound world
+	if ( gameLocal.GameState() != GAMESTATE_ACTIVE )
+	{
+		gameLocal.Printf( "No map running\n" );
+		return;
+	}
+
+	int numObjects = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 10000;
+	if ( numObjects < 1 )
+	{
+		gameLocal.Printf( "usage: testSaveGameObjects [numObjects]\n" );
+		return;
+	}
+
+	idList<idClass *> world;
+	world.SetNum( numObjects );
+	for ( int i = 0; i < numObjects; i++ )
+	{
+		world[i] = new idClass;
+	}
+
+	idTimer totalTimer, addTimer, writeTimer;
+	idFile_Memory file( "testSaveGameObjects" );
+
+	totalTimer.Start();
+	{
+		idSaveGame savegame( &file );
+		savegame.WriteHeader();
+
+		addTimer.Start();
+		for ( int i = 0; i < numObjects; i++ )
+		{
+			savegame.AddObject( world[i] );
+		}
+		addTimer.Stop();
+
+		savegame.WriteObjectList();
+
+		writeTimer.Start();
+		for ( int i = 0; i < numObjects; i++ )
+		{
+			for ( int j = 0; j < NUM_REFERENCES; j++ )
+			{
+				savegame.WriteObject( world[ ( i * 31 + j * 7919 ) % numObjects ] );
+			}
+		}
+		writeTimer.Stop();
+
+		savegame.Close();
+		savegame.FinalizeCache();
+	}
+	totalTimer.Stop();
+
+	// the lookups as they were done before the object hash
+	idTimer linearTimer;
+	idList<const idClass *> linearObjects;
+	int checksum = 0;
+
+	linearTimer.Start();
+	linearObjects.Append( NULL );
+	for ( int i = 0; i < numObjects; i++ )
+	{
+		linearObjects.AddUnique( world[i] );
+	}
+	for ( int i = 0; i < numObjects; i++ )
+	{
+		for ( int j = 0; j < NUM_REFERENCES; j++ )
+		{
+			checksum += linearObjects.FindIndex( world[ ( i * 31 + j * 7919 ) % numObjects ] );
+		}
+	}
+	linearTimer.Stop();
+
+	world.DeleteContents( true );
+
+	gameLocal.Printf( "%d objects, %d references each, %d bytes\n", numObjects, NUM_REFERENCES, file.Length() );
+	gameLocal.Printf( "  AddObject:   %8.2f ms\n", addTimer.Milliseconds() );
+	gameLocal.Printf( "  WriteObject: %8.2f ms\n", writeTimer.Milliseconds() );
+	gameLocal.Printf( "  total save:  %8.2f ms\n", totalTimer.Milliseconds() );
+	gameLocal.Printf( "  linear lookups for comparison: %8.2f ms (%d)\n", linearTimer.Milliseconds(), checksum );
+}
+
 /*
 ==================
 Cmd_AttachmentOffset_f
@@ -1767,6 +1873,15 @@ static void Cmd_ListCollisionModels_f( const idCmdArgs &args ) {
 	collisionModelManager->ListModels();
 }
 
+/*
+==================
+Cmd_CollisionModelBuildTimes_f
+==================
+*/
+static void Cmd_CollisionModelBuildTimes_f( const idCmdArgs &args ) {
+	collisionModelManager->ListBuildTimes();
+}
+
 /*
 ==================
 Cmd_CollisionModelInfo_f
@@ -3837,6 +3952,7 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "script",				Cmd_Script_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"executes a line of script" );
 	cmdSystem->AddCommand( "listCollisionModels",	Cmd_ListCollisionModels_f,	CMD_FL_GAME,				"lists collision models" );
 	cmdSystem->AddCommand( "collisionModelInfo",	Cmd_CollisionModelInfo_f,	CMD_FL_GAME,				"shows collision model info" );
+	cmdSystem->AddCommand( "collisionModelBuildTimes",	Cmd_CollisionModelBuildTimes_f,	CMD_FL_GAME,		"lists the build time of the collision models built from the map" );
 	cmdSystem->AddCommand( "reexportmodels",		Cmd_ReexportModels_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"reexports models", ArgCompletion_DefFile );
 	cmdSystem->AddCommand( "reloadanims",			Cmd_ReloadAnims_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"reloads animations" );
 	cmdSystem->AddCommand( "listAnims",				Cmd_ListAnims_f,			CMD_FL_GAME,				"lists all animations" );
@@ -3856,6 +3972,7 @@ void idGameLocal::InitConsoleCommands( void ) {
 
 	cmdSystem->AddCommand( "tdm_spr_testIO",		Cmd_TestSndIO_f,			CMD_FL_GAME,				"test soundprop file IO (needs a .spr file)" );
 	cmdSystem->AddCommand( "tdm_ai_rel_print",		Cmd_PrintAIRelations_f,		CMD_FL_GAME,				"print the relationship matrix determining relations between AI teams." );
+	cmdSystem->AddCommand( "tdm_ai_think_report",	Cmd_AIThinkReport_f,		CMD_FL_GAME,				"print the distribution of the per-frame AI think cost and the most expensive AI." );
 
 	cmdSystem->AddCommand( "tdm_attach_offset",		Cmd_AttachmentOffset_f,		CMD_FL_GAME,				"Set the vector offset (x y z) for an attachment on an AI you are looking at.  Usage: tdm_attach_offset <attachment index> <x> <y> <z>" );
 	cmdSystem->AddCommand( "tdm_attach_rot",		Cmd_AttachmentRot_f,		CMD_FL_GAME,				"Set the rotation (pitch yaw roll) for an attachment on an AI you are looking at.  Usage: tdm_attach_rot <atachment index> <pitch> <yaw> <roll>  (NOTE: Rotation is applied before translation, angles are relative to the joint orientation)" );
@@ -3890,6 +4007,8 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "tdm_end_mission", Cmd_EndMission_f, CMD_FL_GAME, "Ends this mission and proceeds to the next.");
 
 	cmdSystem->AddCommand( "tdm_gen_script_event_doc", Cmd_GenScriptEventDoc_f, CMD_FL_GAME, "Generates a script event doc file in a certain format.");
+	cmdSystem->AddCommand( "testSaveGameObjects", Cmd_TestSaveGameObjects_f, CMD_FL_GAME|CMD_FL_CHEAT, "Times saving a synthetic world of objects into memory, usage: testSaveGameObjects [numObjects]");
+	cmdSystem->AddCommand( "testEvents", idEvent::StressTest_f, CMD_FL_GAME|CMD_FL_CHEAT, "Times scheduling and cancelling events, usage: testEvents [numEvents]");
 
 	cmdSystem->AddCommand( "disasmScript",			Cmd_DisasmScript_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"disassembles script" );
 	cmdSystem->AddCommand( "exportmodels",			Cmd_ExportModels_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"exports models", ArgCompletion_DefFile );
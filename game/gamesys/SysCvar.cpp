@@ -99,6 +99,10 @@ idCVar cv_ai_opt_interleavethinkmindist (		"tdm_ai_opt_interleavethinkmindist",
 idCVar cv_ai_opt_interleavethinkmaxdist (		"tdm_ai_opt_interleavethinkmaxdist",		"0",	CVAR_GAME | CVAR_ARCHIVE | CVAR_FLOAT, "If true (nonzero), this is the distance where interleave frame will reach its maximum value." );
 idCVar cv_ai_opt_interleavethinkskippvscheck (	"tdm_ai_opt_interleavethinkskipPVS",		"0",	CVAR_GAME | CVAR_ARCHIVE | CVAR_BOOL, "If true (nonzero), the player PVS check for interleaved thinking will be skipped, so that the AI can also do interleaved thinking while in view." );
 idCVar cv_ai_opt_interleavethinkframes (		"tdm_ai_opt_interleavethinkframes",			"0",	CVAR_GAME | CVAR_ARCHIVE | CVAR_INTEGER, "If true (nonzero), this is the maximum interleaved thinking frame number." );
+idCVar cv_ai_think_scheduler (				"tdm_ai_think_scheduler",		"1",	CVAR_GAME | CVAR_ARCHIVE | CVAR_BOOL, "If true (nonzero), interleaved AI thinks are spread over the least loaded frames instead of running a fixed number of frames apart." );
+idCVar cv_ai_think_budget (					"tdm_ai_think_budget",			"0",	CVAR_GAME | CVAR_ARCHIVE | CVAR_FLOAT, "Time in msec the AI may spend thinking per frame, AI exceeding it are deferred to the next frame. 0 = unlimited." );
+idCVar cv_ai_think_maxdefer (				"tdm_ai_think_maxdefer",		"3",	CVAR_GAME | CVAR_ARCHIVE | CVAR_INTEGER, "Maximum number of frames in a row an AI can be deferred by tdm_ai_think_budget.", 0, 60 );
+idCVar cv_ai_think_prioritydist (			"tdm_ai_think_prioritydist",	"1000",	CVAR_GAME | CVAR_ARCHIVE | CVAR_FLOAT, "AI closer to the player than this distance are never deferred by tdm_ai_think_budget, neither are alerted AI." );
 idCVar cv_ai_opt_update_enemypos_interleave (	"tdm_ai_opt_update_enemypos_interleave",	"48",	CVAR_GAME | CVAR_ARCHIVE | CVAR_INTEGER, "Time to pass between enemy position updates. Set this to 0 for updates each frame." );
 
 idCVar cv_ai_opt_nomind (						"tdm_ai_opt_nomind",				"0",			CVAR_GAME | CVAR_BOOL, "If true (nonzero), AI has its Mind thinking routines disabled." );
@@ -162,6 +166,8 @@ idCVar cv_tdm_difficulty(			"tdm_difficulty",	"-1",					CVAR_GAME | CVAR_INTEGER
 
 idCVar cv_sr_disable (				"tdm_sr_disable",           "0",           CVAR_GAME | CVAR_BOOL, "Set to 1 to disable all stim/response processing." );
 idCVar cv_sr_show(					"tdm_show_stimresponse",    "0",           CVAR_GAME | CVAR_INTEGER, "Set to 1 to show all successful stims, set to 2 to show all including failed ones." );
+idCVar cv_sr_broadphase(			"tdm_sr_broadphase",        "1",           CVAR_GAME | CVAR_BOOL, "Set to 1 to find the responders in reach of a stim using a grid over the response entities instead of the clip sectors." );
+idCVar cv_sr_stats(					"tdm_sr_stats",             "0",           CVAR_GAME | CVAR_BOOL, "Set to 1 to print the number of stim/response candidates tested each frame." );
 
 idCVar cv_debug_mainmenu(			"tdm_debug_mainmenu",      "0",            CVAR_BOOL, "Set to 1 to enable main menu GUI debugging in the console." );
 idCVar cv_mainmenu_confirmquit(		"tdm_mainmenu_confirmquit",      "1", CVAR_ARCHIVE | CVAR_BOOL, "Set to 0 to disable the 'Quit Game' confirmation dialog when exiting the game." );
@@ -65,6 +65,10 @@ extern idCVar cv_ai_opt_interleavethinkmindist;
 extern idCVar cv_ai_opt_interleavethinkmaxdist;
 extern idCVar cv_ai_opt_interleavethinkskippvscheck;
 extern idCVar cv_ai_opt_interleavethinkframes;
+extern idCVar cv_ai_think_scheduler;
+extern idCVar cv_ai_think_budget;
+extern idCVar cv_ai_think_maxdefer;
+extern idCVar cv_ai_think_prioritydist;
 extern idCVar cv_ai_opt_update_enemypos_interleave;
 extern idCVar cv_ai_opt_nomind;
 extern idCVar cv_ai_opt_novisualstim;
@@ -113,6 +117,8 @@ extern idCVar cv_tdm_difficulty;
 
 extern idCVar cv_sr_disable;
 extern idCVar cv_sr_show;
+extern idCVar cv_sr_broadphase;
+extern idCVar cv_sr_stats;
 
 extern idCVar cv_sndprop_disable;
 extern idCVar cv_spr_debug;
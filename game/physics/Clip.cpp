@@ -515,6 +515,11 @@ idClipModel::Unlink
 void idClipModel::Unlink( void ) {
 	clipLink_t *link;
 
+	if ( clipLinks ) {
+		// the stim response grid relinks the responder on the next update
+		gameLocal.m_ResponseGrid.EntityMoved( entity );
+	}
+
 	for ( link = clipLinks; link; link = clipLinks ) {
 		clipLinks = link->nextLink;
 		if ( link->prevInSector ) {
@@ -597,6 +602,8 @@ void idClipModel::Link( idClip &clp ) {
 	absBounds[1] += vec3_boxEpsilon;
 
 	Link_r( clp.clipSectors );
+
+	gameLocal.m_ResponseGrid.EntityMoved( entity );
 }
 
 /*
@@ -97,6 +97,31 @@ punctuation_t default_punctuations[] = {
 	{NULL, 0}
 };
 
+// character classes used to scan runs of characters, the token is then built with a single copy
+#define LEXCHAR_NAME	1		// name character
+#define LEXCHAR_PATH	2		// name character with LEXFL_ALLOWPATHNAMES
+#define LEXCHAR_DASH	4		// name character with LEXFL_ONLYSTRINGS
+#define LEXCHAR_DIGIT	8		// decimal digit
+#define LEXCHAR_HEX		16		// hexadecimal digit
+#define LEXCHAR_QUOTE	32		// ends a run of plain string characters
+
+#define LEXCHAR_ALPHA	( LEXCHAR_NAME )
+#define LEXCHAR_ALPHX	( LEXCHAR_NAME | LEXCHAR_HEX )
+#define LEXCHAR_NUM		( LEXCHAR_NAME | LEXCHAR_DIGIT | LEXCHAR_HEX )
+#define LEXCHAR_BSLASH	( LEXCHAR_PATH | LEXCHAR_QUOTE )
+
+static const byte lexerCharClass[256] = {
+	LEXCHAR_QUOTE, 0, 0, 0, 0, 0, 0, 0, 0, 0, LEXCHAR_QUOTE, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, LEXCHAR_QUOTE, 0, 0, 0, 0, LEXCHAR_QUOTE, 0, 0, 0, 0, 0, LEXCHAR_DASH, LEXCHAR_PATH, LEXCHAR_PATH,
+	LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_NUM, LEXCHAR_PATH, 0, 0, 0, 0, 0,
+	0, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA,
+	LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, 0, LEXCHAR_BSLASH, 0, 0, LEXCHAR_ALPHA,
+	0, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHX, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA,
+	LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, LEXCHAR_ALPHA, 0, 0, 0, 0, 0,
+	// no special meaning for 0x80 - 0xff
+};
+
 int default_punctuationtable[256];
 int default_nextpunctuation[sizeof(default_punctuations) / sizeof(punctuation_t)];
 int default_setup;
@@ -233,6 +258,8 @@ void idLexer::Warning( const char *str, ... ) {
 	char text[MAX_STRING_CHARS];
 	va_list ap;
 
+	hadWarning = true;
+
 	if ( idLexer::flags & LEXFL_NOWARNINGS ) {
 		return;
 	}
@@ -493,7 +520,12 @@ int idLexer::ReadString( idToken *token, int quote ) {
 				idLexer::Error( "newline inside string" );
 				return 0;
 			}
-			token->AppendDirty( *idLexer::script_p++ );
+			// copy everything up to the next quote, escape or line end at once
+			const char *start = idLexer::script_p++;
+			while ( !( lexerCharClass[(byte)*idLexer::script_p] & LEXCHAR_QUOTE ) ) {
+				idLexer::script_p++;
+			}
+			token->AppendDirty( start, idLexer::script_p - start );
 		}
 	}
 	token->data[token->len] = '\0';
@@ -519,20 +551,22 @@ idLexer::ReadName
 ================
 */
 int idLexer::ReadName( idToken *token ) {
-	char c;
+	int mask = LEXCHAR_NAME;
+	// if treating all tokens as strings, don't parse '-' as a seperate token
+	if ( idLexer::flags & LEXFL_ONLYSTRINGS ) {
+		mask |= LEXCHAR_DASH;
+	}
+	// if special path name characters are allowed
+	if ( idLexer::flags & LEXFL_ALLOWPATHNAMES ) {
+		mask |= LEXCHAR_PATH;
+	}
 
 	token->type = TT_NAME;
-	do {
-		token->AppendDirty( *idLexer::script_p++ );
-		c = *idLexer::script_p;
-	} while ((c >= 'a' && c <= 'z') ||
-				(c >= 'A' && c <= 'Z') ||
-				(c >= '0' && c <= '9') ||
-				c == '_' ||
-				// if treating all tokens as strings, don't parse '-' as a seperate token
-				((idLexer::flags & LEXFL_ONLYSTRINGS) && (c == '-')) ||
-				// if special path name characters are allowed
-				((idLexer::flags & LEXFL_ALLOWPATHNAMES) && (c == '/' || c == '\\' || c == ':' || c == '.')) );
+	const char *start = idLexer::script_p++;
+	while ( lexerCharClass[(byte)*idLexer::script_p] & mask ) {
+		idLexer::script_p++;
+	}
+	token->AppendDirty( start, idLexer::script_p - start );
 	token->data[token->len] = '\0';
 	//the sub type is the length of the name
 	token->subtype = token->Length();
@@ -564,6 +598,7 @@ int idLexer::ReadNumber( idToken *token ) {
 	int i;
 	int dot;
 	char c, c2;
+	const char *start;
 
 	token->type = TT_NUMBER;
 	token->subtype = 0;
@@ -576,15 +611,13 @@ int idLexer::ReadNumber( idToken *token ) {
 	if ( c == '0' && c2 != '.' ) {
 		// check for a hexadecimal number
 		if ( c2 == 'x' || c2 == 'X' ) {
-			token->AppendDirty( *idLexer::script_p++ );
-			token->AppendDirty( *idLexer::script_p++ );
-			c = *idLexer::script_p;
-			while((c >= '0' && c <= '9') ||
-						(c >= 'a' && c <= 'f') ||
-						(c >= 'A' && c <= 'F')) {
-				token->AppendDirty( c );
-				c = *(++idLexer::script_p);
+			start = idLexer::script_p;
+			idLexer::script_p += 2;
+			while ( lexerCharClass[(byte)*idLexer::script_p] & LEXCHAR_HEX ) {
+				idLexer::script_p++;
 			}
+			token->AppendDirty( start, idLexer::script_p - start );
+			c = *idLexer::script_p;
 			token->subtype = TT_HEX | TT_INTEGER;
 		}
 		// check for a binary number
@@ -612,8 +645,9 @@ int idLexer::ReadNumber( idToken *token ) {
 	else {
 		// decimal integer or floating point number or ip address
 		dot = 0;
+		start = idLexer::script_p;
 		while( 1 ) {
-			if ( c >= '0' && c <= '9' ) {
+			if ( lexerCharClass[(byte)c] & LEXCHAR_DIGIT ) {
 			}
 			else if ( c == '.' ) {
 				dot++;
@@ -621,9 +655,9 @@ int idLexer::ReadNumber( idToken *token ) {
 			else {
 				break;
 			}
-			token->AppendDirty( c );
 			c = *(++idLexer::script_p);
 		}
+		token->AppendDirty( start, idLexer::script_p - start );
 		if( c == 'e' && dot == 0) {
 
 			//We have scientific notation without a decimal point
@@ -650,10 +684,11 @@ int idLexer::ReadNumber( idToken *token ) {
 					token->AppendDirty( c );
 					c = *(++idLexer::script_p);
 				}
-				while( c >= '0' && c <= '9' ) {
-					token->AppendDirty( c );
+				start = idLexer::script_p;
+				while ( lexerCharClass[(byte)c] & LEXCHAR_DIGIT ) {
 					c = *(++idLexer::script_p);
 				}
+				token->AppendDirty( start, idLexer::script_p - start );
 			}
 			// check for floating point exception infinite 1.#INF or indefinite 1.#IND or NaN
 			else if ( c == '#' ) {
@@ -1745,6 +1780,7 @@ idLexer::idLexer( void ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 }
 
 /*
@@ -1766,6 +1802,7 @@ idLexer::idLexer( int flags ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 }
 
 /*
@@ -1781,6 +1818,7 @@ idLexer::idLexer( const char *filename, int flags, bool OSPath ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 	idLexer::LoadFile( filename, OSPath );
 }
 
@@ -1797,6 +1835,7 @@ idLexer::idLexer( const char *ptr, int length, const char *name, int flags ) {
 	idLexer::token = "";
 	idLexer::next = NULL;
 	idLexer::hadError = false;
+	idLexer::hadWarning = false;
 	idLexer::LoadMemory( ptr, length, name );
 }
 
@@ -1827,4 +1866,13 @@ bool idLexer::HadError( void ) const {
 	return hadError;
 }
 
+/*
+================
+idLexer::HadWarning
+================
+*/
+bool idLexer::HadWarning( void ) const {
+	return hadWarning;
+}
+
 #pragma warning( pop )
@@ -25,9 +25,13 @@ If you have questions concerning this license or the applicable additional terms
 
 ===========================================================================
 */
-#pragma hdrstop
 #include "precompiled.h"
-#include "ParallelJobList.h"
+#pragma hdrstop
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 /*
 ================================================================================================
@@ -37,12 +41,6 @@ If you have questions concerning this license or the applicable additional terms
 ================================================================================================
 */
 
-const char * jobNames[] = {
-	ASSERT_ENUM_STRING( JOBLIST_RENDERER_FRONTEND,	0 ),
-	ASSERT_ENUM_STRING( JOBLIST_RENDERER_BACKEND,	1 ),
-	ASSERT_ENUM_STRING( JOBLIST_UTILITY,			9 ),
-};
-
 static const int MAX_REGISTERED_JOBS = 128;
 struct registeredJob {
 	jobRun_t		function;
@@ -50,8 +48,14 @@ struct registeredJob {
 } registeredJobs[MAX_REGISTERED_JOBS];
 static int numRegisteredJobs;
 
+// NOTE: keep in sync with jobListId_t
 const char * GetJobListName( jobListId_t id ) {
-	return jobNames[id];
+	switch( id ) {
+		case JOBLIST_RENDERER_FRONTEND:	return "JOBLIST_RENDERER_FRONTEND";
+		case JOBLIST_RENDERER_BACKEND:	return "JOBLIST_RENDERER_BACKEND";
+		case JOBLIST_UTILITY:			return "JOBLIST_UTILITY";
+		default:						return "JOBLIST_UNKNOWN";
+	}
 }
 
 /*
@@ -105,18 +109,32 @@ idParallelJobRegistration::idParallelJobRegistration( jobRun_t function, const c
 	RegisterJob( function, name );
 }
 
-int globalSpuLocalStoreActive;
-void * globalSpuLocalStoreStart;
-void * globalSpuLocalStoreEnd;
-idSysMutex globalSpuLocalStoreMutex;
-
 /*
-================================================================================================
+================================================
+idSysInterlockedInteger
+
+The BFG job code was written against the idSys threading
+primitives, which this engine does not have. This is a thin
+wrapper around std::atomic with the same interface. Unlike
+std::atomic it can be copied, so it can be stored in an idList.
+================================================
+*/
+class idSysInterlockedInteger {
+public:
+						idSysInterlockedInteger() : value( 0 ) {}
+						idSysInterlockedInteger( const idSysInterlockedInteger & other ) : value( other.GetValue() ) {}
+	idSysInterlockedInteger & operator=( const idSysInterlockedInteger & other ) { SetValue( other.GetValue() ); return *this; }
 
-	PS3
+	// atomically increments the integer and returns the new value
+	int					Increment() { return ++value; }
+	// atomically decrements the integer and returns the new value
+	int					Decrement() { return --value; }
+	int					GetValue() const { return value.load(); }
+	void				SetValue( int v ) { value.store( v ); }
 
-================================================================================================
-*/
+private:
+	std::atomic<int>	value;
+};
 
 
 /*
@@ -130,7 +148,7 @@ idParallelJobList_Threads
 static idCVar jobs_longJobMicroSec( "jobs_longJobMicroSec", "10000", CVAR_INTEGER, "print a warning for jobs that take more than this number of microseconds" );
 
 
-const static int		MAX_THREADS	= 32;
+const static int		MAX_JOB_THREADS	= 32;	// upper limit for the number of job threads (processing units)
 
 struct threadJobListState_t {
 								threadJobListState_t() :
@@ -159,8 +177,8 @@ struct threadStats_t {
 	uint64			startTime;
 	uint64			endTime;
 	uint64			waitTime;
-	uint64			threadExecTime[MAX_THREADS];
-	uint64			threadTotalTime[MAX_THREADS];
+	uint64			threadExecTime[MAX_JOB_THREADS];
+	uint64			threadTotalTime[MAX_JOB_THREADS];
 };
 
 class idParallelJobList_Threads {
@@ -194,6 +212,13 @@ public:
 	int						GetVersion() { return version.GetValue(); }
 
 	bool					WaitForOtherJobList();
+	bool					HasUnfetchedJobs( int listVersion ) const;
+
+	// job threads hold a reference while the list is queued on them or in their local state,
+	// the list may only be deleted once no thread references it anymore
+	void					AddThreadRef() { threadRefs.Increment(); }
+	void					ReleaseThreadRef() { threadRefs.Decrement(); }
+	bool					HasThreadRefs() const { return threadRefs.GetValue() > 0; }
 
 	//------------------------
 	// This is thread safe and called from the job threads.
@@ -228,11 +253,12 @@ private:
 		void *		data;
 		int			executed;
 	};
-	idList< job_t, TAG_JOBLIST >		jobList;
-	idList< idSysInterlockedInteger, TAG_JOBLIST >	signalJobCount;
+	idList< job_t>		jobList;
+	idList< idSysInterlockedInteger>	signalJobCount;
 	idSysInterlockedInteger				currentJob;
 	idSysInterlockedInteger				fetchLock;
 	idSysInterlockedInteger				numThreadsExecuting;
+	idSysInterlockedInteger				threadRefs;
 
 	threadStats_t						deferredThreadStats;
 	threadStats_t						threadStats;
@@ -272,9 +298,9 @@ idParallelJobList_Threads::idParallelJobList_Threads( jobListId_t id, jobListPri
 	this->maxJobs = maxJobs;
 	this->maxSyncs = maxSyncs;
 	jobList.AssureSize( maxJobs + maxSyncs * 2 + 1 );	// syncs go in as dummy jobs and one more to update the doneCount
-	jobList.SetNum( 0 );
+	jobList.SetNum( 0, false );
 	signalJobCount.AssureSize( maxSyncs + 1 );			// need one extra for submit
-	signalJobCount.SetNum( 0 );
+	signalJobCount.SetNum( 0, false );
 
 	memset( &deferredThreadStats, 0, sizeof( threadStats_t ) );
 	memset( &threadStats, 0, sizeof( threadStats_t ) );
@@ -326,7 +352,7 @@ ID_INLINE void idParallelJobList_Threads::AddJob( jobRun_t function, void * data
 		// print the quantity of each job type
 		for ( int i = 0; i < numRegisteredJobs; ++i ) {
 			if ( currentJobCount[ i ] > 0 ) {
-				idLib::Printf( "Job: %s, # %d", registeredJobs[ i ].name, currentJobCount[ i ] );
+				idLib::common->Printf( "Job: %s, # %d", registeredJobs[ i ].name, currentJobCount[ i ] );
 			}
 		}
 		idLib::Error( "Can't add job '%s', too many jobs %d", GetJobName( function ), jobList.Num() );
@@ -385,7 +411,7 @@ void idParallelJobList_Threads::Submit( idParallelJobList_Threads * waitForJobLi
 	memset( &deferredThreadStats, 0, sizeof( deferredThreadStats ) );
 	deferredThreadStats.numExecutedJobs = jobList.Num() - numSyncs * 2;
 	deferredThreadStats.numExecutedSyncs = numSyncs;
-	deferredThreadStats.submitTime = Sys_Microseconds();
+	deferredThreadStats.submitTime = Sys_GetTimeMicroseconds();
 	deferredThreadStats.startTime = 0;
 	deferredThreadStats.endTime = 0;
 	deferredThreadStats.waitTime = 0;
@@ -429,29 +455,30 @@ idParallelJobList_Threads::Wait
 void idParallelJobList_Threads::Wait() {
 	if ( jobList.Num() > 0 ) {
 		// don't lock up but return if the job list was never properly submitted
-		if ( !verify( !done && signalJobCount.Num() > 0 ) ) {
+		if ( done || signalJobCount.Num() <= 0 ) {
+			assert( false );
 			return;
 		}
 
 		bool waited = false;
-		uint64 waitStart = Sys_Microseconds();
+		uint64 waitStart = Sys_GetTimeMicroseconds();
 
 		while ( signalJobCount[signalJobCount.Num() - 1].GetValue() > 0 ) {
-			Sys_Yield();
+			std::this_thread::yield();
 			waited = true;
 		}
 		version.Increment();
 		while ( numThreadsExecuting.GetValue() > 0 ) {
-			Sys_Yield();
+			std::this_thread::yield();
 			waited = true;
 		}
 
-		jobList.SetNum( 0 );
-		signalJobCount.SetNum( 0 );
+		jobList.SetNum( 0, false );
+		signalJobCount.SetNum( 0, false );
 		numSyncs = 0;
 		lastSignalJob = 0;
 
-		uint64 waitEnd = Sys_Microseconds();
+		uint64 waitEnd = Sys_GetTimeMicroseconds();
 		deferredThreadStats.waitTime = waited ? ( waitEnd - waitStart ) : 0;
 	}
 	memcpy( & threadStats, & deferredThreadStats, sizeof( threadStats ) );
@@ -487,7 +514,7 @@ idParallelJobList_Threads::GetTotalProcessingTimeMicroSec
 */
 uint64 idParallelJobList_Threads::GetTotalProcessingTimeMicroSec() const {
 	uint64 total = 0;
-	for ( int unit = 0; unit < MAX_THREADS; unit++ ) {
+	for ( int unit = 0; unit < MAX_JOB_THREADS; unit++ ) {
 		total += threadStats.threadExecTime[unit];
 	}
 	return total;
@@ -500,7 +527,7 @@ idParallelJobList_Threads::GetTotalWastedTimeMicroSec
 */
 uint64 idParallelJobList_Threads::GetTotalWastedTimeMicroSec() const {
 	uint64 total = 0;
-	for ( int unit = 0; unit < MAX_THREADS; unit++ ) {
+	for ( int unit = 0; unit < MAX_JOB_THREADS; unit++ ) {
 		total += threadStats.threadTotalTime[unit] - threadStats.threadExecTime[unit];
 	}
 	return total;
@@ -512,7 +539,7 @@ idParallelJobList_Threads::GetUnitProcessingTimeMicroSec
 ========================
 */
 uint64 idParallelJobList_Threads::GetUnitProcessingTimeMicroSec( int unit ) const {
-	if ( unit < 0 || unit >= MAX_THREADS ) {
+	if ( unit < 0 || unit >= MAX_JOB_THREADS ) {
 		return 0;
 	}
 	return threadStats.threadExecTime[unit];
@@ -524,7 +551,7 @@ idParallelJobList_Threads::GetUnitWastedTimeMicroSec
 ========================
 */
 uint64 idParallelJobList_Threads::GetUnitWastedTimeMicroSec( int unit ) const {
-	if ( unit < 0 || unit >= MAX_THREADS ) {
+	if ( unit < 0 || unit >= MAX_JOB_THREADS ) {
 		return 0;
 	}
 	return threadStats.threadTotalTime[unit] - threadStats.threadExecTime[unit];
@@ -547,10 +574,10 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 		return RUN_DONE;
 	}
 
-	assert( threadNum < MAX_THREADS );
+	assert( threadNum < MAX_JOB_THREADS );
 
 	if ( deferredThreadStats.startTime == 0 ) {
-		deferredThreadStats.startTime = Sys_Microseconds();	// first time any thread is running jobs from this list
+		deferredThreadStats.startTime = Sys_GetTimeMicroseconds();	// first time any thread is running jobs from this list
 	}
 
 	int result = RUN_OK;
@@ -627,12 +654,12 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 
 		// execute the next job
 		{
-			uint64 jobStart = Sys_Microseconds();
+			uint64 jobStart = Sys_GetTimeMicroseconds();
 
 			jobList[state.nextJobIndex].function( jobList[state.nextJobIndex].data );
 			jobList[state.nextJobIndex].executed = 1;
 
-			uint64 jobEnd = Sys_Microseconds();
+			uint64 jobEnd = Sys_GetTimeMicroseconds();
 			deferredThreadStats.threadExecTime[threadNum] += jobEnd - jobStart;
 
 #ifndef _DEBUG
@@ -644,7 +671,7 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 					longJobData = jobList[state.nextJobIndex].data;
 					const char * jobName = GetJobName( jobList[state.nextJobIndex].function );
 					const char * jobListName = GetJobListName( GetId() );
-					idLib::Printf( "%1.1f milliseconds for a single '%s' job from job list %s on thread %d\n", longJobTime, jobName, jobListName, threadNum );
+					idLib::common->Printf( "%1.1f milliseconds for a single '%s' job from job list %s on thread %d\n", longJobTime, jobName, jobListName, threadNum );
 				}
 			}
 #endif
@@ -656,7 +683,7 @@ int idParallelJobList_Threads::RunJobsInternal( unsigned int threadNum, threadJo
 		if ( signalJobCount[state.signalIndex].Decrement() == 0 ) {
 			// if this was the very last job of the job list
 			if ( state.signalIndex == signalJobCount.Num() - 1 ) {
-				deferredThreadStats.endTime = Sys_Microseconds();
+				deferredThreadStats.endTime = Sys_GetTimeMicroseconds();
 				return ( result | RUN_DONE );
 			}
 		}
@@ -672,7 +699,7 @@ idParallelJobList_Threads::RunJobs
 ========================
 */
 int idParallelJobList_Threads::RunJobs( unsigned int threadNum, threadJobListState_t & state, bool singleJob ) {
-	uint64 start = Sys_Microseconds();
+	uint64 start = Sys_GetTimeMicroseconds();
 
 	numThreadsExecuting.Increment();
 
@@ -680,7 +707,7 @@ int idParallelJobList_Threads::RunJobs( unsigned int threadNum, threadJobListSta
 
 	numThreadsExecuting.Decrement();
 
-	deferredThreadStats.threadTotalTime[threadNum] += Sys_Microseconds() - start;
+	deferredThreadStats.threadTotalTime[threadNum] += Sys_GetTimeMicroseconds() - start;
 
 	return result;
 }
@@ -699,6 +726,21 @@ bool idParallelJobList_Threads::WaitForOtherJobList() {
 	return false;
 }
 
+/*
+========================
+idParallelJobList_Threads::HasUnfetchedJobs
+
+Used by idle job threads to decide whether a job list that was
+handed to another thread is worth stealing work from.
+========================
+*/
+bool idParallelJobList_Threads::HasUnfetchedJobs( int listVersion ) const {
+	if ( done || listVersion != version.GetValue() ) {
+		return false;
+	}
+	return currentJob.GetValue() < jobList.Num();
+}
+
 /*
 ================================================================================================
 
@@ -714,7 +756,7 @@ idParallelJobList::idParallelJobList
 */
 idParallelJobList::idParallelJobList( jobListId_t id, jobListPriority_t priority, unsigned int maxJobs, unsigned int maxSyncs, const idColor * color ) {
 	assert( priority > JOBLIST_PRIORITY_NONE );
-	this->jobListThreads = new (TAG_JOBLIST) idParallelJobList_Threads( id, priority, maxJobs, maxSyncs );
+	this->jobListThreads = new idParallelJobList_Threads( id, priority, maxJobs, maxSyncs );
 	this->color = color;
 }
 
@@ -905,33 +947,49 @@ idJobThread
 ================================================================================================
 */
 
-const int JOB_THREAD_STACK_SIZE		= 256 * 1024;	// same size as the SPU local store
-
 struct threadJobList_t {
 	idParallelJobList_Threads *	jobList;
 	int							version;
 };
 
 static idCVar jobs_prioritize( "jobs_prioritize", "1", CVAR_BOOL | CVAR_NOCHEAT, "prioritize job lists" );
+static idCVar jobs_stealing( "jobs_stealing", "1", CVAR_BOOL | CVAR_NOCHEAT, "allow idle job threads to help with job lists that were handed to other job threads" );
+
+// implemented by the job manager below
+bool StealJobList( threadJobListState_t & state );
 
-class idJobThread : public idSysThread {
+class idJobThread {
 public:
 								idJobThread();
 								~idJobThread();
 
-	void						Start( core_t core, unsigned int threadNum );
+	void						Start( unsigned int threadNum );
+	void						StopThread();
+	bool						IsRunning() const { return thread.joinable(); }
 
 	void						AddJobList( idParallelJobList_Threads * jobList );
+	// wakes up the thread if it is waiting for work
+	void						SignalWork();
+
+	unsigned int				GetNumStolenJobLists() const { return numStolenJobLists; }
 
 private:
 	threadJobList_t				jobLists[MAX_JOBLISTS];	// cyclic buffer with job lists
-	unsigned int				firstJobList;			// index of the last job list the thread grabbed
-	unsigned int				lastJobList;			// index where the next job list to work on will be added
-	idSysMutex					addJobMutex;
+	std::atomic<unsigned int>	firstJobList;			// index of the last job list the thread grabbed
+	std::atomic<unsigned int>	lastJobList;			// index where the next job list to work on will be added
+	std::mutex					addJobMutex;
 
 	unsigned int				threadNum;
+	std::atomic<unsigned int>	numStolenJobLists;		// job lists this thread picked up from other threads
+
+	std::thread					thread;
+	std::mutex					signalMutex;
+	std::condition_variable		signalWork;
+	bool						moreWorkToDo;
+	std::atomic<bool>			isTerminating;
 
-	virtual int					Run();
+	void						ThreadProc();
+	int							Run();
 };
 
 /*
@@ -942,7 +1000,10 @@ idJobThread::idJobThread
 idJobThread::idJobThread() :
 		firstJobList( 0 ),
 		lastJobList( 0 ),
-		threadNum( 0 ) {
+		threadNum( 0 ),
+		numStolenJobLists( 0 ),
+		moreWorkToDo( false ),
+		isTerminating( false ) {
 }
 
 /*
@@ -951,6 +1012,7 @@ idJobThread::~idJobThread
 ========================
 */
 idJobThread::~idJobThread() {
+	StopThread();
 }
 
 /*
@@ -958,9 +1020,30 @@ idJobThread::~idJobThread() {
 idJobThread::Start
 ========================
 */
-void idJobThread::Start( core_t core, unsigned int threadNum ) {
+void idJobThread::Start( unsigned int threadNum ) {
+	if ( IsRunning() ) {
+		return;
+	}
 	this->threadNum = threadNum;
-	StartWorkerThread( va( "JobListProcessor_%d", threadNum ), core, THREAD_NORMAL, JOB_THREAD_STACK_SIZE );
+	isTerminating = false;
+	thread = std::thread( &idJobThread::ThreadProc, this );
+}
+
+/*
+========================
+idJobThread::StopThread
+========================
+*/
+void idJobThread::StopThread() {
+	if ( !IsRunning() ) {
+		return;
+	}
+	{
+		std::unique_lock< std::mutex > lock( signalMutex );
+		isTerminating = true;
+		signalWork.notify_one();
+	}
+	thread.join();
 }
 
 /*
@@ -970,16 +1053,49 @@ idJobThread::AddJobList
 */
 void idJobThread::AddJobList( idParallelJobList_Threads * jobList ) {
 	// must lock because multiple threads may try to add new job lists at the same time
-	addJobMutex.Lock();
+	std::unique_lock< std::mutex > lock( addJobMutex );
 	// wait until there is space available because in rare cases multiple versions of the same job lists may still be queued 
 	while( lastJobList - firstJobList >= MAX_JOBLISTS ) {
-		Sys_Yield();
+		std::this_thread::yield();
 	}
 	assert( lastJobList - firstJobList < MAX_JOBLISTS );
+	jobList->AddThreadRef();
 	jobLists[lastJobList & ( MAX_JOBLISTS - 1 )].jobList = jobList;
 	jobLists[lastJobList & ( MAX_JOBLISTS - 1 )].version = jobList->GetVersion();
 	lastJobList++;
-	addJobMutex.Unlock();
+}
+
+/*
+========================
+idJobThread::SignalWork
+========================
+*/
+void idJobThread::SignalWork() {
+	std::unique_lock< std::mutex > lock( signalMutex );
+	moreWorkToDo = true;
+	signalWork.notify_one();
+}
+
+/*
+========================
+idJobThread::ThreadProc
+========================
+*/
+void idJobThread::ThreadProc() {
+	while ( true ) {
+		{ // lock scope
+			std::unique_lock< std::mutex > lock( signalMutex );
+			while ( !moreWorkToDo && !isTerminating ) {
+				signalWork.wait( lock );
+			}
+			if ( isTerminating ) {
+				return;
+			}
+			moreWorkToDo = false;
+		}
+
+		Run();
+	}
 }
 
 /*
@@ -992,7 +1108,7 @@ int idJobThread::Run() {
 	int numJobLists = 0;
 	int lastStalledJobList = -1;
 
-	while ( !IsTerminating() ) {
+	while ( !isTerminating ) {
 
 		// fetch any new job lists and add them to the local list
 		if ( numJobLists < MAX_JOBLISTS && firstJobList < lastJobList ) {
@@ -1005,7 +1121,13 @@ int idJobThread::Run() {
 			firstJobList++;
 		}
 		if ( numJobLists == 0 ) {
-			break;
+			// out of work, so rather than going to sleep try to help out
+			// with a job list that was handed to another thread
+			if ( !jobs_stealing.GetBool() || !StealJobList( threadJobListState[0] ) ) {
+				break;
+			}
+			numJobLists = 1;
+			numStolenJobLists++;
 		}
 
 		int currentJobList = 0;
@@ -1039,6 +1161,7 @@ int idJobThread::Run() {
 
 		if ( ( result & idParallelJobList_Threads::RUN_DONE ) != 0 ) {
 			// done with this job list so remove it from the local list
+			threadJobListState[currentJobList].jobList->ReleaseThreadRef();
 			for ( int i = currentJobList; i < numJobLists - 1; i++ ) {
 				threadJobListState[i] = threadJobListState[i + 1];
 			}
@@ -1048,7 +1171,7 @@ int idJobThread::Run() {
 			// yield when stalled on the same job list again without making any progress
 			if ( currentJobList == lastStalledJobList ) {
 				if ( ( result & idParallelJobList_Threads::RUN_PROGRESS ) == 0 ) {
-					Sys_Yield();
+					std::this_thread::yield();
 				}
 			}
 			lastStalledJobList = currentJobList;
@@ -1056,6 +1179,9 @@ int idJobThread::Run() {
 			lastStalledJobList = -1;
 		}
 	}
+	for ( int i = 0; i < numJobLists; i++ ) {
+		threadJobListState[i].jobList->ReleaseThreadRef();
+	}
 	return 0;
 }
 
@@ -1064,46 +1190,17 @@ int idJobThread::Run() {
 
 idParallelJobManagerLocal
 
+The job threads form a work-stealing pool: a submitted job list is
+queued on a number of threads (starting at a rotating offset so that
+concurrent job lists spread over the pool), and any thread that runs
+dry before going back to sleep picks up recently submitted job lists
+that still have unfetched jobs. Jobs themselves are fetched from the
+shared list one at a time, so the load balances on a per-job level.
+
 ================================================================================================
 */
 
-extern void Sys_CPUCount( int & logicalNum, int & coreNum, int & packageNum );
-
-
-// WINDOWS LOGICAL PROCESSOR LIMITS:
-//
-// http://download.microsoft.com/download/5/7/7/577a5684-8a83-43ae-9272-ff260a9c20e2/Hyper-thread_Windows.doc
-//
-//											Physical	Logical (Cores + HT)
-// Windows XP Home Edition					1			2 
-// Windows XP Professional					2			4 
-// Windows Server 2003, Standard Edition	4			8 
-// Windows Server 2003, Enterprise Edition	8			16 
-// Windows Server 2003, Datacenter Edition	32			32
-//
-// Windows Vista							?			?
-//
-// Windows 7 Starter						1			32/64
-// Windows 7 Home Basic						1			32/64
-// Windows 7 Professional					2			32/64
-//
-//
-// Hyperthreading is not dead yet.  Intel's Core i7 Processor is quad-core with HT for 8 logicals.
-
-// DOOM3: We don't have that many jobs, so just set this fairly low so we don't spin up a ton of idle threads
-#define MAX_JOB_THREADS		2
-#define NUM_JOB_THREADS		"2"
-#define JOB_THREAD_CORES	{	CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
-								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
-								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
-								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
-								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
-								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
-								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY,	\
-								CORE_ANY, CORE_ANY, CORE_ANY, CORE_ANY }
-
-
-idCVar jobs_numThreads( "jobs_numThreads", NUM_JOB_THREADS, CVAR_INTEGER | CVAR_NOCHEAT, "number of threads used to crunch through jobs", 0, MAX_JOB_THREADS );
+idCVar jobs_numThreads( "jobs_numThreads", "-1", CVAR_INTEGER | CVAR_NOCHEAT, "number of threads used to crunch through jobs, -1 to use one less than the number of logical cores, 0 to run jobs on the submitting thread", -1, MAX_JOB_THREADS );
 
 class idParallelJobManagerLocal : public idParallelJobManager {
 public:
@@ -1124,14 +1221,24 @@ public:
 	virtual void				WaitForAllJobLists();
 
 	void						Submit( idParallelJobList_Threads * jobList, int parallelism );
+	bool						StealJobList( threadJobListState_t & state );
+
+	void						PrintJobLists() const;
 
 private:
 	idJobThread						threads[MAX_JOB_THREADS];
+	int								numStartedThreads;
 	unsigned int					maxThreads;
-	int								numPhysicalCpuCores;
+	unsigned int					nextThread;				// first thread for the next submitted job list
 	int								numLogicalCpuCores;
-	int								numCpuPackages;
 	idStaticList< idParallelJobList *, MAX_JOBLISTS >	jobLists;
+	mutable std::mutex				jobListsMutex;			// job lists are allocated and freed by several threads
+
+	std::mutex						stealMutex;
+	threadJobList_t					stealableJobLists[MAX_JOBLISTS];	// cyclic buffer of recently submitted job lists
+	unsigned int					nextStealableJobList;
+
+	void						UpdateMaxThreads();
 };
 
 idParallelJobManagerLocal parallelJobManagerLocal;
@@ -1146,22 +1253,41 @@ void SubmitJobList( idParallelJobList_Threads * jobList, int parallelism ) {
 	parallelJobManagerLocal.Submit( jobList, parallelism );
 }
 
+/*
+========================
+StealJobList
+========================
+*/
+bool StealJobList( threadJobListState_t & state ) {
+	return parallelJobManagerLocal.StealJobList( state );
+}
+
 /*
 ========================
 idParallelJobManagerLocal::Init
 ========================
 */
 void idParallelJobManagerLocal::Init() {
-	// on consoles this will have specific cores for the threads, but on PC they will all be CORE_ANY
-	core_t cores[] = JOB_THREAD_CORES;
-	assert( sizeof( cores ) / sizeof( cores[0] ) >= MAX_JOB_THREADS );
+	numLogicalCpuCores = std::thread::hardware_concurrency();
+	if ( numLogicalCpuCores <= 0 ) {
+		// the number of cores is not computable on this platform
+		numLogicalCpuCores = 1;
+	}
 
-	for ( int i = 0; i < MAX_JOB_THREADS; i++ ) {
-		threads[i].Start( cores[i], i );
+	// one thread per logical core, the actual number of threads used is limited by jobs_numThreads
+	numStartedThreads = idMath::ClampInt( 1, MAX_JOB_THREADS, numLogicalCpuCores );
+	for ( int i = 0; i < numStartedThreads; i++ ) {
+		threads[i].Start( i );
 	}
-	maxThreads = jobs_numThreads.GetInteger();
+	nextThread = 0;
+
+	memset( stealableJobLists, 0, sizeof( stealableJobLists ) );
+	nextStealableJobList = 0;
 
-	Sys_CPUCount( numPhysicalCpuCores, numLogicalCpuCores, numCpuPackages );
+	jobs_numThreads.SetModified();
+	UpdateMaxThreads();
+
+	common->Printf( "Job system: %d logical cores, %d job threads, %u used by default\n", numLogicalCpuCores, numStartedThreads, maxThreads );
 }
 
 /*
@@ -1170,9 +1296,30 @@ idParallelJobManagerLocal::Shutdown
 ========================
 */
 void idParallelJobManagerLocal::Shutdown() {
+	WaitForAllJobLists();
 	for ( int i = 0; i < MAX_JOB_THREADS; i++ ) {
 		threads[i].StopThread();
 	}
+	numStartedThreads = 0;
+	maxThreads = 0;
+}
+
+/*
+========================
+idParallelJobManagerLocal::UpdateMaxThreads
+========================
+*/
+void idParallelJobManagerLocal::UpdateMaxThreads() {
+	if ( !jobs_numThreads.IsModified() ) {
+		return;
+	}
+	if ( jobs_numThreads.GetInteger() < 0 ) {
+		// leave a core for the thread that submits the jobs
+		maxThreads = idMath::ClampInt( 1, numStartedThreads, numLogicalCpuCores - 1 );
+	} else {
+		maxThreads = idMath::ClampInt( 0, numStartedThreads, jobs_numThreads.GetInteger() );
+	}
+	jobs_numThreads.ClearModified();
 }
 
 /*
@@ -1181,12 +1328,12 @@ idParallelJobManagerLocal::AllocJobList
 ========================
 */
 idParallelJobList * idParallelJobManagerLocal::AllocJobList( jobListId_t id, jobListPriority_t priority, unsigned int maxJobs, unsigned int maxSyncs, const idColor * color ) {
-	for ( int i = 0; i < jobLists.Num(); i++ ) {
-		if ( jobLists[i]->GetId() == id ) {
-			// idStudio may cause job lists to be allocated multiple times
-		}
+	std::unique_lock< std::mutex > lock( jobListsMutex );
+	// the static list would drop it silently and FreeJobList could no longer find it
+	if ( jobLists.Num() >= jobLists.Max() ) {
+		idLib::Error( "Can't allocate job list %d, too many job lists %d", id, jobLists.Num() );
 	}
-	idParallelJobList * jobList = new (TAG_JOBLIST) idParallelJobList( id, priority, maxJobs, maxSyncs, color );
+	idParallelJobList * jobList = new idParallelJobList( id, priority, maxJobs, maxSyncs, color );
 	jobLists.Append( jobList );
 	return jobList;
 }
@@ -1200,15 +1347,28 @@ void idParallelJobManagerLocal::FreeJobList( idParallelJobList * jobList ) {
 	if ( jobList == NULL ) {
 		return;
 	}
-	// wait for all job threads to finish because job list deletion is not thread safe
-	for ( unsigned int i = 0; i < maxThreads; i++ ) {
-		threads[i].WaitForThread();
+	// make sure no thread can steal the job list anymore
+	{
+		std::unique_lock< std::mutex > lock( stealMutex );
+		for ( int i = 0; i < MAX_JOBLISTS; i++ ) {
+			if ( stealableJobLists[i].jobList == jobList->jobListThreads ) {
+				stealableJobLists[i].jobList = NULL;
+			}
+		}
 	}
-	int index = jobLists.FindIndex( jobList );
-	assert( index >= 0 && jobLists[index] == jobList );
-	jobLists[index]->Wait();
-	delete jobLists[index];
-	jobLists.RemoveIndexFast( index );
+	jobList->Wait();
+	// only wait for the job threads that still have this list queued or are about to drop it,
+	// the other threads keep running whatever they are busy with
+	while ( jobList->jobListThreads->HasThreadRefs() ) {
+		std::this_thread::yield();
+	}
+	{
+		std::unique_lock< std::mutex > lock( jobListsMutex );
+		int index = jobLists.FindIndex( jobList );
+		assert( index >= 0 && jobLists[index] == jobList );
+		jobLists.RemoveIndex( index );
+	}
+	delete jobList;
 }
 
 /*
@@ -1217,6 +1377,7 @@ idParallelJobManagerLocal::GetNumJobLists
 ========================
 */
 int idParallelJobManagerLocal::GetNumJobLists() const {
+	std::unique_lock< std::mutex > lock( jobListsMutex );
 	return jobLists.Num();
 }
 
@@ -1226,6 +1387,7 @@ idParallelJobManagerLocal::GetNumFreeJobLists
 ========================
 */
 int idParallelJobManagerLocal::GetNumFreeJobLists() const {
+	std::unique_lock< std::mutex > lock( jobListsMutex );
 	return MAX_JOBLISTS - jobLists.Num();
 }
 
@@ -1235,6 +1397,7 @@ idParallelJobManagerLocal::GetJobList
 ========================
 */
 idParallelJobList * idParallelJobManagerLocal::GetJobList( int index ) {
+	std::unique_lock< std::mutex > lock( jobListsMutex );
 	return jobLists[index];
 }
 
@@ -1244,6 +1407,7 @@ idParallelJobManagerLocal::GetNumProcessingUnits
 ========================
 */
 int idParallelJobManagerLocal::GetNumProcessingUnits() {
+	UpdateMaxThreads();
 	return maxThreads;
 }
 
@@ -1254,6 +1418,7 @@ idParallelJobManagerLocal::WaitForAllJobLists
 */
 void idParallelJobManagerLocal::WaitForAllJobLists() {
 	// wait for all job lists to complete
+	std::unique_lock< std::mutex > lock( jobListsMutex );
 	for ( int i = 0; i < jobLists.Num(); i++ ) {
 		jobLists[i]->Wait();
 	}
@@ -1265,21 +1430,18 @@ idParallelJobManagerLocal::Submit
 ========================
 */
 void idParallelJobManagerLocal::Submit( idParallelJobList_Threads * jobList, int parallelism ) {
-	if ( jobs_numThreads.IsModified() ) {
-		maxThreads = idMath::ClampInt( 0, MAX_JOB_THREADS, jobs_numThreads.GetInteger() );
-		jobs_numThreads.ClearModified();
-	}
+	UpdateMaxThreads();
 
 	// determine the number of threads to use
 	int numThreads = maxThreads;
 	if ( parallelism == JOBLIST_PARALLELISM_DEFAULT ) {
 		numThreads = maxThreads;
 	} else if ( parallelism == JOBLIST_PARALLELISM_MAX_CORES ) {
-		numThreads = numLogicalCpuCores;
+		numThreads = idMath::ClampInt( 0, numStartedThreads, numLogicalCpuCores );
 	} else if ( parallelism == JOBLIST_PARALLELISM_MAX_THREADS ) {
-		numThreads = MAX_JOB_THREADS;
-	} else if ( parallelism > MAX_JOB_THREADS ) {
-		numThreads = MAX_JOB_THREADS;
+		numThreads = numStartedThreads;
+	} else if ( parallelism > numStartedThreads ) {
+		numThreads = numStartedThreads;
 	} else {
 		numThreads = parallelism;
 	}
@@ -1290,8 +1452,221 @@ void idParallelJobManagerLocal::Submit( idParallelJobList_Threads * jobList, int
 		return;
 	}
 
+	// make the job list visible to threads that run out of work
+	{
+		std::unique_lock< std::mutex > lock( stealMutex );
+		threadJobList_t & stealable = stealableJobLists[nextStealableJobList & ( MAX_JOBLISTS - 1 )];
+		stealable.jobList = jobList;
+		stealable.version = jobList->GetVersion();
+		nextStealableJobList++;
+	}
+
+	const unsigned int firstThread = nextThread++;
 	for ( int i = 0; i < numThreads; i++ ) {
-		threads[i].AddJobList( jobList );
-		threads[i].SignalWork();
+		idJobThread & thread = threads[( firstThread + i ) % numStartedThreads];
+		thread.AddJobList( jobList );
+		thread.SignalWork();
+	}
+}
+
+/*
+========================
+idParallelJobManagerLocal::StealJobList
+
+Called from a job thread that has run out of job lists. Looks for
+the most recently submitted job list that still has jobs nobody
+has fetched yet.
+========================
+*/
+bool idParallelJobManagerLocal::StealJobList( threadJobListState_t & state ) {
+	std::unique_lock< std::mutex > lock( stealMutex );
+	for ( int i = 1; i <= MAX_JOBLISTS; i++ ) {
+		const threadJobList_t & stealable = stealableJobLists[( nextStealableJobList - i ) & ( MAX_JOBLISTS - 1 )];
+		if ( stealable.jobList == NULL || !stealable.jobList->HasUnfetchedJobs( stealable.version ) ) {
+			continue;
+		}
+		state.jobList = stealable.jobList;
+		state.version = stealable.version;
+		state.signalIndex = 0;
+		state.lastJobIndex = 0;
+		state.nextJobIndex = -1;
+		stealable.jobList->AddThreadRef();
+		return true;
 	}
-}
\ No newline at end of file
+	return false;
+}
+
+/*
+========================
+idParallelJobManagerLocal::PrintJobLists
+========================
+*/
+void idParallelJobManagerLocal::PrintJobLists() const {
+	common->Printf( "%d logical cores, %d job threads started, %u used by default\n", numLogicalCpuCores, numStartedThreads, maxThreads );
+	for ( int i = 0; i < numStartedThreads; i++ ) {
+		common->Printf( "  thread %2d: %u job lists stolen\n", i, threads[i].GetNumStolenJobLists() );
+	}
+
+	std::unique_lock< std::mutex > lock( jobListsMutex );
+	common->Printf( "%d job lists allocated, timings are from the last completed run:\n", jobLists.Num() );
+	for ( int i = 0; i < jobLists.Num(); i++ ) {
+		const idParallelJobList * jobList = jobLists[i];
+		const uint64 submitTime = jobList->GetSubmitTimeMicroSec();
+		const uint64 finishTime = jobList->GetFinishTimeMicroSec();
+		common->Printf( "%-26s %5u jobs %3u syncs: %6llu us latency, %6llu us wait, %6llu us processing, %6llu us wasted\n",
+			GetJobListName( jobList->GetId() ), jobList->GetNumExecutedJobs(), jobList->GetNumSyncs(),
+			( finishTime > submitTime ) ? finishTime - submitTime : 0ull, jobList->GetWaitTimeMicroSec(),
+			jobList->GetTotalProcessingTimeMicroSec(), jobList->GetTotalWastedTimeMicroSec() );
+		for ( int unit = 0; unit < MAX_JOB_THREADS; unit++ ) {
+			const uint64 processing = jobList->GetUnitProcessingTimeMicroSec( unit );
+			const uint64 wasted = jobList->GetUnitWastedTimeMicroSec( unit );
+			if ( processing == 0 && wasted == 0 ) {
+				continue;
+			}
+			common->Printf( "    unit %2d: %6llu us processing, %6llu us wasted\n", unit, processing, wasted );
+		}
+	}
+}
+
+/*
+========================
+idParallelJobManager::ListJobs_f
+========================
+*/
+void idParallelJobManager::ListJobs_f( const idCmdArgs &args ) {
+	parallelJobManagerLocal.PrintJobLists();
+}
+
+/*
+================================================================================================
+
+	Job system test
+
+================================================================================================
+*/
+
+struct testJobChunk_t {
+	const float *	values;
+	int				numValues;
+	double			sum;
+};
+
+struct testJobReduce_t {
+	const testJobChunk_t *	chunks;
+	int						numChunks;
+	double					total;
+};
+
+/*
+========================
+TestJob_SumChunk
+========================
+*/
+static void TestJob_SumChunk( testJobChunk_t * chunk ) {
+	double sum = 0.0;
+	for ( int i = 0; i < chunk->numValues; i++ ) {
+		sum += idMath::Sqrt( chunk->values[i] ) * idMath::Sin( chunk->values[i] );
+	}
+	chunk->sum = sum;
+}
+
+REGISTER_PARALLEL_JOB( TestJob_SumChunk, "TestJob_SumChunk" );
+
+/*
+========================
+TestJob_Reduce
+
+Runs after a sync point, so all chunk sums must be available.
+========================
+*/
+static void TestJob_Reduce( testJobReduce_t * reduce ) {
+	double total = 0.0;
+	for ( int i = 0; i < reduce->numChunks; i++ ) {
+		total += reduce->chunks[i].sum;
+	}
+	reduce->total = total;
+}
+
+REGISTER_PARALLEL_JOB( TestJob_Reduce, "TestJob_Reduce" );
+
+/*
+========================
+idParallelJobManager::Test_f
+========================
+*/
+void idParallelJobManager::Test_f( const idCmdArgs &args ) {
+	const int NUM_CHUNKS = 512;
+	const int NUM_VALUES_PER_CHUNK = 4096;
+	const int NUM_RUNS = 8;
+
+	idRandom random( 0 );
+	idList< float > values;
+	values.SetNum( NUM_CHUNKS * NUM_VALUES_PER_CHUNK );
+	for ( int i = 0; i < values.Num(); i++ ) {
+		values[i] = random.RandomFloat() * 100.0f;
+	}
+
+	idList< testJobChunk_t > chunks;
+	chunks.SetNum( NUM_CHUNKS );
+	for ( int i = 0; i < NUM_CHUNKS; i++ ) {
+		chunks[i].values = values.Ptr() + i * NUM_VALUES_PER_CHUNK;
+		chunks[i].numValues = NUM_VALUES_PER_CHUNK;
+		chunks[i].sum = 0.0;
+	}
+	testJobReduce_t reduce;
+	reduce.chunks = chunks.Ptr();
+	reduce.numChunks = NUM_CHUNKS;
+
+	// reference result on this thread
+	uint64 serialTime = ~0ull;
+	double reference = 0.0;
+	for ( int run = 0; run < NUM_RUNS; run++ ) {
+		uint64 start = Sys_GetTimeMicroseconds();
+		for ( int i = 0; i < NUM_CHUNKS; i++ ) {
+			TestJob_SumChunk( &chunks[i] );
+		}
+		TestJob_Reduce( &reduce );
+		serialTime = Min( serialTime, Sys_GetTimeMicroseconds() - start );
+		reference = reduce.total;
+	}
+
+	idParallelJobList * jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, NUM_CHUNKS + 1, 1, NULL );
+
+	bool ok = true;
+	uint64 parallelTime = ~0ull;
+	for ( int run = 0; run < NUM_RUNS; run++ ) {
+		for ( int i = 0; i < NUM_CHUNKS; i++ ) {
+			chunks[i].sum = 0.0;
+		}
+		reduce.total = 0.0;
+
+		uint64 start = Sys_GetTimeMicroseconds();
+		for ( int i = 0; i < NUM_CHUNKS; i++ ) {
+			jobList->AddJob( (jobRun_t)TestJob_SumChunk, &chunks[i] );
+		}
+		jobList->InsertSyncPoint( SYNC_SIGNAL );
+		jobList->InsertSyncPoint( SYNC_SYNCHRONIZE );
+		jobList->AddJob( (jobRun_t)TestJob_Reduce, &reduce );
+		jobList->Submit();
+		jobList->Wait();
+		parallelTime = Min( parallelTime, Sys_GetTimeMicroseconds() - start );
+
+		// the chunks are summed in the same order as above, so the result must be bit exact
+		if ( reduce.total != reference || jobList->GetNumExecutedJobs() != NUM_CHUNKS + 1 ) {
+			ok = false;
+		}
+	}
+
+	common->Printf( "%d jobs in %d runs on %d job threads: %s\n", NUM_CHUNKS + 1, NUM_RUNS, parallelJobManager->GetNumProcessingUnits(), ok ? "ok" : S_COLOR_RED"X" );
+	common->Printf( "   serial %6llu us, parallel %6llu us (best of %d)\n", serialTime, parallelTime, NUM_RUNS );
+	common->Printf( "   last run: %6llu us processing, %6llu us wasted, %6llu us waited\n",
+		jobList->GetTotalProcessingTimeMicroSec(), jobList->GetTotalWastedTimeMicroSec(), jobList->GetWaitTimeMicroSec() );
+	for ( int unit = 0; unit < MAX_JOB_THREADS; unit++ ) {
+		const uint64 processing = jobList->GetUnitProcessingTimeMicroSec( unit );
+		if ( processing != 0 ) {
+			common->Printf( "   unit %2d: %6llu us processing, %6llu us wasted\n", unit, processing, jobList->GetUnitWastedTimeMicroSec( unit ) );
+		}
+	}
+
+	parallelJobManager->FreeJobList( jobList );
+}
@@ -70,8 +70,6 @@ enum jobListParallelism_t {
 #define assert_spu_local_store( ptr )
 #define assert_not_spu_local_store( ptr )
 
-typedef unsigned long long	uint64;
-
 /*
 ================================================
 idParallelJobList
@@ -159,6 +157,11 @@ public:
 	virtual int					GetNumProcessingUnits() = 0;
 
 	virtual void				WaitForAllJobLists() = 0;
+
+	// prints the timing statistics of all allocated job lists
+	static void					ListJobs_f( const class idCmdArgs &args );
+	// runs synthetic job lists through the job threads and checks the results
+	static void					Test_f( const class idCmdArgs &args );
 };
 
 extern idParallelJobManager *	parallelJobManager;
@@ -2937,6 +2937,116 @@ void TestOverlayPointCull( void ) {
 	PrintClocks( va( "   simd->OverlayPointCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestCullByFrustum
+============
+*/
+void TestCullByFrustum( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idPlane planes[6] );
+	ALIGN16( idDrawVert drawVerts[COUNT] );
+	ALIGN16( byte cullBits1[COUNT] );
+	ALIGN16( byte cullBits2[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < 6; i++ ) {
+		idVec3 normal( srnd.CRandomFloat(), srnd.CRandomFloat(), srnd.CRandomFloat() );
+		normal.Normalize();
+		planes[i].SetNormal( normal );
+		planes[i][3] = srnd.CRandomFloat() * 5.0f;
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			drawVerts[i].xyz[j] = srnd.CRandomFloat() * 10.0f;
+		}
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->CullByFrustum( drawVerts, COUNT, planes, cullBits1, 0.1f );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->CullByFrustum()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->CullByFrustum( drawVerts, COUNT, planes, cullBits2, 0.1f );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( cullBits1[i] != cullBits2[i] ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->CullByFrustum() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
+/*
+============
+TestCullByFrustum2
+============
+*/
+void TestCullByFrustum2( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idPlane planes[6] );
+	ALIGN16( idDrawVert drawVerts[COUNT] );
+	ALIGN16( unsigned short cullBits1[COUNT] );
+	ALIGN16( unsigned short cullBits2[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < 6; i++ ) {
+		idVec3 normal( srnd.CRandomFloat(), srnd.CRandomFloat(), srnd.CRandomFloat() );
+		normal.Normalize();
+		planes[i].SetNormal( normal );
+		planes[i][3] = srnd.CRandomFloat() * 5.0f;
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			drawVerts[i].xyz[j] = srnd.CRandomFloat() * 10.0f;
+		}
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->CullByFrustum2( drawVerts, COUNT, planes, cullBits1, 0.1f );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->CullByFrustum2()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->CullByFrustum2( drawVerts, COUNT, planes, cullBits2, 0.1f );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( cullBits1[i] != cullBits2[i] ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->CullByFrustum2() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestDeriveTriPlanes
@@ -4117,6 +4227,12 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 				return;
 			}
 			p_simd = new idSIMD_SSE3();
+		} else if ( idStr::Icmp( argString, "AVX" ) == 0 ) {
+			if ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) || !( cpuid & CPUID_SSE2 ) || !( cpuid & CPUID_SSE3 ) || !( cpuid & CPUID_AVX ) ) {
+				common->Printf( "CPU does not support MMX & SSE & SSE2 & SSE3 & AVX\n" );
+				return;
+			}
+			p_simd = new idSIMD_AVX();
 		/*} else if ( idStr::Icmp( argString, "AltiVec" ) == 0 ) {
 			if ( !( cpuid & CPUID_ALTIVEC ) ) {
 				common->Printf( "CPU does not support AltiVec\n" );
@@ -4125,7 +4241,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 			p_simd = new idSIMD_AltiVec();*/
 		} else {
 			//common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AltiVec\n" );
-			common->Printf( "invalid argument, use: MMX, SSE, SSE2, SSE3\n" );
+			common->Printf( "invalid argument, use: MMX, SSE, SSE2, SSE3, AVX\n" );
 			return;
 		}
 	}
@@ -4172,6 +4288,8 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	TestTracePointCull();
 	TestDecalPointCull();
 	TestOverlayPointCull();
+	TestCullByFrustum();
+	TestCullByFrustum2();
 	TestDeriveTriPlanes();
 	TestDeriveTangents();
 	TestDeriveUnsmoothedTangents();
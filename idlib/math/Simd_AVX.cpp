@@ -39,41 +39,110 @@ const char * idSIMD_AVX::GetName( void ) const {
 	return "MMX & SSE & SSE2 & SSE3 & AVX";
 }
 
+/*
+============
+LoadVertexesSoA
+
+Transposes the positions of eight vertexes into x, y and z registers
+============
+*/
+static ID_INLINE void ALLOW_AVX LoadVertexesSoA( const idDrawVert *verts, __m256 &vX, __m256 &vY, __m256 &vZ ) {
+	// the loads include st[0] after xyz, which ends up in the w registers and is ignored
+	__m128 x0 = _mm_loadu_ps( verts[0].xyz.ToFloatPtr() );
+	__m128 y0 = _mm_loadu_ps( verts[1].xyz.ToFloatPtr() );
+	__m128 z0 = _mm_loadu_ps( verts[2].xyz.ToFloatPtr() );
+	__m128 w0 = _mm_loadu_ps( verts[3].xyz.ToFloatPtr() );
+	__m128 x1 = _mm_loadu_ps( verts[4].xyz.ToFloatPtr() );
+	__m128 y1 = _mm_loadu_ps( verts[5].xyz.ToFloatPtr() );
+	__m128 z1 = _mm_loadu_ps( verts[6].xyz.ToFloatPtr() );
+	__m128 w1 = _mm_loadu_ps( verts[7].xyz.ToFloatPtr() );
+	_MM_TRANSPOSE4_PS( x0, y0, z0, w0 );
+	_MM_TRANSPOSE4_PS( x1, y1, z1, w1 );
+	vX = _mm256_insertf128_ps( _mm256_castps128_ps256( x0 ), x1, 1 );
+	vY = _mm256_insertf128_ps( _mm256_castps128_ps256( y0 ), y1, 1 );
+	vZ = _mm256_insertf128_ps( _mm256_castps128_ps256( z0 ), z1, 1 );
+}
+
+// hidden under this cvar for now
+static idCVar com_tempAllowAVX( "com_tempAllowAVX", "0", CVAR_SYSTEM, "to be removed before release" );
+
+/*
+============
+idSIMD_AVX::CullByFrustum
+
+Eight vertexes at a time, see idSIMD_SSE::CullByFrustum
+============
+*/
+void VPCALL idSIMD_AVX::CullByFrustum( idDrawVert *verts, const int numVerts, const idPlane frustum[6], byte *pointCull, float epsilon ) {
+	if ( !com_tempAllowAVX.GetBool() ) {
+		return idSIMD_SSE::CullByFrustum( verts, numVerts, frustum, pointCull, epsilon );
+	}
+	__m256 fA[6], fB[6], fC[6], fD[6];
+	for ( int i = 0; i < 6; i++ ) {
+		fA[i] = _mm256_set1_ps( frustum[i][0] );
+		fB[i] = _mm256_set1_ps( frustum[i][1] );
+		fC[i] = _mm256_set1_ps( frustum[i][2] );
+		fD[i] = _mm256_set1_ps( frustum[i][3] );
+	}
+	const __m256 eps = _mm256_set1_ps( epsilon );
+
+	int j = 0;
+	for ( ; j + 8 <= numVerts; j += 8 ) {
+		__m256 vX, vY, vZ;
+		LoadVertexesSoA( verts + j, vX, vY, vZ );
+
+		uint64 bits = 0;
+		for ( int i = 0; i < 6; i++ ) {
+			__m256 d = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( fA[i], vX ), _mm256_mul_ps( fB[i], vY ) ), _mm256_mul_ps( fC[i], vZ ) ), fD[i] );
+			int mask = _mm256_movemask_ps( _mm256_cmp_ps( d, eps, _CMP_LT_OQ ) );
+			bits |= ( SIMD_CullBitsSpread8[mask & 15] | (uint64)SIMD_CullBitsSpread8[mask >> 4] << 32 ) << i;
+		}
+		memcpy( pointCull + j, &bits, sizeof( bits ) );
+	}
+	_mm256_zeroupper();
+
+	if ( j < numVerts ) {
+		idSIMD_SSE::CullByFrustum( verts + j, numVerts - j, frustum, pointCull + j, epsilon );
+	}
+}
+
 /*
 ============
 idSIMD_AVX::CullByFrustum2
 ============
 */
 void VPCALL idSIMD_AVX::CullByFrustum2( idDrawVert *verts, const int numVerts, const idPlane frustum[6], unsigned short *pointCull, float epsilon ) {
-	static idCVar com_tempAllowAVX( "com_tempAllowAVX", "0", CVAR_SYSTEM, "to be removed before release" );
-	if ( !com_tempAllowAVX.GetBool() ) { // hidden under this cvar for now
+	if ( !com_tempAllowAVX.GetBool() ) {
 		return idSIMD_SSE::CullByFrustum2( verts, numVerts, frustum, pointCull, epsilon );
 	}
-	__m256 fA = _mm256_set_ps( 0, 0, frustum[5][0], frustum[4][0], frustum[3][0], frustum[2][0], frustum[1][0], frustum[0][0] );
-	__m256 fB = _mm256_set_ps( 0, 0, frustum[5][1], frustum[4][1], frustum[3][1], frustum[2][1], frustum[1][1], frustum[0][1] );
-	__m256 fC = _mm256_set_ps( 0, 0, frustum[5][2], frustum[4][2], frustum[3][2], frustum[2][2], frustum[1][2], frustum[0][2] );
-	__m256 fD = _mm256_set_ps( 0, 0, frustum[5][3], frustum[4][3], frustum[3][3], frustum[2][3], frustum[1][3], frustum[0][3] );
-	for ( int j = 0; j < numVerts; j++ ) {
-		auto &vec = verts[j].xyz;
-		__m256 vX = _mm256_set1_ps( vec.x );
-		__m256 vY = _mm256_set1_ps( vec.y );
-		__m256 vZ = _mm256_set1_ps( vec.z );
-		__m256 d = _mm256_add_ps(
-			_mm256_add_ps(
-				_mm256_mul_ps( fA, vX ),
-				_mm256_mul_ps( fB, vY )
-			),
-			_mm256_add_ps(
-				_mm256_mul_ps( fC, vZ ),
-				fD
-			)
-		);
-		const short mask6 = (1 << 6) - 1;
-		__m256 eps = _mm256_set1_ps( epsilon );
-		int mask_lo = _mm256_movemask_ps( _mm256_cmp_ps( d, eps, _CMP_LT_OQ ) );
-		eps = _mm256_set1_ps( -epsilon );
-		int mask_hi = _mm256_movemask_ps( _mm256_cmp_ps( d, eps, _CMP_GT_OQ ) );
-		pointCull[j] = mask_lo & mask6 | (mask_hi & mask6) << 6;
+	__m256 fA[6], fB[6], fC[6], fD[6];
+	for ( int i = 0; i < 6; i++ ) {
+		fA[i] = _mm256_set1_ps( frustum[i][0] );
+		fB[i] = _mm256_set1_ps( frustum[i][1] );
+		fC[i] = _mm256_set1_ps( frustum[i][2] );
+		fD[i] = _mm256_set1_ps( frustum[i][3] );
+	}
+	const __m256 eps = _mm256_set1_ps( epsilon );
+	const __m256 negEps = _mm256_set1_ps( -epsilon );
+
+	int j = 0;
+	for ( ; j + 8 <= numVerts; j += 8 ) {
+		__m256 vX, vY, vZ;
+		LoadVertexesSoA( verts + j, vX, vY, vZ );
+
+		uint64 bits[2] = { 0, 0 };
+		for ( int i = 0; i < 6; i++ ) {
+			__m256 d = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( fA[i], vX ), _mm256_mul_ps( fB[i], vY ) ), _mm256_mul_ps( fC[i], vZ ) ), fD[i] );
+			int maskLo = _mm256_movemask_ps( _mm256_cmp_ps( d, eps, _CMP_LT_OQ ) );
+			int maskHi = _mm256_movemask_ps( _mm256_cmp_ps( d, negEps, _CMP_GT_OQ ) );
+			bits[0] |= SIMD_CullBitsSpread16[maskLo & 15] << i | SIMD_CullBitsSpread16[maskHi & 15] << ( i + 6 );
+			bits[1] |= SIMD_CullBitsSpread16[maskLo >> 4] << i | SIMD_CullBitsSpread16[maskHi >> 4] << ( i + 6 );
+		}
+		memcpy( pointCull + j, bits, sizeof( bits ) );
 	}
 	_mm256_zeroupper();
+
+	if ( j < numVerts ) {
+		idSIMD_SSE::CullByFrustum2( verts + j, numVerts - j, frustum, pointCull + j, epsilon );
+	}
 }
@@ -16945,104 +16945,124 @@ void VPCALL idSIMD_SSE::MixedSoundToSamples( short *samples, const float *mixBuf
 #endif
 }
 
+#endif /* SIMD_USE_ASM */
+
+//===============================================================
+//
+//	SSE intrinsics used by all x86 and x64 builds
+//
+//===============================================================
+
+#include <xmmintrin.h>
+
+// spreads the 4 bit vertex mask of _mm_movemask_ps to one byte per vertex
+const unsigned int SIMD_CullBitsSpread8[16] = {
+	0x00000000, 0x00000001, 0x00000100, 0x00000101,
+	0x00010000, 0x00010001, 0x00010100, 0x00010101,
+	0x01000000, 0x01000001, 0x01000100, 0x01000101,
+	0x01010000, 0x01010001, 0x01010100, 0x01010101
+};
+
+// spreads the 4 bit vertex mask of _mm_movemask_ps to 16 bits per vertex
+const uint64 SIMD_CullBitsSpread16[16] = {
+	0x0000000000000000ULL, 0x0000000000000001ULL, 0x0000000000010000ULL, 0x0000000000010001ULL,
+	0x0000000100000000ULL, 0x0000000100000001ULL, 0x0000000100010000ULL, 0x0000000100010001ULL,
+	0x0001000000000000ULL, 0x0001000000000001ULL, 0x0001000000010000ULL, 0x0001000000010001ULL,
+	0x0001000100000000ULL, 0x0001000100000001ULL, 0x0001000100010000ULL, 0x0001000100010001ULL
+};
+
 /*
 ============
 idSIMD_SSE::CullByFrustum
+
+Structure of arrays version: four vertexes are transposed into x, y and z
+registers and tested against one plane at a time, so each plane gives the
+cull bit for four vertexes in a single movemask.
 ============
 */
 void VPCALL idSIMD_SSE::CullByFrustum( idDrawVert *verts, const int numVerts, const idPlane frustum[6], byte *pointCull, float epsilon ) {
-	__m128 fA14 = _mm_set_ps( frustum[3][0], frustum[2][0], frustum[1][0], frustum[0][0] );
-	__m128 fA56 = _mm_set_ps( 0, 0, frustum[5][0], frustum[4][0] );
-	__m128 fB14 = _mm_set_ps( frustum[3][1], frustum[2][1], frustum[1][1], frustum[0][1] );
-	__m128 fB56 = _mm_set_ps( 0, 0, frustum[5][1], frustum[4][1] );
-	__m128 fC14 = _mm_set_ps( frustum[3][2], frustum[2][2], frustum[1][2], frustum[0][2] );
-	__m128 fC56 = _mm_set_ps( 0, 0, frustum[5][2], frustum[4][2] );
-	__m128 fD14 = _mm_set_ps( frustum[3][3], frustum[2][3], frustum[1][3], frustum[0][3] );
-	__m128 fD56 = _mm_set_ps( 0, 0, frustum[5][3], frustum[4][3] );
-	for ( int j = 0; j < numVerts; j++ ) {
-		auto &vec = verts[j].xyz;
-		__m128 vX = _mm_set1_ps( vec.x );
-		__m128 vY = _mm_set1_ps( vec.y );
-		__m128 vZ = _mm_set1_ps( vec.z );
-		__m128 d14 = _mm_add_ps(
-			_mm_add_ps(
-				_mm_mul_ps( fA14, vX ),
-				_mm_mul_ps( fB14, vY )
-			),
-			_mm_add_ps(
-				_mm_mul_ps( fC14, vZ ),
-				fD14
-			)
-		);
-		__m128 d56 = _mm_add_ps(
-			_mm_add_ps(
-				_mm_mul_ps( fA56, vX ),
-				_mm_mul_ps( fB56, vY )
-			),
-			_mm_add_ps(
-				_mm_mul_ps( fC56, vZ ),
-				fD56
-			)
-		);
-		const short mask6 = (1 << 6) - 1;
-		__m128 eps = _mm_set1_ps( epsilon );
-		int mask_lo14 = _mm_movemask_ps( _mm_cmplt_ps( d14, eps ) );
-		int mask_lo56 = _mm_movemask_ps( _mm_cmplt_ps( d56, eps ) );
-		int mask_lo = mask_lo14 | mask_lo56 << 4;
-		pointCull[j] = mask_lo & mask6;
+	__m128 fA[6], fB[6], fC[6], fD[6];
+	for ( int i = 0; i < 6; i++ ) {
+		fA[i] = _mm_set1_ps( frustum[i][0] );
+		fB[i] = _mm_set1_ps( frustum[i][1] );
+		fC[i] = _mm_set1_ps( frustum[i][2] );
+		fD[i] = _mm_set1_ps( frustum[i][3] );
+	}
+	const __m128 eps = _mm_set1_ps( epsilon );
+
+	int j = 0;
+	for ( ; j + 4 <= numVerts; j += 4 ) {
+		// the load includes st[0] after xyz, which ends up in vW and is ignored
+		__m128 vX = _mm_loadu_ps( verts[j+0].xyz.ToFloatPtr() );
+		__m128 vY = _mm_loadu_ps( verts[j+1].xyz.ToFloatPtr() );
+		__m128 vZ = _mm_loadu_ps( verts[j+2].xyz.ToFloatPtr() );
+		__m128 vW = _mm_loadu_ps( verts[j+3].xyz.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( vX, vY, vZ, vW );
+
+		unsigned int bits = 0;
+		for ( int i = 0; i < 6; i++ ) {
+			// same order of operations as idPlane::Distance
+			__m128 d = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( fA[i], vX ), _mm_mul_ps( fB[i], vY ) ), _mm_mul_ps( fC[i], vZ ) ), fD[i] );
+			bits |= SIMD_CullBitsSpread8[_mm_movemask_ps( _mm_cmplt_ps( d, eps ) )] << i;
+		}
+		memcpy( pointCull + j, &bits, sizeof( bits ) );
+	}
+
+	for ( ; j < numVerts; j++ ) {
+		const idVec3 &vec = verts[j].xyz;
+		byte bits = 0;
+		for ( int i = 0; i < 6; i++ ) {
+			float d = frustum[i].Distance( vec );
+			bits |= (d < epsilon) << i;
+		}
+		pointCull[j] = bits;
 	}
 }
 
 /*
 ============
 idSIMD_SSE::CullByFrustum2
+
+Like CullByFrustum, with the bits for vertexes on the front of
+each plane in the upper 6 bits.
 ============
 */
 void VPCALL idSIMD_SSE::CullByFrustum2( idDrawVert *verts, const int numVerts, const idPlane frustum[6], unsigned short *pointCull, float epsilon ) {
-	__m128 fA14 = _mm_set_ps( frustum[3][0], frustum[2][0], frustum[1][0], frustum[0][0] );
-	__m128 fA56 = _mm_set_ps( 0, 0, frustum[5][0], frustum[4][0] );
-	__m128 fB14 = _mm_set_ps( frustum[3][1], frustum[2][1], frustum[1][1], frustum[0][1] );
-	__m128 fB56 = _mm_set_ps( 0, 0, frustum[5][1], frustum[4][1] );
-	__m128 fC14 = _mm_set_ps( frustum[3][2], frustum[2][2], frustum[1][2], frustum[0][2] );
-	__m128 fC56 = _mm_set_ps( 0, 0, frustum[5][2], frustum[4][2] );
-	__m128 fD14 = _mm_set_ps( frustum[3][3], frustum[2][3], frustum[1][3], frustum[0][3] );
-	__m128 fD56 = _mm_set_ps( 0, 0, frustum[5][3], frustum[4][3] );
-	for ( int j = 0; j < numVerts; j++ ) {
-		auto &vec = verts[j].xyz;
-		__m128 vX = _mm_set1_ps( vec.x );
-		__m128 vY = _mm_set1_ps( vec.y );
-		__m128 vZ = _mm_set1_ps( vec.z );
-		__m128 d14 = _mm_add_ps(
-			_mm_add_ps(
-				_mm_mul_ps( fA14, vX ),
-				_mm_mul_ps( fB14, vY )
-			),
-			_mm_add_ps(
-				_mm_mul_ps( fC14, vZ ),
-				fD14
-			)
-		);
-		__m128 d56 = _mm_add_ps(
-			_mm_add_ps(
-				_mm_mul_ps( fA56, vX ),
-				_mm_mul_ps( fB56, vY )
-			),
-			_mm_add_ps(
-				_mm_mul_ps( fC56, vZ ),
-				fD56
-			)
-		);
-		const short mask6 = (1 << 6) - 1;
-		__m128 eps = _mm_set1_ps( epsilon );
-		int mask_lo14 = _mm_movemask_ps( _mm_cmplt_ps( d14, eps ) );
-		int mask_lo56 = _mm_movemask_ps( _mm_cmplt_ps( d56, eps ) );
-		eps = _mm_set1_ps( -epsilon );
-		int mask_hi14 = _mm_movemask_ps( _mm_cmpgt_ps( d14, eps ) );
-		int mask_hi56 = _mm_movemask_ps( _mm_cmpgt_ps( d56, eps ) );
-		int mask_lo = mask_lo14 | mask_lo56 << 4;
-		int mask_hi = mask_hi14 | mask_hi56 << 4;
-		pointCull[j] = mask_lo & mask6 | (mask_hi & mask6) << 6;
+	__m128 fA[6], fB[6], fC[6], fD[6];
+	for ( int i = 0; i < 6; i++ ) {
+		fA[i] = _mm_set1_ps( frustum[i][0] );
+		fB[i] = _mm_set1_ps( frustum[i][1] );
+		fC[i] = _mm_set1_ps( frustum[i][2] );
+		fD[i] = _mm_set1_ps( frustum[i][3] );
+	}
+	const __m128 eps = _mm_set1_ps( epsilon );
+	const __m128 negEps = _mm_set1_ps( -epsilon );
+
+	int j = 0;
+	for ( ; j + 4 <= numVerts; j += 4 ) {
+		__m128 vX = _mm_loadu_ps( verts[j+0].xyz.ToFloatPtr() );
+		__m128 vY = _mm_loadu_ps( verts[j+1].xyz.ToFloatPtr() );
+		__m128 vZ = _mm_loadu_ps( verts[j+2].xyz.ToFloatPtr() );
+		__m128 vW = _mm_loadu_ps( verts[j+3].xyz.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( vX, vY, vZ, vW );
+
+		uint64 bits = 0;
+		for ( int i = 0; i < 6; i++ ) {
+			__m128 d = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( fA[i], vX ), _mm_mul_ps( fB[i], vY ) ), _mm_mul_ps( fC[i], vZ ) ), fD[i] );
+			bits |= SIMD_CullBitsSpread16[_mm_movemask_ps( _mm_cmplt_ps( d, eps ) )] << i;
+			bits |= SIMD_CullBitsSpread16[_mm_movemask_ps( _mm_cmpgt_ps( d, negEps ) )] << ( i + 6 );
+		}
+		memcpy( pointCull + j, &bits, sizeof( bits ) );
 	}
-}
 
-#endif /* SIMD_USE_ASM */
\ No newline at end of file
+	for ( ; j < numVerts; j++ ) {
+		const idVec3 &vec = verts[j].xyz;
+		unsigned short bits = 0;
+		for ( int i = 0; i < 6; i++ ) {
+			float d = frustum[i].Distance( vec );
+			bits |= (d < epsilon) << i;
+			bits |= (d > -epsilon) << (i + 6);
+		}
+		pointCull[j] = bits;
+	}
+}
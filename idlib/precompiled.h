@@ -102,6 +102,7 @@
 
 // id lib
 #include "../idlib/Lib.h"
+#include "../idlib/ParallelJobList.h"
 
 // framework
 #include "../framework/Licensee.h"
@@ -203,8 +203,14 @@ public:
 	void		SetImageFilterAndRepeat() const;
 	bool		ShouldImageBePartialCached();
 	void		WritePrecompressedImage();
+	idFile *	OpenPrecompressedImage();
 	bool		CheckPrecompressedImage( bool fullLoad );
 	void		UploadPrecompressedImage( byte *data, int len );
+	bool		LoadStreamedImage();
+	void		UploadStreamedLevels( const byte *data, int firstLevel, int lastLevel );
+	int			EvictStreamedLevels();
+	void		RequestStreamedLevel();
+	int			StreamedLevelBytes( int firstLevel ) const;
 	void		ActuallyLoadImage( bool checkForPrecompressed, bool fromBackEnd );
 	void		StartBackgroundImageLoad();
 	int			BitsForInternalFormat( int internalFormat ) const;
@@ -224,9 +230,25 @@ public:
 	idImage				*partialImage;			// shrunken, space-saving version
 	bool				isPartialImage;			// true if this is pointed to by another image
 	bool				backgroundLoadInProgress;	// true if another thread is reading the complete d3t file
+	bool				backgroundLoadFailed;		// the file couldn't be read, don't retry until the image is purged
 	backgroundDownload_t	bgl;
 	idImage *			bglNext;				// linked from tr.backgroundImageLoads
 
+	// texture streaming information, levels are numbered as in the .dds file
+	bool				isStreamed;				// true if only some levels of the precompressed file are uploaded
+	int					streamWidth, streamHeight;	// size of level 0 in the file
+	int					streamNumLevels;
+	int					streamTopLevel;			// largest level allowed by the downsize settings, becomes gl level 0
+	int					streamBaseLevel;		// levels from here on are always resident
+	int					streamResidentLevel;	// largest level in the texture
+	int					streamRequestLevel;		// largest level asked for by the binds of the last frame
+	int					streamWantedLevel;		// collects the requests of the current frame
+	int					streamLoadLevel;		// first level of the background load in progress, -1 if none
+	int					streamFrameUsed;		// for evicting the least recently used levels first
+	int					streamExternalFormat;	// 0 for compressed formats
+	int					streamBitsPerPixel;		// for uncompressed formats
+	int					streamLevelOffset[MAX_TEXTURE_LEVELS];	// file offsets, larger levels come first
+
 	// parameters that define this image
 	idStr				imgName;				// game path, including extension (except for cube maps), may be an image program
 	void				(*generatorFunction)( idImage *image );	// NULL for files
@@ -265,9 +287,17 @@ ID_INLINE idImage::idImage() {
 	frameUsed = 0;
 	classification = 0;
 	backgroundLoadInProgress = false;
+	backgroundLoadFailed = false;
 	bgl.opcode = DLTYPE_FILE;
 	bgl.f = NULL;
 	bglNext = NULL;
+	isStreamed = false;
+	streamWidth = streamHeight = 0;
+	streamNumLevels = streamTopLevel = streamBaseLevel = 0;
+	streamResidentLevel = streamRequestLevel = streamWantedLevel = 0;
+	streamLoadLevel = -1;
+	streamFrameUsed = 0;
+	streamExternalFormat = streamBitsPerPixel = 0;
 	imgName[0] = '\0';
 	generatorFunction = NULL;
 	allowDownSize = false;
@@ -327,6 +357,10 @@ public:
 	// to turn into textures.
 	void				CompleteBackgroundImageLoads();
 
+	// called once a frame after the background loads to promote streamed images
+	// that are drawn larger than their resident levels and to keep the budget
+	void				UpdateStreamedImages();
+
 	// returns the number of bytes of image data bound in the previous frame
 	int					SumOfUsedImages();
 
@@ -383,6 +417,10 @@ public:
 	static idCVar		image_cacheMegs;			// maximum bytes set aside for temporary loading of full-sized precompressed images
 	static idCVar		image_useCache;				// 1 = do background load image caching
 	static idCVar		image_showBackgroundLoads;	// 1 = print number of outstanding background loads
+	static idCVar		image_streaming;			// 1 = only load the low mip levels of precompressed images at level load
+	static idCVar		image_streamingMegs;		// maximum MB of streamed texture levels that are resident
+	static idCVar		image_streamingMinSize;		// levels up to this size are always resident
+	static idCVar		image_streamingLodBias;		// request levels this many times larger than the screen size suggests
 	static idCVar		image_forceDownSize;		// allows the ability to force a downsize
 	static idCVar		image_downSizeSpecular;		// downsize specular
 	static idCVar		image_downSizeSpecularLimit;// downsize specular limit
@@ -454,6 +492,13 @@ public:
 
 	int	numActiveBackgroundImageLoads;
 	const static int MAX_BACKGROUND_IMAGE_LOADS = 8;
+
+	// texture streaming statistics, for listStreamedImages
+	int64_t				streamResidentBytes;
+	int					streamNumPromotions;
+	int					streamNumEvictions;
+	idList<idImage *>	streamPromotions;			// scratch lists for UpdateStreamedImages
+	idList<idImage *>	streamEvictions;
 };
 
 extern idImageManager	*globalImages;		// pointer to global list for the rest of the system
@@ -61,6 +61,10 @@ idCVar idImageManager::image_cacheMinK( "image_cacheMinK", "200", CVAR_RENDERER
 idCVar idImageManager::image_cacheMegs( "image_cacheMegs", "20", CVAR_RENDERER | CVAR_ARCHIVE, "maximum MB set aside for temporary loading of full-sized precompressed images" );
 idCVar idImageManager::image_useCache( "image_useCache", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_BOOL, "1 = do background load image caching" );
 idCVar idImageManager::image_showBackgroundLoads( "image_showBackgroundLoads", "0", CVAR_RENDERER | CVAR_BOOL, "1 = print number of outstanding background loads" );
+idCVar idImageManager::image_streaming( "image_streaming", "1", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_BOOL, "1 = only load the small mip levels of precompressed images, larger levels are read in the background when the image is drawn large enough" );
+idCVar idImageManager::image_streamingMegs( "image_streamingMegs", "1024", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "maximum MB of streamed mip levels kept in texture memory, least recently used levels are dropped first" );
+idCVar idImageManager::image_streamingMinSize( "image_streamingMinSize", "128", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "mip levels up to this size are loaded with the level and always kept" );
+idCVar idImageManager::image_streamingLodBias( "image_streamingLodBias", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "request streamed mip levels this many times larger than the on screen size suggests" );
 idCVar idImageManager::image_downSizeSpecular( "image_downSizeSpecular", "0", CVAR_RENDERER | CVAR_ARCHIVE, "controls specular downsampling" );
 idCVar idImageManager::image_downSizeBump( "image_downSizeBump", "0", CVAR_RENDERER | CVAR_ARCHIVE, "controls normal map downsampling" );
 idCVar idImageManager::image_downSizeSpecularLimit( "image_downSizeSpecularLimit", "64", CVAR_RENDERER | CVAR_ARCHIVE, "controls specular downsampled limit" );
@@ -1024,6 +1028,9 @@ void R_ReloadImages_f( const idCmdArgs &args ) {
 	// FIXME - this probably isn't necessary... // Serp - this is a comment from the gpl release, check if it's really not needed
 	globalImages->ChangeTextureFilter();
 
+	// loose images might have been added in front of the paks
+	fileSystem->ClearDirCache();
+
 	bool	normalsOnly = false, force = false;
 	bool	checkPrecompressed = false;		// if we are doing this as a vid_restart, look for precompressed like normal
 
@@ -1258,6 +1265,52 @@ void R_ListImages_f( const idCmdArgs &args ) {
 
 }
 
+/*
+===============
+R_ListStreamedImages_f
+===============
+*/
+void R_ListStreamedImages_f( const idCmdArgs &args ) {
+	int		count = 0;
+	int64_t	requestedSize = 0;
+
+	sortedImage_t	*sortedArray = (sortedImage_t *)alloca( sizeof( sortedImage_t ) * globalImages->images.Num() );
+
+	for ( int i = 0 ; i < globalImages->images.Num() ; i++ ) {
+		idImage	*image = globalImages->images[ i ];
+		if ( !image->isStreamed ) {
+			continue;
+		}
+		sortedArray[count].image = image;
+		sortedArray[count].size = image->StorageSize();
+		count++;
+	}
+
+	qsort( sortedArray, count, sizeof( sortedImage_t ), R_QsortImageSizes );
+
+	const char *header = "     -w-- -h-- resident -w-- -h-- requested --name-------\n";
+	common->Printf( "\n%s", header );
+
+	for ( int i = 0 ; i < count ; i++ ) {
+		const idImage *image = sortedArray[i].image;
+		const int requestLevel = Min( image->streamRequestLevel, image->streamBaseLevel );
+		const int requested = image->StreamedLevelBytes( requestLevel );
+		requestedSize += requested;
+
+		common->Printf( "%4i:%4i %4i %7ik %4i %4i %8ik %s%s\n", i,
+			Max( image->streamWidth >> image->streamResidentLevel, 1 ), Max( image->streamHeight >> image->streamResidentLevel, 1 ), sortedArray[i].size / 1024,
+			Max( image->streamWidth >> requestLevel, 1 ), Max( image->streamHeight >> requestLevel, 1 ), requested / 1024,
+			image->imgName.c_str(), image->backgroundLoadInProgress ? " (loading)" : "" );
+	}
+
+	common->Printf( "%s", header );
+	common->Printf( " %i streamed images\n", count );
+	common->Printf( " %5.1f megs resident, %5.1f megs requested, %i megs budget\n",
+		globalImages->streamResidentBytes / ( 1024 * 1024.0f ), requestedSize / ( 1024 * 1024.0f ), globalImages->image_streamingMegs.GetInteger() );
+	common->Printf( " %i background loads active, %i promotions and %i evictions since level load\n\n",
+		globalImages->numActiveBackgroundImageLoads, globalImages->streamNumPromotions, globalImages->streamNumEvictions );
+}
+
 /*
 ==================
 SetNormalPalette
@@ -1768,19 +1821,20 @@ void idImage::StartBackgroundImageLoad() {
 	if ( imageManager.numActiveBackgroundImageLoads >= idImageManager::MAX_BACKGROUND_IMAGE_LOADS ) {
 		return;
 	}
+	bgl.f = NULL;
+	if ( backgroundLoadFailed ) {
+		return;
+	}
 	if ( globalImages->image_showBackgroundLoads.GetBool() ) {
 		common->Printf( "idImage::StartBackgroundImageLoad: %s\n", imgName.c_str() );
 	}
-	backgroundLoadInProgress = true;
 
 	if ( !precompressedFile ) {
 		common->Warning( "idImageManager::StartBackgroundImageLoad: %s wasn't a precompressed file", imgName.c_str() );
+		backgroundLoadFailed = true;
 		return;
 	}
 
-	bglNext = globalImages->backgroundImageLoads;
-	globalImages->backgroundImageLoads = this;
-
 	char filename[MAX_IMAGE_NAME];
 	ImageProgramStringToCompressedFileName( imgName, filename );
 
@@ -1788,21 +1842,40 @@ void idImage::StartBackgroundImageLoad() {
 	bgl.f = fileSystem->OpenFileRead( filename );
 	if ( !bgl.f ) {
 		common->Warning( "idImageManager::StartBackgroundImageLoad: Couldn't load %s", imgName.c_str() );
+		backgroundLoadFailed = true;
 		return;
 	}
-	bgl.file.position = 0;
-	bgl.file.length = bgl.f->Length();
-	if ( bgl.file.length < sizeof( ddsFileHeader_t ) ) {
-		common->Warning( "idImageManager::StartBackgroundImageLoad: %s had a bad file length", imgName.c_str() );
-		return;
+	if ( isStreamed ) {
+		// just the levels between the requested and the resident one, they are stored next to each other
+		bgl.file.position = streamLevelOffset[streamLoadLevel];
+		bgl.file.length = streamLevelOffset[streamResidentLevel] - bgl.file.position;
+	} else {
+		bgl.file.position = 0;
+		bgl.file.length = bgl.f->Length();
+		if ( bgl.file.length < sizeof( ddsFileHeader_t ) ) {
+			common->Warning( "idImageManager::StartBackgroundImageLoad: %s had a bad file length", imgName.c_str() );
+			fileSystem->CloseFile( bgl.f );
+			bgl.f = NULL;
+			backgroundLoadFailed = true;
+			return;
+		}
 	}
 
 	bgl.file.buffer = R_StaticAlloc( bgl.file.length );
+	backgroundLoadInProgress = true;
+
+	bglNext = globalImages->backgroundImageLoads;
+	globalImages->backgroundImageLoads = this;
 
 	fileSystem->BackgroundDownload( &bgl );
 
 	imageManager.numActiveBackgroundImageLoads++;
 
+	// idImageManager::UpdateStreamedImages keeps the budget for streamed images
+	if ( isStreamed ) {
+		return;
+	}
+
 	// purge some images if necessary
 	int	totalSize = 0;
 	for ( idImage *check = globalImages->cacheLRU.cacheUsageNext ; check != &globalImages->cacheLRU ; check = check->cacheUsageNext ) {
@@ -1845,8 +1918,17 @@ void idImageManager::CompleteBackgroundImageLoads() {
 		if ( image->bgl.completed ) {
 			numActiveBackgroundImageLoads--;
 			fileSystem->CloseFile( image->bgl.f );
-			// upload the image
-			image->UploadPrecompressedImage( (byte *)image->bgl.file.buffer, image->bgl.file.length );
+			if ( image->streamLoadLevel != -1 ) {
+				// the image may have been purged or reloaded while the levels were read
+				if ( image->isStreamed ) {
+					image->UploadStreamedLevels( (byte *)image->bgl.file.buffer, image->streamLoadLevel, image->streamResidentLevel );
+				}
+				image->streamLoadLevel = -1;
+				image->backgroundLoadInProgress = false;
+			} else {
+				// upload the image
+				image->UploadPrecompressedImage( (byte *)image->bgl.file.buffer, image->bgl.file.length );
+			}
 			R_StaticFree( image->bgl.file.buffer );
 			if ( image_showBackgroundLoads.GetBool() ) {
 				common->Printf( "R_CompleteBackgroundImageLoad: %s\n", image->imgName.c_str() );
@@ -1865,6 +1947,110 @@ void idImageManager::CompleteBackgroundImageLoads() {
 	}
 
 	backgroundImageLoads = remainingList;
+
+	UpdateStreamedImages();
+}
+
+/*
+==================
+R_CompareStreamPromotions
+
+The images missing the most levels come first
+==================
+*/
+static int R_CompareStreamPromotions( idImage * const *a, idImage * const *b ) {
+	return ( ( *b )->streamResidentLevel - ( *b )->streamRequestLevel ) - ( ( *a )->streamResidentLevel - ( *a )->streamRequestLevel );
+}
+
+/*
+==================
+R_CompareStreamEvictions
+
+The least recently used images come first
+==================
+*/
+static int R_CompareStreamEvictions( idImage * const *a, idImage * const *b ) {
+	return ( *a )->streamFrameUsed - ( *b )->streamFrameUsed;
+}
+
+/*
+==================
+idImageManager::UpdateStreamedImages
+
+Starts background loads for the streamed images that were drawn larger than their
+resident levels last frame. The resident levels of all streamed images are kept below
+image_streamingMegs by dropping the levels of images that weren't drawn, least recently
+used ones first. Images that are on screen are never reduced.
+==================
+*/
+void idImageManager::UpdateStreamedImages() {
+	// 64 bit, budgets of 2 GB and more are plausible on large cards
+	const int64_t budget = (int64_t)image_streamingMegs.GetInteger() * 1024 * 1024;
+	int64_t	residentBytes = 0;
+	int64_t	pendingBytes = 0;
+
+	streamPromotions.SetNum( 0, false );
+	streamEvictions.SetNum( 0, false );
+
+	for ( int i = 0; i < images.Num(); i++ ) {
+		idImage	*image = images[i];
+		if ( !image->isStreamed ) {
+			continue;
+		}
+
+		// take over the requests of the binds since the last update
+		const bool used = image->streamWantedLevel < image->streamNumLevels;
+		image->streamRequestLevel = used ? image->streamWantedLevel : image->streamBaseLevel;
+		image->streamWantedLevel = image->streamNumLevels;
+
+		residentBytes += image->StreamedLevelBytes( image->streamResidentLevel );
+
+		if ( image->backgroundLoadInProgress ) {
+			if ( image->streamLoadLevel != -1 ) {
+				pendingBytes += image->StreamedLevelBytes( image->streamLoadLevel ) - image->StreamedLevelBytes( image->streamResidentLevel );
+			}
+		} else if ( image->streamRequestLevel < image->streamResidentLevel ) {
+			streamPromotions.Append( image );
+		} else if ( !used && image->streamResidentLevel < image->streamBaseLevel ) {
+			streamEvictions.Append( image );
+		}
+	}
+
+	streamEvictions.Sort( R_CompareStreamEvictions );
+	int nextEviction = 0;
+
+	streamPromotions.Sort( R_CompareStreamPromotions );
+	for ( int i = 0; i < streamPromotions.Num() && numActiveBackgroundImageLoads < MAX_BACKGROUND_IMAGE_LOADS; i++ ) {
+		idImage	*image = streamPromotions[i];
+		const int needed = image->StreamedLevelBytes( image->streamRequestLevel ) - image->StreamedLevelBytes( image->streamResidentLevel );
+
+		// make room by dropping the levels of images that weren't drawn
+		while ( residentBytes + pendingBytes + needed > budget && nextEviction < streamEvictions.Num() ) {
+			residentBytes -= streamEvictions[nextEviction++]->EvictStreamedLevels();
+			streamNumEvictions++;
+		}
+		if ( residentBytes + pendingBytes + needed > budget ) {
+			break;
+		}
+
+		image->streamLoadLevel = image->streamRequestLevel;
+		image->StartBackgroundImageLoad();
+		if ( !image->bgl.f ) {
+			// couldn't open the file, backgroundLoadFailed keeps it from trying again until the image is reloaded
+			image->streamLoadLevel = -1;
+			continue;
+		}
+		pendingBytes += needed;
+		streamNumPromotions++;
+	}
+
+	// the budget may have been lowered
+	while ( residentBytes + pendingBytes > budget && nextEviction < streamEvictions.Num() ) {
+		residentBytes -= streamEvictions[nextEviction++]->EvictStreamedLevels();
+		streamNumEvictions++;
+	}
+
+	streamResidentBytes = residentBytes;
 }
 
 /*
@@ -1977,6 +2163,7 @@ void idImageManager::Init() {
 
 	cmdSystem->AddCommand( "reloadImages", R_ReloadImages_f, CMD_FL_RENDERER, "reloads images" );
 	cmdSystem->AddCommand( "listImages", R_ListImages_f, CMD_FL_RENDERER, "lists images" );
+	cmdSystem->AddCommand( "listStreamedImages", R_ListStreamedImages_f, CMD_FL_RENDERER, "lists the resident and requested sizes of streamed images" );
 	cmdSystem->AddCommand( "combineCubeImages", R_CombineCubeImages_f, CMD_FL_RENDERER, "combines six images for roq compression" );
 
 	image_useNormalCompression.AddOnModifiedCallback( [&]() { 
@@ -2013,6 +2200,9 @@ void idImageManager::BeginLevelLoad() {
 	insideLevelLoad = true;
 	idImage	*image;
 
+	streamNumPromotions = 0;
+	streamNumEvictions = 0;
+
 	for ( int i = 0 ; i < images.Num() ; i++ ) {
 		image = images[ i ];
 
@@ -2112,10 +2302,22 @@ void idImageManager::EndLevelLoad()
 
 	}
 
+	int streamedCount = 0;
+	int streamedSize = 0;
+	for ( int i = 0 ; i < images.Num() ; i++ ) {
+		if ( images[i]->isStreamed ) {
+			streamedCount++;
+			streamedSize += images[i]->StorageSize();
+		}
+	}
+
 	const int end = Sys_Milliseconds();
 	common->Printf( "%5i purged from previous\n", purgeCount );
 	common->Printf( "%5i kept from previous\n", keepCount );
 	common->Printf( "%5i new loaded\n", loadCount );
+	if ( streamedCount ) {
+		common->Printf( "%5i streamed, %5.1f megs resident\n", streamedCount, streamedSize / ( 1024 * 1024.0f ) );
+	}
 	common->Printf( "all images loaded in %5.1f seconds\n", ( end - start ) * 0.001f );
 	common->PacifierUpdate(LOAD_KEY_DONE,0); // grayman #3763
 	common->Printf( "----------------------------------------\n" );
@@ -1111,21 +1111,21 @@ bool idImage::ShouldImageBePartialCached() {
 
 /*
 ================
-CheckPrecompressedImage
+OpenPrecompressedImage
 
-If fullLoad is false, only the small mip levels of the image will be loaded
+Returns the opened .dds file if it can be used instead of the source image
 ================
 */
-bool idImage::CheckPrecompressedImage( bool fullLoad ) {
+idFile *idImage::OpenPrecompressedImage() {
 	if ( !glConfig.isInitialized || !glConfig.textureCompressionAvailable ) {
-		return false;
+		return NULL;
 	}
 
 	// Allow grabbing of DDS's from original Doom pak files
 
 	// compressed light images may look ugly
 	if ( /*com_videoRam.GetInteger() >= 128 &&*/ imgName.Icmpn( "lights/", 7 ) == 0 ) {
-		return false;
+		return NULL;
 	}
 
 	char filename[MAX_IMAGE_NAME];
@@ -1137,32 +1137,47 @@ bool idImage::CheckPrecompressedImage( bool fullLoad ) {
 
 
 	if ( precompTimestamp == FILE_NOT_FOUND_TIMESTAMP ) {
-		return false;
+		return NULL;
 	}
 
 	if ( !generatorFunction && timestamp != FILE_NOT_FOUND_TIMESTAMP ) {
 		if ( precompTimestamp < timestamp ) {
 			// The image has changed after being precompressed
-			return false;
+			return NULL;
 		}
 	}
 
 	timestamp = precompTimestamp;
 
-	// open it and just read the header
-	idFile *f;
-
-	f = fileSystem->OpenFileRead( filename );
+	idFile *f = fileSystem->OpenFileRead( filename );
 	if ( !f ) {
-		return false;
+		return NULL;
 	}
 
-	int	len = f->Length();
-	if ( len < sizeof( ddsFileHeader_t ) ) {
+	if ( f->Length() < sizeof( ddsFileHeader_t ) ) {
 		fileSystem->CloseFile( f );
+		return NULL;
+	}
+
+	return f;
+}
+
+/*
+================
+CheckPrecompressedImage
+
+If fullLoad is false, only the small mip levels of the image will be loaded
+================
+*/
+bool idImage::CheckPrecompressedImage( bool fullLoad ) {
+	// open it and just read the header
+	idFile *f = OpenPrecompressedImage();
+	if ( !f ) {
 		return false;
 	}
 
+	int	len = f->Length();
+
 	if ( !fullLoad && len > globalImages->image_cacheMinK.GetInteger() * 1024 ) {
 		len = globalImages->image_cacheMinK.GetInteger() * 1024;
 	}
@@ -1193,17 +1208,12 @@ bool idImage::CheckPrecompressedImage( bool fullLoad ) {
 
 /*
 ===================
-UploadPrecompressedImage
+R_SwapDDSHeader
 
-This can be called by the front end during nromal loading,
-or by the backend after a background read of the file
-has completed
+( not byte swapping dwReserved1 dwReserved2 )
 ===================
 */
-void idImage::UploadPrecompressedImage( byte *data, int len ) {
-	ddsFileHeader_t	*header = (ddsFileHeader_t *)(data + 4);
-
-	// ( not byte swapping dwReserved1 dwReserved2 )
+static void R_SwapDDSHeader( ddsFileHeader_t *header ) {
 	header->dwSize = LittleInt( header->dwSize );
 	header->dwFlags = LittleInt( header->dwFlags );
 	header->dwHeight = LittleInt( header->dwHeight );
@@ -1222,16 +1232,18 @@ void idImage::UploadPrecompressedImage( byte *data, int len ) {
 	header->ddspf.dwGBitMask = LittleInt( header->ddspf.dwGBitMask );
 	header->ddspf.dwBBitMask = LittleInt( header->ddspf.dwBBitMask );
 	header->ddspf.dwABitMask = LittleInt( header->ddspf.dwABitMask );
+}
 
-	// generate the texture number
-	qglGenTextures( 1, &texnum );
-
-	int externalFormat = 0;
+/*
+===================
+R_DDSFormat
 
-	precompressedFile = true;
+Returns false if the pixel format of the file can't be uploaded
+===================
+*/
+static bool R_DDSFormat( const ddsFileHeader_t *header, int &internalFormat, int &externalFormat ) {
+	externalFormat = 0;
 
-	uploadWidth = header->dwWidth;
-	uploadHeight = header->dwHeight;
     if ( header->ddspf.dwFlags & DDSF_FOURCC ) {
         switch ( header->ddspf.dwFourCC ) {
         case DDS_MAKEFOURCC( 'D', 'X', 'T', '1' ):
@@ -1258,8 +1270,7 @@ void idImage::UploadPrecompressedImage( byte *data, int len ) {
 			//internalFormat = GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
 			break;
         default:
-            common->Warning( "Invalid compressed internal format: %s", imgName.c_str() );
-            return;
+            return false;
         }
     } else if ( ( header->ddspf.dwFlags & DDSF_RGBA ) && header->ddspf.dwRGBBitCount == 32 ) {
 		externalFormat = GL_BGRA_EXT;
@@ -1274,7 +1285,52 @@ void idImage::UploadPrecompressedImage( byte *data, int len ) {
 		externalFormat = GL_ALPHA;
 		internalFormat = GL_ALPHA8;
 	} else {
-		common->Warning( "Invalid uncompressed internal format: %s", imgName.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+/*
+===================
+R_DDSLevelSize
+
+Bytes of a single mip level in a .dds file
+===================
+*/
+static int R_DDSLevelSize( int internalFormat, int bitsPerPixel, int width, int height ) {
+	if ( FormatIsDXT( internalFormat ) ) {
+		return ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) *
+			( internalFormat <= GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? 8 : 16 );
+	}
+	return width * height * ( bitsPerPixel / 8 );
+}
+
+/*
+===================
+UploadPrecompressedImage
+
+This can be called by the front end during nromal loading,
+or by the backend after a background read of the file
+has completed
+===================
+*/
+void idImage::UploadPrecompressedImage( byte *data, int len ) {
+	ddsFileHeader_t	*header = (ddsFileHeader_t *)(data + 4);
+
+	R_SwapDDSHeader( header );
+
+	// generate the texture number
+	qglGenTextures( 1, &texnum );
+
+	int externalFormat = 0;
+
+	precompressedFile = true;
+
+	uploadWidth = header->dwWidth;
+	uploadHeight = header->dwHeight;
+	if ( !R_DDSFormat( header, internalFormat, externalFormat ) ) {
+		common->Warning( "Invalid %s internal format: %s", ( header->ddspf.dwFlags & DDSF_FOURCC ) ? "compressed" : "uncompressed", imgName.c_str() );
 		return;
 	}
 
@@ -1297,13 +1353,7 @@ void idImage::UploadPrecompressedImage( byte *data, int len ) {
 	byte *imagedata = data + sizeof(ddsFileHeader_t) + 4;
 
 	for ( int i = 0 ; i < numMipmaps; i++ ) {
-		int size = 0;
-		if ( FormatIsDXT( internalFormat ) ) {
-			size = ( ( uw + 3 ) / 4 ) * ( ( uh + 3 ) / 4 ) *
-				(internalFormat <= GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? 8 : 16);
-		} else {
-			size = uw * uh * (header->ddspf.dwRGBBitCount / 8);
-		}
+		int size = R_DDSLevelSize( internalFormat, header->ddspf.dwRGBBitCount, uw, uh );
 
 		if ( uw > uploadWidth || uh > uploadHeight ) {
 			skipMip++;
@@ -1329,6 +1379,202 @@ void idImage::UploadPrecompressedImage( byte *data, int len ) {
 	SetImageFilterAndRepeat();
 }
 
+/*
+===================
+LoadStreamedImage
+
+Only uploads the small mip levels of a precompressed image, the larger ones are read
+in the background once the image is drawn large enough, see idImageManager::UpdateStreamedImages.
+Returns false if the image has to be loaded completely.
+===================
+*/
+bool idImage::LoadStreamedImage() {
+	// the allowDownSize flag does double-duty as don't-partial-load
+	if ( cubeFiles != CF_2D || !allowDownSize || backgroundLoadInProgress ) {
+		return false;
+	}
+
+	idFile *f = OpenPrecompressedImage();
+	if ( !f ) {
+		return false;
+	}
+
+	byte headerData[4 + sizeof( ddsFileHeader_t )];
+	if ( f->Read( headerData, sizeof( headerData ) ) != sizeof( headerData ) || LittleInt( *(unsigned int *)headerData ) != DDS_MAKEFOURCC( 'D', 'D', 'S', ' ' ) ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	ddsFileHeader_t *header = (ddsFileHeader_t *)( headerData + 4 );
+	R_SwapDDSHeader( header );
+
+	int numLevels = 1;
+	if ( header->dwFlags & DDSF_MIPMAPCOUNT ) {
+		numLevels = header->dwMipMapCount;
+	}
+
+	int format, externalFormat;
+	if ( numLevels < 2 || numLevels > MAX_TEXTURE_LEVELS || !R_DDSFormat( header, format, externalFormat ) ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	// the levels are stored from the largest to the smallest one
+	int offset = sizeof( headerData );
+	for ( int i = 0; i < numLevels; i++ ) {
+		streamLevelOffset[i] = offset;
+		offset += R_DDSLevelSize( format, header->ddspf.dwRGBBitCount, Max( (int)header->dwWidth >> i, 1 ), Max( (int)header->dwHeight >> i, 1 ) );
+	}
+	const int fileLength = f->Length();
+	if ( offset > fileLength ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	streamWidth = header->dwWidth;
+	streamHeight = header->dwHeight;
+	streamNumLevels = numLevels;
+	streamExternalFormat = externalFormat;
+	streamBitsPerPixel = header->ddspf.dwRGBBitCount;
+	internalFormat = format;
+
+	// skip the levels larger than the downsize limits, like UploadPrecompressedImage does
+	uploadWidth = streamWidth;
+	uploadHeight = streamHeight;
+	GetDownsize( uploadWidth, uploadHeight );
+	streamTopLevel = 0;
+	while ( streamTopLevel < numLevels - 1 && ( ( streamWidth >> streamTopLevel ) > uploadWidth || ( streamHeight >> streamTopLevel ) > uploadHeight ) ) {
+		streamTopLevel++;
+	}
+	uploadWidth = Max( streamWidth >> streamTopLevel, 1 );
+	uploadHeight = Max( streamHeight >> streamTopLevel, 1 );
+
+	// the small levels are loaded right away and never evicted
+	const int minSize = globalImages->image_streamingMinSize.GetInteger();
+	streamBaseLevel = numLevels - 1;
+	while ( streamBaseLevel > streamTopLevel && Max( streamWidth >> ( streamBaseLevel - 1 ), streamHeight >> ( streamBaseLevel - 1 ) ) <= minSize ) {
+		streamBaseLevel--;
+	}
+
+	const int len = offset - streamLevelOffset[streamBaseLevel];
+	byte *data = (byte *)R_StaticAlloc( len );
+	f->Seek( streamLevelOffset[streamBaseLevel], FS_SEEK_SET );
+	f->Read( data, len );
+	fileSystem->CloseFile( f );
+
+	type = TT_2D;
+	precompressedFile = true;
+
+	qglGenTextures( 1, &texnum );
+	streamResidentLevel = numLevels;
+	UploadStreamedLevels( data, streamBaseLevel, numLevels );
+	qglTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1 - streamTopLevel );
+	SetImageFilterAndRepeat();
+
+	R_StaticFree( data );
+
+	isStreamed = true;
+	streamRequestLevel = streamBaseLevel;
+	streamWantedLevel = numLevels;
+	streamLoadLevel = -1;
+	streamFrameUsed = 0;
+
+	return true;
+}
+
+/*
+===================
+UploadStreamedLevels
+
+Uploads the levels [firstLevel, lastLevel) of a streamed image, data starts with firstLevel.
+lastLevel has to be the current resident level, so the levels in the texture stay contiguous.
+===================
+*/
+void idImage::UploadStreamedLevels( const byte *data, int firstLevel, int lastLevel ) {
+	// bind directly, this isn't a use of the image
+	tmu_t *tmu = &backEnd.glState.tmu[backEnd.glState.currenttmu];
+	tmu->current2DMap = texnum;
+	qglBindTexture( GL_TEXTURE_2D, texnum );
+
+	for ( int i = firstLevel; i < lastLevel; i++ ) {
+		const int w = Max( streamWidth >> i, 1 );
+		const int h = Max( streamHeight >> i, 1 );
+		const int size = R_DDSLevelSize( internalFormat, streamBitsPerPixel, w, h );
+
+		if ( FormatIsDXT( internalFormat ) ) {
+			qglCompressedTexImage2DARB( GL_TEXTURE_2D, i - streamTopLevel, internalFormat, w, h, 0, size, data );
+		} else {
+			qglTexImage2D( GL_TEXTURE_2D, i - streamTopLevel, internalFormat, w, h, 0, streamExternalFormat, GL_UNSIGNED_BYTE, data );
+		}
+		data += size;
+	}
+
+	qglTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel - streamTopLevel );
+	streamResidentLevel = firstLevel;
+}
+
+/*
+===================
+EvictStreamedLevels
+
+Drops all levels that aren't always resident, returns the number of bytes freed
+===================
+*/
+int idImage::EvictStreamedLevels() {
+	const int freed = StreamedLevelBytes( streamResidentLevel ) - StreamedLevelBytes( streamBaseLevel );
+
+	tmu_t *tmu = &backEnd.glState.tmu[backEnd.glState.currenttmu];
+	tmu->current2DMap = texnum;
+	qglBindTexture( GL_TEXTURE_2D, texnum );
+
+	// move the base level first so the texture stays complete, then
+	// redefine the dropped levels as empty to release their storage
+	qglTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, streamBaseLevel - streamTopLevel );
+	for ( int i = streamResidentLevel; i < streamBaseLevel; i++ ) {
+		qglTexImage2D( GL_TEXTURE_2D, i - streamTopLevel, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+	}
+	streamResidentLevel = streamBaseLevel;
+
+	return freed;
+}
+
+/*
+===================
+RequestStreamedLevel
+
+Called on each bind of a streamed image to find the level the current surface needs
+===================
+*/
+void idImage::RequestStreamedLevel() {
+	// the scissor of the surface being drawn is the best estimate of its size on screen we have here
+	const idScreenRect &rect = backEnd.currentScissor;
+	const int pixels = ( Max( rect.x2 - rect.x1, rect.y2 - rect.y1 ) + 1 ) << Max( globalImages->image_streamingLodBias.GetInteger(), 0 );
+
+	// the smallest level that still covers the surface with one texel per pixel
+	int level = streamNumLevels - 1;
+	while ( level > streamTopLevel && Max( streamWidth >> level, streamHeight >> level ) < pixels ) {
+		level--;
+	}
+
+	if ( level < streamWantedLevel ) {
+		streamWantedLevel = level;
+	}
+	streamFrameUsed = backEnd.frameCount;
+}
+
+/*
+===================
+StreamedLevelBytes
+
+Bytes used by the levels from firstLevel down to the smallest one
+===================
+*/
+int idImage::StreamedLevelBytes( int firstLevel ) const {
+	const int lastLevel = streamNumLevels - 1;
+	return streamLevelOffset[lastLevel] - streamLevelOffset[firstLevel] +
+		R_DDSLevelSize( internalFormat, streamBitsPerPixel, Max( streamWidth >> lastLevel, 1 ), Max( streamHeight >> lastLevel, 1 ) );
+}
+
 /*
 ===============
 ActuallyLoadImage
@@ -1392,6 +1638,10 @@ void	idImage::ActuallyLoadImage( bool checkForPrecompressed, bool fromBackEnd )
 		// see if we have a pre-generated image file that is
 		// already image processed and compressed
 		if ( checkForPrecompressed && globalImages->image_usePrecompressedTextures.GetBool() ) {
+			if ( globalImages->image_streaming.GetBool() && LoadStreamedImage() ) {
+				// only the small levels, the rest follows when needed
+				return;
+			}
 			if ( CheckPrecompressedImage( true ) ) {
 				// we got the precompressed image
 				return;
@@ -1439,6 +1689,8 @@ void idImage::PurgeImage() {
 		}
 		texnum = TEXTURE_NOT_LOADED;
 	}
+	isStreamed = false;
+	backgroundLoadFailed = false;
 
 	// clear all the current binding caches, so the next bind will do a real one
 	for ( int i = 0 ; i < MAX_MULTITEXTURE_UNITS ; i++ ) {
@@ -1493,6 +1745,9 @@ void idImage::Bind() {
 		ActuallyLoadImage( true, true );	// check for precompressed, load is from back end
 	}
 
+	if ( isStreamed ) {
+		RequestStreamedLevel();
+	}
 
 	// bump our statistic counters
 	if ( r_showPrimitives.GetBool() && !backEnd.viewDef->IsLightGem() ) {
@@ -1583,6 +1838,9 @@ void idImage::BindFragment() {
 		ActuallyLoadImage( true, true );	// check for precompressed, load is from back end
 	}
 
+	if ( isStreamed ) {
+		RequestStreamedLevel();
+	}
 
 	// bump our statistic counters
 	frameUsed = backEnd.frameCount;
@@ -1766,6 +2024,10 @@ int idImage::StorageSize() const {
 		return 0;
 	}
 
+	if ( isStreamed ) {
+		return StreamedLevelBytes( streamResidentLevel );
+	}
+
 	switch ( type ) {
 	default:
 	case TT_2D:
@@ -1015,16 +1015,23 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 			// if the light has an optimized shadow volume, don't create shadows for any models that are part of the base areas
 			if ( lightDef->parms.prelightModel == NULL || !model->IsStaticWorldModel() || !r_useOptimizedShadows.GetBool() ) {
 
+				// if any surface is a shadow-casting perforated or translucent surface, or the
+				// base surface is suppressed in the view (world weapon shadows) we can't use
+				// the external shadow optimizations because we can see through some of the faces
+				bool noCapOptimization = shader->Coverage() != MC_OPAQUE || ( !r_skipSuppress.GetBool() && entityDef->parms.suppressSurfaceInViewID );
+
+				// R_AddModelSurfaces may queue the volume to build it on the frontend job list,
+				// the cull information is then freed once the job has finished
+				if ( R_QueueShadowVolume( entityDef, tri, lightDef, shadowGen, sint, noCapOptimization ) ) {
+					interactionGenerated = true;
+					continue;
+				}
+
 				// this is the only place during gameplay (outside the utilities) that R_CreateShadowVolume() is called
 				sint->shadowTris = R_CreateShadowVolume( entityDef, tri, lightDef, shadowGen, sint->cullInfo );
-				if ( sint->shadowTris ) {
-					if ( shader->Coverage() != MC_OPAQUE || ( !r_skipSuppress.GetBool() && entityDef->parms.suppressSurfaceInViewID ) ) {
-						// if any surface is a shadow-casting perforated or translucent surface, or the
-						// base surface is suppressed in the view (world weapon shadows) we can't use
-						// the external shadow optimizations because we can see through some of the faces
-						sint->shadowTris->numShadowIndexesNoCaps = sint->shadowTris->numIndexes;
-						sint->shadowTris->numShadowIndexesNoFrontCaps = sint->shadowTris->numIndexes;
-					}
+				if ( sint->shadowTris && noCapOptimization ) {
+					sint->shadowTris->numShadowIndexesNoCaps = sint->shadowTris->numIndexes;
+					sint->shadowTris->numShadowIndexesNoFrontCaps = sint->shadowTris->numIndexes;
 				}
 				interactionGenerated = true;
 			}
@@ -1127,12 +1134,24 @@ instantiate the dynamic model to find out
 ==================
 */
 void idInteraction::AddActiveInteraction( void ) {
+	idScreenRect	shadowScissor;
+
+	if ( PrepareActiveInteraction( shadowScissor ) ) {
+		LinkActiveInteraction( shadowScissor );
+	}
+}
+
+/*
+==================
+idInteraction::PrepareActiveInteraction
+
+Culls the interaction against the view and creates the surfaces
+if they have been deferred.  Returns false if there is nothing to add.
+==================
+*/
+bool idInteraction::PrepareActiveInteraction( idScreenRect &shadowScissor ) {
 	viewLight_t *	vLight;
 	viewEntity_t *	vEntity;
-	idScreenRect	shadowScissor;
-	idScreenRect	lightScissor;
-	idVec3			localLightOrigin;
-	idVec3			localViewOrigin;
 
 	vLight = lightDef->viewLight;
 	vEntity = entityDef->viewEntity;
@@ -1140,7 +1159,7 @@ void idInteraction::AddActiveInteraction( void ) {
 
 	// nbohr1more: #4379 lightgem culling
 	if ( !HasShadows() && !entityDef->parms.isLightgem && tr.viewDef->IsLightGem())
-		return;
+		return false;
 	
 	// do not waste time culling the interaction frustum if there will be no shadows
 	else if ( !HasShadows() ) {
@@ -1160,7 +1179,7 @@ void idInteraction::AddActiveInteraction( void ) {
 		// this will also cull the case where the light origin is inside the
 		// view frustum and the entity bounds are outside the view frustum
 		if ( CullInteractionByViewFrustum( tr.viewDef->viewFrustum ) ) {
-			return;
+			return false;
 		}
 
 		// calculate the shadow scissor rectangle
@@ -1169,7 +1188,7 @@ void idInteraction::AddActiveInteraction( void ) {
 
 	// get out before making the dynamic model if the shadow scissor rectangle is empty
 	if ( shadowScissor.IsEmpty() ) {
-		return;
+		return false;
 	}
 
 	// We will need the dynamic surface created to make interactions, even if the
@@ -1177,7 +1196,7 @@ void idInteraction::AddActiveInteraction( void ) {
 	// has been generated once in the view.
 	idRenderModel *model = R_EntityDefDynamicModel( entityDef );
 	if ( model == NULL || model->NumSurfaces() <= 0 ) {
-		return;
+		return false;
 	}
 
 	// the dynamic model may have changed since we built the surface list
@@ -1191,6 +1210,26 @@ void idInteraction::AddActiveInteraction( void ) {
 		CreateInteraction( model );
 	}
 
+	return true;
+}
+
+/*
+==================
+idInteraction::LinkActiveInteraction
+
+Links the light and shadow surfaces of a prepared interaction to the view light
+==================
+*/
+void idInteraction::LinkActiveInteraction( const idScreenRect &shadowScissor ) {
+	viewLight_t *	vLight;
+	viewEntity_t *	vEntity;
+	idScreenRect	lightScissor;
+	idVec3			localLightOrigin;
+	idVec3			localViewOrigin;
+
+	vLight = lightDef->viewLight;
+	vEntity = entityDef->viewEntity;
+
 	R_GlobalPointToLocal( vEntity->modelMatrix, lightDef->globalLightOrigin, localLightOrigin );
 	R_GlobalPointToLocal( vEntity->modelMatrix, tr.viewDef->renderView.vieworg, localViewOrigin );
 
@@ -133,6 +133,12 @@ public:
 	// calls R_LinkLightSurf() for each one
 	void					AddActiveInteraction( void );
 
+	// the two halves of AddActiveInteraction, split so R_AddModelSurfaces can build
+	// the shadow volumes queued by CreateInteraction in parallel before linking them
+	// returns false if the interaction is culled for this view
+	bool					PrepareActiveInteraction( idScreenRect &shadowScissor );
+	void					LinkActiveInteraction( const idScreenRect &shadowScissor );
+
 private:
 	enum {
 		FRUSTUM_UNINITIALIZED,
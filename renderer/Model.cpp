@@ -496,6 +496,16 @@ idRenderModel *idRenderModelStatic::InstantiateDynamicModel( const struct render
 	return NULL;
 }
 
+/*
+================
+idRenderModelStatic::PrepareDynamicModel
+================
+*/
+idRenderModel *idRenderModelStatic::PrepareDynamicModel( const struct renderEntity_s *ent, idRenderModel *cachedModel ) {
+	// the snapshot allocates whatever it needs in InstantiateDynamicModel
+	return cachedModel;
+}
+
 /*
 ================
 idRenderModelStatic::NumJoints
@@ -270,6 +270,11 @@ public:
 	// wasn't precached correctly.
 	virtual idRenderModel *		InstantiateDynamicModel( const struct renderEntity_s *ent, const struct viewDef_s *view, idRenderModel *cachedModel ) = 0;
 
+	// Allocates the surfaces and geometry InstantiateDynamicModel will fill in, so that the
+	// instantiation itself can run on a job thread without going through the triangle allocators.
+	// Returns the model to pass as cachedModel to InstantiateDynamicModel.
+	virtual idRenderModel *		PrepareDynamicModel( const struct renderEntity_s *ent, idRenderModel *cachedModel ) = 0;
+
 	// Returns the number of joints or 0 if the model is not an MD5
 	virtual int					NumJoints( void ) const = 0;
 
@@ -426,6 +426,9 @@ void idRenderModelManagerLocal::ReloadModels( bool forceAll ) {
 		common->Printf( "Checking for changed model files...\n" );
 	}
 
+	// loose models might have been added in front of the paks
+	fileSystem->ClearDirCache();
+
 	R_FreeDerivedData();
 
 	// skip the default model at index 0
@@ -256,6 +256,43 @@ void idMD5Mesh::TransformScaledVerts( idDrawVert *verts, const idJointMat *entJo
 	SIMDProcessor->TransformVerts( verts, texCoords.Num(), entJoints, scaledWeights, weightIndex, numWeights );
 }
 
+/*
+====================
+idMD5Mesh::PrepareSurface
+
+Makes sure the surface has all the memory UpdateSurface needs
+====================
+*/
+void idMD5Mesh::PrepareSurface( modelSurface_t *surf ) {
+	srfTriangles_t *tri = surf->geometry;
+
+	// if the number of verts and indexes are the same we can re-use the triangle surface
+	// the number of indexes must be the same to assure the correct amount of memory is allocated for the facePlanes
+	if ( tri && ( tri->numVerts != deformInfo->numOutputVerts || tri->numIndexes != deformInfo->numIndexes ) ) {
+		R_FreeStaticTriSurf( tri );
+		tri = NULL;
+	}
+
+	if ( !tri ) {
+		tri = surf->geometry = R_AllocStaticTriSurf();
+		tri->numVerts = deformInfo->numOutputVerts;
+		tri->numIndexes = deformInfo->numIndexes;
+	}
+
+	if ( tri->verts == NULL ) {
+		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
+		for ( int i = 0; i < deformInfo->numSourceVerts; i++ ) {
+			tri->verts[i].Clear();
+			tri->verts[i].st = texCoords[i];
+		}
+	}
+
+	// the face planes R_DeriveTangents would allocate, unsmoothed tangents don't use them
+	if ( tri->facePlanes == NULL && deformInfo->dominantTris == NULL && !r_useDeferredTangents.GetBool() ) {
+		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
+	}
+}
+
 /*
 ====================
 idMD5Mesh::UpdateSurface
@@ -266,27 +303,18 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 	srfTriangles_t *tri;
 
 	if ( r_showDynamic.GetBool() ) {
-		tr.pc.c_deformedSurfaces++;
-		tr.pc.c_deformedVerts += deformInfo->numOutputVerts;
-		tr.pc.c_deformedIndexes += deformInfo->numIndexes;
+		performanceCounters_t &pc = R_PerfCounters();
+		pc.c_deformedSurfaces++;
+		pc.c_deformedVerts += deformInfo->numOutputVerts;
+		pc.c_deformedIndexes += deformInfo->numIndexes;
 	}
 
 	surf->shader = shader;
 
-	if ( surf->geometry ) {
-		// if the number of verts and indexes are the same we can re-use the triangle surface
-		// the number of indexes must be the same to assure the correct amount of memory is allocated for the facePlanes
-		if ( surf->geometry->numVerts == deformInfo->numOutputVerts && surf->geometry->numIndexes == deformInfo->numIndexes ) {
-			R_FreeStaticTriSurfVertexCaches( surf->geometry );
-		} else {
-			R_FreeStaticTriSurf( surf->geometry );
-			surf->geometry = R_AllocStaticTriSurf();
-		}
-	} else {
-		surf->geometry = R_AllocStaticTriSurf();
-	}
+	PrepareSurface( surf );
 
 	tri = surf->geometry;
+	R_FreeStaticTriSurfVertexCaches( tri );
 
 	// note that some of the data is references, and should not be freed
 	tri->deformedSurface = true;
@@ -305,14 +333,6 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 	tri->dominantTris = deformInfo->dominantTris;
 	tri->numVerts = deformInfo->numOutputVerts;
 
-	if ( tri->verts == NULL ) {
-		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
-		for ( i = 0; i < deformInfo->numSourceVerts; i++ ) {
-			tri->verts[i].Clear();
-			tri->verts[i].st = texCoords[i];
-		}
-	}
-
 	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
 		TransformScaledVerts( tri->verts, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
 	} else {
@@ -711,7 +731,7 @@ idRenderModelMD5::InstantiateDynamicModel
 ====================
 */
 idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEntity_s *ent, const struct viewDef_s *view, idRenderModel *cachedModel ) {
-	int					i, surfaceNum;
+	int					i;
 	idMD5Mesh			*mesh;
 	idRenderModelStatic	*staticModel;
 
@@ -735,7 +755,7 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 		return NULL;
 	}
 
-	tr.pc.c_generateMd5++;
+	R_PerfCounters().c_generateMd5++;
 
 	if ( cachedModel ) {
 		assert( dynamic_cast<idRenderModelStatic *>(cachedModel) != NULL );
@@ -763,39 +783,90 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 
 	// create all the surfaces
 	for( mesh = meshes.Ptr(), i = 0; i < meshes.Num(); i++, mesh++ ) {
-		// avoid deforming the surface if it will be a nodraw due to a skin remapping
-		// FIXME: may have to still deform clipping hulls
-		const idMaterial *shader = mesh->shader;
-		
-		shader = R_RemapShaderBySkin( shader, ent->customSkin, ent->customShader );
-		
-		if ( !shader || ( !shader->IsDrawn() && !shader->SurfaceCastsShadow() ) ) {
-			staticModel->DeleteSurfaceWithId( i );
-			mesh->surfaceNum = -1;
+		modelSurface_t *surf = MeshSurface( ent, staticModel, i );
+		if ( !surf ) {
 			continue;
 		}
 
-		modelSurface_t *surf;
+		mesh->UpdateSurface( ent, ent->joints, surf );
 
-		if ( staticModel->FindSurfaceWithId( i, surfaceNum ) ) {
-			mesh->surfaceNum = surfaceNum;
-			surf = &staticModel->surfaces[surfaceNum];
-		} else {
+		staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
+		staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
+	}
 
-			// Remove Overlays before adding new surfaces
-			idRenderModelOverlay::RemoveOverlaySurfacesFromModel( staticModel );
+	return staticModel;
+}
 
-			mesh->surfaceNum = staticModel->NumSurfaces();
-			surf = &staticModel->surfaces.Alloc();
-			surf->geometry = NULL;
-			surf->shader = NULL;
-			surf->id = i;
-		}
+/*
+====================
+idRenderModelMD5::MeshSurface
 
-		mesh->UpdateSurface( ent, ent->joints, surf );
+Returns the surface of the snapshot for the given mesh, adding it if necessary.
+Returns NULL and removes the surface if the mesh isn't drawn with the skin of the entity.
+====================
+*/
+modelSurface_t *idRenderModelMD5::MeshSurface( const renderEntity_t *ent, idRenderModelStatic *staticModel, int meshNum ) {
+	idMD5Mesh *mesh = &meshes[meshNum];
+	int surfaceNum;
 
-		staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
-		staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
+	// avoid deforming the surface if it will be a nodraw due to a skin remapping
+	// FIXME: may have to still deform clipping hulls
+	const idMaterial *shader = mesh->shader;
+
+	shader = R_RemapShaderBySkin( shader, ent->customSkin, ent->customShader );
+
+	if ( !shader || ( !shader->IsDrawn() && !shader->SurfaceCastsShadow() ) ) {
+		staticModel->DeleteSurfaceWithId( meshNum );
+		mesh->surfaceNum = -1;
+		return NULL;
+	}
+
+	if ( staticModel->FindSurfaceWithId( meshNum, surfaceNum ) ) {
+		mesh->surfaceNum = surfaceNum;
+		return &staticModel->surfaces[surfaceNum];
+	}
+
+	// Remove Overlays before adding new surfaces
+	idRenderModelOverlay::RemoveOverlaySurfacesFromModel( staticModel );
+
+	mesh->surfaceNum = staticModel->NumSurfaces();
+	modelSurface_t *surf = &staticModel->surfaces.Alloc();
+	surf->geometry = NULL;
+	surf->shader = NULL;
+	surf->id = meshNum;
+	return surf;
+}
+
+/*
+====================
+idRenderModelMD5::PrepareDynamicModel
+
+Runs the allocating part of InstantiateDynamicModel on the calling thread
+====================
+*/
+idRenderModel *idRenderModelMD5::PrepareDynamicModel( const struct renderEntity_s *ent, idRenderModel *cachedModel ) {
+	// leave the unusual cases to InstantiateDynamicModel
+	if ( !r_useCachedDynamicModels.GetBool() || r_showSkel.GetInteger() > 1 || purged ) {
+		return cachedModel;
+	}
+	if ( !ent->joints || ent->numJoints != joints.Num() ) {
+		return cachedModel;
+	}
+
+	idRenderModelStatic *staticModel;
+	if ( cachedModel ) {
+		assert( dynamic_cast<idRenderModelStatic *>(cachedModel) != NULL );
+		staticModel = static_cast<idRenderModelStatic *>(cachedModel);
+	} else {
+		staticModel = new idRenderModelStatic;
+		staticModel->InitEmpty( MD5_SnapshotName );
+	}
+
+	for ( int i = 0; i < meshes.Num(); i++ ) {
+		modelSurface_t *surf = MeshSurface( ent, staticModel, i );
+		if ( surf ) {
+			meshes[i].PrepareSurface( surf );
+		}
 	}
 
 	return staticModel;
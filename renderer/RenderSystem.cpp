@@ -71,6 +71,13 @@ static void R_PerformanceCounters( void ) {
 			tr.pc.c_tangentIndexes/3,
 			tr.pc.c_guiSurfs
 			); 
+		common->Printf( "addModels:%5.2f ms (instantiate:%5.2f ms shadowVolumes:%5.2f ms) parallelModels:%i parallelShadows:%i\n",
+			tr.pc.addModelsUsec * 0.001f,
+			tr.pc.dynamicModelsUsec * 0.001f,
+			tr.pc.shadowVolumesUsec * 0.001f,
+			tr.pc.c_parallelDynamicModels,
+			tr.pc.c_parallelShadowVolumes
+			);
 	}
 
 	if ( r_showCull.GetBool() ) {
@@ -100,6 +107,7 @@ static void R_PerformanceCounters( void ) {
 		int m0 = frameData ? frameData->frameMemoryAllocated.load() : 0;
 		int	m1 = frameData ? frameData->memoryHighwater : 0;
 		common->Printf( "frameData: %i (%i)\n", m0, m1 );
+		R_PrintFrameMemoryStats();
 	}
 
 	memset( &tr.pc, 0, sizeof( tr.pc ) );
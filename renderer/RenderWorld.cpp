@@ -122,6 +122,8 @@ idRenderWorldLocal::idRenderWorldLocal() {
 	areaNodes = NULL;
 	numAreaNodes = 0;
 
+	portalSoundGeneration = 0;
+
 	//portalAreas = NULL;
 	//numPortalAreas = 0;
 
@@ -831,7 +833,10 @@ void idRenderWorldLocal::SetPortalPlayerLoss( qhandle_t portal, float loss ) //
 	{
 		common->Error( "SetPortalPlayerLoss: bad portal number %i", portal );
 	}
-	doublePortals[portal-1].lossPlayer = loss; // grayman #3042
+	if ( doublePortals[portal-1].lossPlayer != loss ) {
+		doublePortals[portal-1].lossPlayer = loss; // grayman #3042
+		portalSoundGeneration++;
+	}
 
 	if ( session->writeDemo )
 	{
@@ -1462,7 +1467,7 @@ void idRenderWorldLocal::GenerateAllInteractions() {
 	int end = Sys_Milliseconds();
 	int	msec = end - start;
 
-	common->Printf( "idRenderWorld::GenerateAllInteractions, msec = %i, staticAllocCount = %i.\n", msec, tr.staticAllocCount );
+	common->Printf( "idRenderWorld::GenerateAllInteractions, msec = %i, staticAllocCount = %i.\n", msec, tr.staticAllocCount.load() );
 #endif
 
 	// build the interaction table
@@ -27,6 +27,10 @@
 #define PROC_FILE_EXT				"proc"
 #define	PROC_FILE_ID				"mapProcFile003"
 
+// binary copy of the .proc file written on the first load
+#define BPROC_FILE_EXT				"bproc"
+#define BPROC_FILE_ID				"mapProcBinary001"
+
 // portals
 #define NUM_PORTAL_ATTRIBUTES		4 // grayman #3042 - was 3, but I added PS_BLOCK_SOUND
 
@@ -342,6 +346,10 @@ public:
 	// grayman #3042 - set portal sound loss (in dB)
 	virtual void			SetPortalPlayerLoss( qhandle_t portal, float loss ) = 0;
 
+	// changes whenever a portal state or sound loss changes or a new map is loaded,
+	// so the sound system can reuse its portal flooding results until then
+	virtual int				GetPortalSoundGeneration( void ) const = 0;
+
 	// returns true only if a chain of portals without the given connection bits set
 	// exists between the two areas (a door doesn't separate them, etc)
 	virtual	bool			AreasAreConnected( int areaNum1, int areaNum2, portalConnection_t connection ) = 0;
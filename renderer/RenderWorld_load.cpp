@@ -57,6 +57,9 @@ void idRenderWorldLocal::FreeWorld() {
 	portalAreas.clear();
 	doublePortals.clear();
 
+	// never reused, so results cached for the old map don't match the next one
+	portalSoundGeneration++;
+
 	if ( areaNodes ) {
 		R_StaticFree( areaNodes );
 		areaNodes = NULL;
@@ -89,12 +92,21 @@ void idRenderWorldLocal::TouchWorldModels( void ) {
 	}
 }
 
+// chunks of a .bproc file, in the order the .proc file had them
+enum {
+	BPROC_END,
+	BPROC_MODEL,
+	BPROC_SHADOW_MODEL,
+	BPROC_INTER_AREA_PORTALS,
+	BPROC_NODES
+};
+
 /*
 ================
 idRenderWorldLocal::ParseModel
 ================
 */
-idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
+idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src, idFile *binary ) {
 	idRenderModel	*model;
 	idToken			token;
 	int				i, j;
@@ -114,6 +126,12 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 		src->Error( "R_ParseModel: bad numSurfaces" );
 	}
 
+	if ( binary ) {
+		binary->WriteInt( BPROC_MODEL );
+		binary->WriteString( token );
+		binary->WriteInt( numSurfaces );
+	}
+
 	for ( i = 0 ; i < numSurfaces ; i++ ) {
 		src->ExpectTokenString( "{" );
 
@@ -129,6 +147,12 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 		tri->numVerts = src->ParseInt();
 		tri->numIndexes = src->ParseInt();
 
+		if ( binary ) {
+			binary->WriteString( token );
+			binary->WriteInt( tri->numVerts );
+			binary->WriteInt( tri->numIndexes );
+		}
+
 		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
 		for ( j = 0 ; j < tri->numVerts ; j++ ) {
 			float	vec[8];
@@ -143,6 +167,10 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 			tri->verts[j].normal[0] = vec[5];
 			tri->verts[j].normal[1] = vec[6];
 			tri->verts[j].normal[2] = vec[7];
+
+			if ( binary ) {
+				binary->Write( vec, sizeof( vec ) );
+			}
 		}
 
 		R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
@@ -151,6 +179,10 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 		}
 		src->ExpectTokenString( "}" );
 
+		if ( binary ) {
+			binary->Write( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+		}
+
 		// add the completed surface to the model
 		model->AddSurface( surf );
 	}
@@ -167,7 +199,7 @@ idRenderModel *idRenderWorldLocal::ParseModel( idLexer *src ) {
 idRenderWorldLocal::ParseShadowModel
 ================
 */
-idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src ) {
+idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src, idFile *binary ) {
 	idRenderModel	*model;
 	idToken			token;
 	int				j;
@@ -193,6 +225,16 @@ idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src ) {
 	tri->numIndexes = src->ParseInt();
 	tri->shadowCapPlaneBits = src->ParseInt();
 
+	if ( binary ) {
+		binary->WriteInt( BPROC_SHADOW_MODEL );
+		binary->WriteString( token );
+		binary->WriteInt( tri->numVerts );
+		binary->WriteInt( tri->numShadowIndexesNoCaps );
+		binary->WriteInt( tri->numShadowIndexesNoFrontCaps );
+		binary->WriteInt( tri->numIndexes );
+		binary->WriteInt( tri->shadowCapPlaneBits );
+	}
+
 	R_AllocStaticTriSurfShadowVerts( tri, tri->numVerts );
 	tri->bounds.Clear();
 	for ( j = 0 ; j < tri->numVerts ; j++ ) {
@@ -205,6 +247,10 @@ idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src ) {
 		tri->shadowVertexes[j].xyz[3] = 1;		// no homogenous value
 
 		tri->bounds.AddPoint( tri->shadowVertexes[j].xyz.ToVec3() );
+
+		if ( binary ) {
+			binary->Write( vec, 3 * sizeof( vec[0] ) );
+		}
 	}
 
 	R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
@@ -212,6 +258,10 @@ idRenderModel *idRenderWorldLocal::ParseShadowModel( idLexer *src ) {
 		tri->indexes[j] = src->ParseInt();
 	}
 
+	if ( binary ) {
+		binary->Write( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+	}
+
 	// add the completed surface to the model
 	model->AddSurface( surf );
 
@@ -243,12 +293,65 @@ void idRenderWorldLocal::SetupAreaRefs() {
 	}
 }
 
+/*
+================
+idRenderWorldLocal::AllocPortals
+================
+*/
+void idRenderWorldLocal::AllocPortals( int numPortalAreas, int numInterAreaPortals ) {
+	portalAreas.resize( numPortalAreas );// = (portalArea_t *)R_ClearedStaticAlloc( numPortalAreas * sizeof( portalAreas[0] ) );
+	//areaScreenRect.resize( numPortalAreas );// = (idScreenRect *)R_ClearedStaticAlloc( numPortalAreas * sizeof( idScreenRect ) );
+
+	// set the doubly linked lists
+	SetupAreaRefs();
+
+	doublePortals.resize( numInterAreaPortals );// = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals * sizeof( doublePortals [0] ) );
+}
+
+/*
+================
+idRenderWorldLocal::LinkInterAreaPortal
+
+Sets up both sides of a portal from the winding stored in its first portal
+================
+*/
+void idRenderWorldLocal::LinkInterAreaPortal( int index, int a1, int a2 ) {
+	portal_t	*p = &doublePortals[index].portals[0];
+	idWinding	*w = &p->w;
+
+	// add the portal to a1
+	//p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+	p->intoArea = a2;
+	p->doublePortal = &doublePortals[index];
+	//p->w = w;
+	p->w.GetPlane( p->plane );
+
+	//p->next = portalAreas[a1].portals;
+	portalAreas[a1].areaPortals.push_back(p);
+
+	//doublePortals[i].portals[0] = p;
+
+	// reverse it for a2
+	//p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+	p++;
+	p->intoArea = a1;
+	p->doublePortal = &doublePortals[index];
+	p->w = *w;
+	p->w.ReverseSelf();
+	p->w.GetPlane( p->plane );
+
+	//p->next = portalAreas[a2].portals;
+	portalAreas[a2].areaPortals.push_back(p);
+
+	//doublePortals[i].portals[1] = p;
+}
+
 /*
 ================
 idRenderWorldLocal::ParseInterAreaPortals
 ================
 */
-void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
+void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src, idFile *binary ) {
 	int i, j;
 
 	src->ExpectTokenString( "{" );
@@ -258,11 +361,6 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 		src->Error( "R_ParseInterAreaPortals: bad numPortalAreas" );
 		return;
 	}
-	portalAreas.resize( numPortalAreas );// = (portalArea_t *)R_ClearedStaticAlloc( numPortalAreas * sizeof( portalAreas[0] ) );
-	//areaScreenRect.resize( numPortalAreas );// = (idScreenRect *)R_ClearedStaticAlloc( numPortalAreas * sizeof( idScreenRect ) );
-
-	// set the doubly linked lists
-	SetupAreaRefs();
 
 	auto numInterAreaPortals = src->ParseInt();
 	if ( numInterAreaPortals < 0 ) {
@@ -270,17 +368,28 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 		return;
 	}
 
-	doublePortals.resize( numInterAreaPortals );// = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals * sizeof( doublePortals [0] ) );
+	AllocPortals( numPortalAreas, numInterAreaPortals );
+
+	if ( binary ) {
+		binary->WriteInt( BPROC_INTER_AREA_PORTALS );
+		binary->WriteInt( numPortalAreas );
+		binary->WriteInt( numInterAreaPortals );
+	}
 
 	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
 		int		numPoints, a1, a2;
-		portal_t	*p = &doublePortals[i].portals[0];
-		idWinding	*w = &p->w;
+		idWinding	*w = &doublePortals[i].portals[0].w;
 
 		numPoints = src->ParseInt();
 		a1 = src->ParseInt();
 		a2 = src->ParseInt();
 
+		if ( binary ) {
+			binary->WriteInt( numPoints );
+			binary->WriteInt( a1 );
+			binary->WriteInt( a2 );
+		}
+
 		//w = new idWinding( numPoints );
 		w->SetNumPoints( numPoints );
 		for ( j = 0 ; j < numPoints ; j++ ) {
@@ -288,33 +397,13 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 			// no texture coordinates
 			(*w)[j][3] = 0;
 			(*w)[j][4] = 0;
-		}
-
-		// add the portal to a1
-		//p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
-		p->intoArea = a2;
-		p->doublePortal = &doublePortals[i];
-		//p->w = w;
-		p->w.GetPlane( p->plane );
 
-		//p->next = portalAreas[a1].portals;
-		portalAreas[a1].areaPortals.push_back(p);
-
-		//doublePortals[i].portals[0] = p;
-
-		// reverse it for a2
-		//p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
-		p++;
-		p->intoArea = a1;
-		p->doublePortal = &doublePortals[i];
-		p->w = *w;
-		p->w.ReverseSelf();
-		p->w.GetPlane( p->plane );
-
-		//p->next = portalAreas[a2].portals;
-		portalAreas[a2].areaPortals.push_back(p);
+			if ( binary ) {
+				binary->Write( (*w)[j].ToFloatPtr(), 3 * sizeof( float ) );
+			}
+		}
 
-		//doublePortals[i].portals[1] = p;
+		LinkInterAreaPortal( i, a1, a2 );
 	}
 
 	src->ExpectTokenString( "}" );
@@ -325,7 +414,7 @@ void idRenderWorldLocal::ParseInterAreaPortals( idLexer *src ) {
 idRenderWorldLocal::ParseNodes
 ================
 */
-void idRenderWorldLocal::ParseNodes( idLexer *src ) {
+void idRenderWorldLocal::ParseNodes( idLexer *src, idFile *binary ) {
 	int			i;
 
 	src->ExpectTokenString( "{" );
@@ -347,6 +436,327 @@ void idRenderWorldLocal::ParseNodes( idLexer *src ) {
 	}
 
 	src->ExpectTokenString( "}" );
+
+	if ( binary ) {
+		binary->WriteInt( BPROC_NODES );
+		binary->WriteInt( numAreaNodes );
+		for ( i = 0 ; i < numAreaNodes ; i++ ) {
+			binary->Write( areaNodes[i].plane.ToFloatPtr(), 4 * sizeof( float ) );
+			binary->Write( areaNodes[i].children, sizeof( areaNodes[i].children ) );
+		}
+	}
+}
+
+/*
+================
+BinaryProcCountValid
+
+Makes sure the rest of a .bproc file can hold count elements of the given size
+================
+*/
+static bool BinaryProcCountValid( idFile *f, int count, int elementSize ) {
+	return count >= 0 && count <= ( f->Length() - f->Tell() ) / elementSize;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryModel
+================
+*/
+idRenderModel *idRenderWorldLocal::ReadBinaryModel( idFile *f ) {
+	idRenderModel	*model;
+	idStr			name;
+	int				i, j, numSurfaces;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+	idList<float>	vecs;
+
+	f->ReadString( name );
+	f->ReadInt( numSurfaces );
+	if ( !BinaryProcCountValid( f, numSurfaces, 3 * sizeof( int ) ) ) {
+		return NULL;
+	}
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( name );
+
+	for ( i = 0 ; i < numSurfaces ; i++ ) {
+		int numVerts, numIndexes;
+
+		f->ReadString( name );
+		f->ReadInt( numVerts );
+		f->ReadInt( numIndexes );
+		if ( !BinaryProcCountValid( f, numVerts, 8 * sizeof( float ) ) || !BinaryProcCountValid( f, numIndexes, sizeof( glIndex_t ) ) ) {
+			delete model;
+			return NULL;
+		}
+
+		surf.shader = declManager->FindMaterial( name );
+
+		((idMaterial*)surf.shader)->AddReference();
+
+		tri = R_AllocStaticTriSurf();
+		surf.geometry = tri;
+
+		tri->numVerts = numVerts;
+		tri->numIndexes = numIndexes;
+
+		vecs.SetNum( tri->numVerts * 8, false );
+		f->Read( vecs.Ptr(), tri->numVerts * 8 * sizeof( float ) );
+
+		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
+		for ( j = 0 ; j < tri->numVerts ; j++ ) {
+			const float *vec = &vecs[j * 8];
+
+			tri->verts[j].xyz[0] = vec[0];
+			tri->verts[j].xyz[1] = vec[1];
+			tri->verts[j].xyz[2] = vec[2];
+			tri->verts[j].st[0] = vec[3];
+			tri->verts[j].st[1] = vec[4];
+			tri->verts[j].normal[0] = vec[5];
+			tri->verts[j].normal[1] = vec[6];
+			tri->verts[j].normal[2] = vec[7];
+		}
+
+		R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+		f->Read( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+
+		// add the completed surface to the model
+		model->AddSurface( surf );
+	}
+
+	model->FinishSurfaces();
+
+	return model;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryShadowModel
+================
+*/
+idRenderModel *idRenderWorldLocal::ReadBinaryShadowModel( idFile *f ) {
+	idRenderModel	*model;
+	idStr			name;
+	int				j, numVerts, numIndexes;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+	idList<float>	vecs;
+
+	f->ReadString( name );
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( name );
+
+	surf.shader = tr.defaultMaterial;
+
+	tri = R_AllocStaticTriSurf();
+	surf.geometry = tri;
+
+	f->ReadInt( numVerts );
+	f->ReadInt( tri->numShadowIndexesNoCaps );
+	f->ReadInt( tri->numShadowIndexesNoFrontCaps );
+	f->ReadInt( numIndexes );
+	f->ReadInt( tri->shadowCapPlaneBits );
+	if ( !BinaryProcCountValid( f, numVerts, 3 * sizeof( float ) ) || !BinaryProcCountValid( f, numIndexes, sizeof( glIndex_t ) ) ) {
+		R_FreeStaticTriSurf( tri );
+		delete model;
+		return NULL;
+	}
+	tri->numVerts = numVerts;
+	tri->numIndexes = numIndexes;
+
+	vecs.SetNum( tri->numVerts * 3, false );
+	f->Read( vecs.Ptr(), tri->numVerts * 3 * sizeof( float ) );
+
+	R_AllocStaticTriSurfShadowVerts( tri, tri->numVerts );
+	tri->bounds.Clear();
+	for ( j = 0 ; j < tri->numVerts ; j++ ) {
+		const float *vec = &vecs[j * 3];
+
+		tri->shadowVertexes[j].xyz[0] = vec[0];
+		tri->shadowVertexes[j].xyz[1] = vec[1];
+		tri->shadowVertexes[j].xyz[2] = vec[2];
+		tri->shadowVertexes[j].xyz[3] = 1;		// no homogenous value
+
+		tri->bounds.AddPoint( tri->shadowVertexes[j].xyz.ToVec3() );
+	}
+
+	R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+	f->Read( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+
+	// add the completed surface to the model
+	model->AddSurface( surf );
+
+	return model;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryInterAreaPortals
+================
+*/
+bool idRenderWorldLocal::ReadBinaryInterAreaPortals( idFile *f ) {
+	int i, j, numPortalAreas, numInterAreaPortals;
+	idList<float> points;
+
+	f->ReadInt( numPortalAreas );
+	f->ReadInt( numInterAreaPortals );
+	if ( numPortalAreas < 0 || !BinaryProcCountValid( f, numInterAreaPortals, 3 * sizeof( int ) ) ) {
+		return false;
+	}
+
+	AllocPortals( numPortalAreas, numInterAreaPortals );
+
+	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
+		int		numPoints, a1, a2;
+		idWinding	*w = &doublePortals[i].portals[0].w;
+
+		f->ReadInt( numPoints );
+		f->ReadInt( a1 );
+		f->ReadInt( a2 );
+		if ( !BinaryProcCountValid( f, numPoints, 3 * sizeof( float ) ) ||
+				a1 < 0 || a1 >= numPortalAreas || a2 < 0 || a2 >= numPortalAreas ) {
+			return false;
+		}
+
+		points.SetNum( numPoints * 3, false );
+		f->Read( points.Ptr(), numPoints * 3 * sizeof( float ) );
+
+		w->SetNumPoints( numPoints );
+		for ( j = 0 ; j < numPoints ; j++ ) {
+			(*w)[j][0] = points[j * 3 + 0];
+			(*w)[j][1] = points[j * 3 + 1];
+			(*w)[j][2] = points[j * 3 + 2];
+			// no texture coordinates
+			(*w)[j][3] = 0;
+			(*w)[j][4] = 0;
+		}
+
+		LinkInterAreaPortal( i, a1, a2 );
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryNodes
+================
+*/
+bool idRenderWorldLocal::ReadBinaryNodes( idFile *f ) {
+	int			i;
+
+	f->ReadInt( numAreaNodes );
+	if ( !BinaryProcCountValid( f, numAreaNodes, 4 * sizeof( float ) + 2 * sizeof( int ) ) ) {
+		numAreaNodes = 0;
+		return false;
+	}
+	areaNodes = (areaNode_t *)R_ClearedStaticAlloc( numAreaNodes * sizeof( areaNodes[0] ) );
+
+	for ( i = 0 ; i < numAreaNodes ; i++ ) {
+		areaNode_t	*node = &areaNodes[i];
+
+		f->Read( node->plane.ToFloatPtr(), 4 * sizeof( float ) );
+		f->Read( node->children, sizeof( node->children ) );
+
+		// CommonChildrenArea_r recurses into positive children
+		if ( node->children[0] >= numAreaNodes || node->children[1] >= numAreaNodes ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::LoadBinaryProc
+
+Loads the world from a .bproc file written by an earlier text load.
+Returns false if the file is missing, belongs to a different .proc file or is broken.
+================
+*/
+bool idRenderWorldLocal::LoadBinaryProc( const char *filename, int procLength, unsigned int procChecksum ) {
+	const char *	buffer;
+	idStr			ident;
+	int				length, sourceLength, chunk;
+	unsigned int	sourceChecksum;
+	idRenderModel *	lastModel;
+	bool			valid;
+
+	length = fileSystem->ReadFileView( filename, (const void **)&buffer );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	// the file ends with its own length, anything else was cut off while writing
+	int storedLength = 0;
+	if ( length >= (int)sizeof( int ) ) {
+		memcpy( &storedLength, buffer + length - sizeof( int ), sizeof( int ) );
+	}
+	if ( storedLength != length ) {
+		common->Warning( "idRenderWorldLocal::InitFromMap: %s is truncated", filename );
+		fileSystem->FreeFileView( buffer );
+		return false;
+	}
+
+	idFile_Memory f( filename, buffer, length - sizeof( int ) );
+
+	f.ReadString( ident );
+	f.ReadInt( sourceLength );
+	f.ReadUnsignedInt( sourceChecksum );
+	if ( ident != BPROC_FILE_ID || sourceLength != procLength || sourceChecksum != procChecksum ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s is outdated\n", filename );
+		fileSystem->FreeFileView( buffer );
+		return false;
+	}
+
+	valid = true;
+	while ( valid ) {
+		if ( f.ReadInt( chunk ) != sizeof( chunk ) ) {
+			valid = false;
+			break;
+		}
+
+		if ( chunk == BPROC_END ) {
+			break;
+		}
+
+		switch ( chunk ) {
+			case BPROC_MODEL:
+			case BPROC_SHADOW_MODEL:
+				lastModel = ( chunk == BPROC_MODEL ) ? ReadBinaryModel( &f ) : ReadBinaryShadowModel( &f );
+				if ( !lastModel ) {
+					valid = false;
+					break;
+				}
+
+				// add it to the model manager list
+				renderModelManager->AddModel( lastModel );
+
+				// save it in the list to free when clearing this map
+				localModels.Append( lastModel );
+				break;
+			case BPROC_INTER_AREA_PORTALS:
+				valid = ReadBinaryInterAreaPortals( &f );
+				break;
+			case BPROC_NODES:
+				valid = ReadBinaryNodes( &f );
+				break;
+			default:
+				valid = false;
+				break;
+		}
+	}
+
+	fileSystem->FreeFileView( buffer );
+
+	if ( !valid ) {
+		common->Warning( "idRenderWorldLocal::InitFromMap: %s is broken, loading the .%s file", filename, PROC_FILE_EXT );
+	}
+
+	return valid;
 }
 
 /*
@@ -458,6 +868,7 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 	idLexer *		src;
 	idToken			token;
 	idStr			filename;
+	idStr			binaryFilename;
 	idRenderModel *	lastModel;
 
 	// if this is an empty world, initialize manually
@@ -492,13 +903,15 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 
 	FreeWorld();
 
-	src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
-	if ( !src->IsLoaded() ) {
+	// the text is read even if the binary copy is used, the copy is validated against it
+	char *procText;
+	int procLength = fileSystem->ReadFile( filename, (void **)&procText );
+	if ( procLength < 0 ) {
 		common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
 		ClearWorld();
 		return false;
 	}
-
+	unsigned int procChecksum = CRC32_BlockChecksum( procText, procLength );
 
 	mapName = name;
 	mapTimeStamp = currentTimeStamp;
@@ -508,54 +921,90 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 		WriteLoadMap();
 	}
 
-	if ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) {
-		common->Printf( "idRenderWorldLocal::InitFromMap: bad id '%s' instead of '%s'\n", token.c_str(), PROC_FILE_ID );
-		delete src;
-		return false;
-	}
+	binaryFilename = name;
+	binaryFilename.SetFileExtension( BPROC_FILE_EXT );
 
-	// parse the file
-	while ( 1 ) {
-		if ( !src->ReadToken( &token ) ) {
-			break;
+	if ( r_useBinaryProc.GetBool() && LoadBinaryProc( binaryFilename, procLength, procChecksum ) ) {
+		fileSystem->FreeFile( procText );
+	} else {
+		if ( portalAreas.size() || localModels.Num() || areaNodes ) {
+			// drop whatever a broken binary file managed to create
+			FreeWorld();
+			mapName = name;
+			mapTimeStamp = currentTimeStamp;
 		}
 
-		if ( token == "model" ) {
-			lastModel = ParseModel( src );
+		src = new idLexer( LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
+		src->LoadMemory( procText, procLength, filename );
 
-			// add it to the model manager list
-			renderModelManager->AddModel( lastModel );
+		if ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) {
+			common->Printf( "idRenderWorldLocal::InitFromMap: bad id '%s' instead of '%s'\n", token.c_str(), PROC_FILE_ID );
+			delete src;
+			fileSystem->FreeFile( procText );
+			return false;
+		}
 
-			// save it in the list to free when clearing this map
-			localModels.Append( lastModel );
-			continue;
+		// the binary copy is built while parsing and only written once the whole file parsed
+		idFile_Memory *binary = NULL;
+		if ( r_useBinaryProc.GetBool() ) {
+			binary = new idFile_Memory( binaryFilename );
+			binary->SetGranularity( 1 << 20 );
+			binary->WriteString( BPROC_FILE_ID );
+			binary->WriteInt( procLength );
+			binary->WriteUnsignedInt( procChecksum );
 		}
 
-		if ( token == "shadowModel" ) {
-			lastModel = ParseShadowModel( src );
+		// parse the file
+		while ( 1 ) {
+			if ( !src->ReadToken( &token ) ) {
+				break;
+			}
 
-			// add it to the model manager list
-			renderModelManager->AddModel( lastModel );
+			if ( token == "model" ) {
+				lastModel = ParseModel( src, binary );
 
-			// save it in the list to free when clearing this map
-			localModels.Append( lastModel );
-			continue;
-		}
+				// add it to the model manager list
+				renderModelManager->AddModel( lastModel );
 
-		if ( token == "interAreaPortals" ) {
-			ParseInterAreaPortals( src );
-			continue;
-		}
+				// save it in the list to free when clearing this map
+				localModels.Append( lastModel );
+				continue;
+			}
+
+			if ( token == "shadowModel" ) {
+				lastModel = ParseShadowModel( src, binary );
 
-		if ( token == "nodes" ) {
-			ParseNodes( src );
-			continue;
+				// add it to the model manager list
+				renderModelManager->AddModel( lastModel );
+
+				// save it in the list to free when clearing this map
+				localModels.Append( lastModel );
+				continue;
+			}
+
+			if ( token == "interAreaPortals" ) {
+				ParseInterAreaPortals( src, binary );
+				continue;
+			}
+
+			if ( token == "nodes" ) {
+				ParseNodes( src, binary );
+				continue;
+			}
+
+			src->Error( "idRenderWorldLocal::InitFromMap: bad token \"%s\"", token.c_str() );
 		}
 
-		src->Error( "idRenderWorldLocal::InitFromMap: bad token \"%s\"", token.c_str() );
-	}
+		delete src;
+		fileSystem->FreeFile( procText );
 
-	delete src;
+		if ( binary ) {
+			binary->WriteInt( BPROC_END );
+			binary->WriteInt( binary->Length() + sizeof( int ) );
+			fileSystem->WriteFile( binaryFilename, binary->GetDataPtr(), binary->Length() );
+			delete binary;
+		}
+	}
 
 	// if it was a trivial map without any areas, create a single area
 	if ( !portalAreas.size() ) {
@@ -171,6 +171,7 @@ public:
 	std::vector<portalArea_t> portalAreas;
 	//int						numPortalAreas;
 	int						connectedAreaNum;		// incremented every time a door portal state changes
+	int						portalSoundGeneration;	// incremented every time a portal state or sound loss changes
 
 	std::vector<doublePortal_t>	doublePortals;
 	//int						numInterAreaPortals;
@@ -198,11 +199,18 @@ public:
 	//-----------------------
 	// RenderWorld_load.cpp
 
-	idRenderModel *			ParseModel( idLexer *src );
-	idRenderModel *			ParseShadowModel( idLexer *src );
+	idRenderModel *			ParseModel( idLexer *src, idFile *binary );
+	idRenderModel *			ParseShadowModel( idLexer *src, idFile *binary );
 	void					SetupAreaRefs();
-	void					ParseInterAreaPortals( idLexer *src );
-	void					ParseNodes( idLexer *src );
+	void					AllocPortals( int numPortalAreas, int numInterAreaPortals );
+	void					LinkInterAreaPortal( int index, int a1, int a2 );
+	void					ParseInterAreaPortals( idLexer *src, idFile *binary );
+	void					ParseNodes( idLexer *src, idFile *binary );
+	idRenderModel *			ReadBinaryModel( idFile *f );
+	idRenderModel *			ReadBinaryShadowModel( idFile *f );
+	bool					ReadBinaryInterAreaPortals( idFile *f );
+	bool					ReadBinaryNodes( idFile *f );
+	bool					LoadBinaryProc( const char *filename, int procLength, unsigned int procChecksum );
 	int						CommonChildrenArea_r( areaNode_t *node );
 	void					FreeWorld();
 	void					ClearWorld();
@@ -236,6 +244,7 @@ public:
 	qhandle_t				FindPortal( const idBounds &b ) const;
 	void					SetPortalState( qhandle_t portal, int blockingBits );
 	int						GetPortalState( qhandle_t portal );
+	int						GetPortalSoundGeneration( void ) const { return portalSoundGeneration; }
 
 	bool					AreasAreConnected( int areaNum1, int areaNum2, portalConnection_t connection );
 	void					FloodConnectedAreas( portalArea_t *area, int portalAttributeIndex );
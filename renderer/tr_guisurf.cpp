@@ -191,6 +191,9 @@ void R_ReloadGuis_f( const idCmdArgs &args ) {
 		common->Printf( "Checking for changed gui files...\n" );
 	}
 
+	// loose guis might have been added in front of the paks
+	fileSystem->ClearDirCache();
+
 	uiManager->Reload( all );
 }
 
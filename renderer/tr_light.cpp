@@ -906,15 +906,15 @@ bool R_IssueEntityDefCallback( idRenderEntityLocal *def ) {
 
 /*
 ===================
-R_EntityDefDynamicModel
+R_PrepareEntityDefDynamicModel
 
-Issues a deferred entity callback if necessary.
-If the model isn't dynamic, it returns the original.
-Returns the cached dynamic model if present, otherwise creates
-it and any necessary overlays
+Issues a deferred entity callback if necessary and throws away the
+snapshot of the dynamic model if it is out of date.
+Returns true if a new snapshot has to be generated with
+R_InstantiateEntityDefDynamicModel
 ===================
 */
-idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
+static bool R_PrepareEntityDefDynamicModel( idRenderEntityLocal *def ) {
 
 	bool callbackUpdate = false;
 
@@ -927,13 +927,13 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 
 	if ( !model ) {
 		common->Error( "R_EntityDefDynamicModel: NULL model" );
-		return renderModelManager->DefaultModel();
+		return false;
 	}
 
 	else if ( model->IsDynamicModel() == DM_STATIC ) {
 		def->dynamicModel = NULL;
 		def->dynamicModelFrameCount = 0;
-		return model;
+		return false;
 	}
 
 	// continously animating models (particle systems, etc) will have their snapshot updated every single view
@@ -941,36 +941,93 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 		R_ClearEntityDefDynamicModel( def );
 	}
 
-	// if we don't have a snapshot of the dynamic model, generate it now
-	if ( !def->dynamicModel ) {
+	// if we don't have a snapshot of the dynamic model, it has to be generated now
+	return ( def->dynamicModel == NULL );
+}
+
+/*
+===================
+R_InstantiateEntityDefDynamicModel
 
-		// instantiate the snapshot of the dynamic model, possibly reusing memory from the cached snapshot
-		def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
+Creates the snapshot of the dynamic model and any necessary overlays.
+Only the entityDef itself is modified, so this is also run as a job
+on the frontend job list by R_InstantiateDynamicModels
+===================
+*/
+static void R_InstantiateEntityDefDynamicModel( idRenderEntityLocal *def ) {
+	idRenderModel *model = def->parms.hModel;
 
-		if ( def->cachedDynamicModel ) {
+	// instantiate the snapshot of the dynamic model, possibly reusing memory from the cached snapshot
+	def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
 
-			// add any overlays to the snapshot of the dynamic model
-			if ( def->overlay && !r_skipOverlays.GetBool() ) {
-				def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
-			} else {
-				idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
-			}
+	if ( def->cachedDynamicModel ) {
 
-			if ( r_checkBounds.GetBool() ) {
-				idBounds b = def->cachedDynamicModel->Bounds();
-				if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
-						b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
-						b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
-						b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
-						b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
-						b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
-					common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
-				}
+		// add any overlays to the snapshot of the dynamic model
+		if ( def->overlay && !r_skipOverlays.GetBool() ) {
+			def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
+		} else {
+			idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
+		}
+
+		if ( r_checkBounds.GetBool() ) {
+			idBounds b = def->cachedDynamicModel->Bounds();
+			if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
+					b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
+					b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
+					b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
+					b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
+					b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
+				common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
 			}
 		}
+	}
+
+	def->dynamicModel = def->cachedDynamicModel;
+	def->dynamicModelFrameCount = tr.frameCount;
+}
 
-		def->dynamicModel = def->cachedDynamicModel;
-		def->dynamicModelFrameCount = tr.frameCount;
+typedef struct {
+	idRenderEntityLocal *	def;
+	performanceCounters_t	pc;
+} dynamicModelJob_t;
+
+/*
+===================
+R_InstantiateDynamicModelJob
+===================
+*/
+static void R_InstantiateDynamicModelJob( dynamicModelJob_t *job ) {
+	R_SetJobPerfCounters( &job->pc );
+	R_InstantiateEntityDefDynamicModel( job->def );
+	R_SetJobPerfCounters( NULL );
+}
+
+REGISTER_PARALLEL_JOB( R_InstantiateDynamicModelJob, "R_InstantiateDynamicModelJob" );
+
+/*
+===================
+R_EntityDefDynamicModel
+
+Issues a deferred entity callback if necessary.
+If the model isn't dynamic, it returns the original.
+Returns the cached dynamic model if present, otherwise creates
+it and any necessary overlays
+===================
+*/
+idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
+
+	if ( R_PrepareEntityDefDynamicModel( def ) ) {
+		R_InstantiateEntityDefDynamicModel( def );
+	}
+
+	idRenderModel *model = def->parms.hModel;
+
+	if ( !model ) {
+		return renderModelManager->DefaultModel();
+	}
+
+	else if ( model->IsDynamicModel() == DM_STATIC ) {
+		return model;
 	}
 
 	// set model depth hack value
@@ -1265,6 +1322,177 @@ idScreenRect R_CalcEntityScissorRectangle( viewEntity_t *vEntity ) {
 	return R_ScreenRectFromViewFrustumBounds( bounds );
 }
 
+/*
+===================
+R_InstantiateDynamicModels
+
+First phase of R_AddModelSurfaces when r_useParallelAddModels is set.
+Calculates the entity scissors and issues the entity callbacks serially,
+then instantiates the snapshots of all dynamic models that will get
+ambient surfaces in this view on the frontend job list.  Entities in a
+time group need the view time switched and liquids share their simulation
+state between entities, so those are left to the serial loop.
+
+Returns false if the parallel path can't be used in the current
+debug configuration.
+===================
+*/
+static bool R_InstantiateDynamicModels( void ) {
+	viewEntity_t	*vEntity;
+
+	// debug filters and prints that expect the serial order
+	if ( r_skipModels.GetInteger() != 0 || r_checkBounds.GetBool() || r_showSkel.GetInteger() != 0 ) {
+		return false;
+	}
+
+	int numViewEntities = 0;
+	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
+		numViewEntities++;
+	}
+	if ( numViewEntities == 0 ) {
+		return true;
+	}
+
+	const uint64 startTime = Sys_GetTimeMicroseconds();
+
+	idRenderEntityLocal **defs = (idRenderEntityLocal **)R_FrameAlloc( numViewEntities * sizeof( defs[0] ) );
+	int numDefs = 0;
+
+	game->SelectTimeGroup( 0 );
+
+	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
+		idRenderEntityLocal *def = vEntity->entityDef;
+
+		if ( r_useEntityScissors.GetBool() ) {
+			// calculate the screen area covered by the entity
+			idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
+			// intersect with the portal crossing scissor rectangle
+			vEntity->scissorRect.Intersect( scissorRect );
+
+			if ( r_showEntityScissors.GetBool() ) {
+				R_ShowColoredScreenRect( vEntity->scissorRect, def->index );
+			}
+		}
+
+		// same tests as in R_AddModelSurfaces
+		if ( def->parms.timeGroup ) {
+			continue;
+		}
+		if ( tr.viewDef->isXraySubview && def->parms.xrayIndex == 1 ) {
+			continue;
+		} else if ( !tr.viewDef->isXraySubview && def->parms.xrayIndex == 2 ) {
+			continue;
+		}
+		if ( tr.viewDef->IsLightGem() && dynamic_cast<const idRenderModelPrt*>( def->parms.hModel ) != NULL ) {
+			continue;
+		}
+
+		// shadow only entities get their model on demand from the interactions
+		if ( vEntity->scissorRect.IsEmpty() ) {
+			continue;
+		}
+
+		if ( !R_PrepareEntityDefDynamicModel( def ) ) {
+			continue;
+		}
+		if ( dynamic_cast<const idRenderModelLiquid*>( def->parms.hModel ) != NULL ) {
+			continue;
+		}
+		defs[numDefs++] = def;
+	}
+
+	if ( numDefs == 1 ) {
+		R_InstantiateEntityDefDynamicModel( defs[0] );
+	} else if ( numDefs > 1 ) {
+		dynamicModelJob_t *jobs = (dynamicModelJob_t *)R_ClearedFrameAlloc( numDefs * sizeof( jobs[0] ) );
+		for ( int i = 0; i < numDefs; i++ ) {
+			// allocate the snapshot geometry here, so that the jobs don't contend for the triangle allocators
+			defs[i]->cachedDynamicModel = defs[i]->parms.hModel->PrepareDynamicModel( &defs[i]->parms, defs[i]->cachedDynamicModel );
+			jobs[i].def = defs[i];
+			tr.frontEndJobList->AddJob( (jobRun_t)R_InstantiateDynamicModelJob, &jobs[i] );
+		}
+		tr.frontEndJobList->Submit();
+		tr.frontEndJobList->Wait();
+		for ( int i = 0; i < numDefs; i++ ) {
+			R_AddPerfCounters( tr.pc, jobs[i].pc );
+		}
+		tr.pc.c_parallelDynamicModels += numDefs;
+	}
+
+	tr.pc.dynamicModelsUsec += (int)( Sys_GetTimeMicroseconds() - startTime );
+
+	return true;
+}
+
+typedef struct {
+	idInteraction *		inter;
+	idScreenRect		shadowScissor;
+} preparedInteraction_t;
+
+static idList<preparedInteraction_t> preparedInteractions;
+
+/*
+===================
+R_AddActiveInteraction
+
+Adds the interaction right away, or only prepares it when the shadow
+volumes are being queued, so it can be linked after they are built.
+===================
+*/
+static void R_AddActiveInteraction( idInteraction *inter, bool queueShadowVolumes ) {
+	if ( !queueShadowVolumes ) {
+		inter->AddActiveInteraction();
+		return;
+	}
+
+	idScreenRect shadowScissor;
+	if ( inter->PrepareActiveInteraction( shadowScissor ) ) {
+		preparedInteraction_t &prepared = preparedInteractions.Alloc();
+		prepared.inter = inter;
+		prepared.shadowScissor = shadowScissor;
+	}
+}
+
+/*
+===================
+R_LinkPreparedInteractions
+
+Second phase of R_AddModelSurfaces when the shadow volumes have been queued.
+The interactions are linked in the same order as the serial path would have,
+so the light surface lists come out unchanged.
+===================
+*/
+static void R_LinkPreparedInteractions( void ) {
+	R_BuildQueuedShadowVolumes();
+
+	for ( int i = 0; i < preparedInteractions.Num(); i++ ) {
+		const preparedInteraction_t &prepared = preparedInteractions[i];
+		const renderEntity_t &parms = prepared.inter->entityDef->parms;
+
+		float oldFloatTime = 0.0f;
+		int oldTime = 0;
+
+		game->SelectTimeGroup( parms.timeGroup );
+
+		if ( parms.timeGroup ) {
+			oldFloatTime = tr.viewDef->floatTime;
+			oldTime = tr.viewDef->renderView.time;
+
+			tr.viewDef->floatTime = game->GetTimeGroupTime( parms.timeGroup ) * 0.001;
+			tr.viewDef->renderView.time = game->GetTimeGroupTime( parms.timeGroup );
+		}
+
+		prepared.inter->LinkActiveInteraction( prepared.shadowScissor );
+
+		if ( parms.timeGroup ) {
+			tr.viewDef->floatTime = oldFloatTime;
+			tr.viewDef->renderView.time = oldTime;
+		}
+	}
+
+	preparedInteractions.SetNum( 0, false );
+}
+
 /*
 ===================
 R_AddModelSurfaces
@@ -1281,11 +1509,27 @@ void R_AddModelSurfaces( void ) {
 	idInteraction		*inter, *next;
 	idRenderModel		*model;
 
+	const uint64 startTime = Sys_GetTimeMicroseconds();
+
 	// clear the ambient surface list
 	tr.viewDef->numDrawSurfs = 0;
 	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_AddDrawSurf
 //	g_enablePortalSky = cvarSystem->GetCVarInteger("g_enablePortalSky"); // duzenko #4414: cache the game cvar
 
+	// instantiate the visible dynamic models up front in parallel, the loop
+	// below will then only find the cached snapshots for them
+	bool scissorsCalculated = false;
+	if ( r_useParallelAddModels.GetBool() ) {
+		scissorsCalculated = R_InstantiateDynamicModels();
+	}
+
+	// the turbo shadow volumes of new interactions are queued and built together
+	// on the frontend job list, the interactions are linked after that
+	const bool queueShadowVolumes = scissorsCalculated && r_useParallelShadowVolumes.GetBool() && r_shadows.GetInteger() == 1;
+	if ( queueShadowVolumes ) {
+		R_BeginShadowVolumeQueue();
+	}
+
 	// go through each entity that is either visible to the view, or to
 	// any light that intersects the view (for shadows)
 	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
@@ -1296,7 +1540,7 @@ void R_AddModelSurfaces( void ) {
 		if ( r_skipModels.GetInteger() == 2 && !def.dynamicModel )
 			continue;
 
-		if ( r_useEntityScissors.GetBool() ) {
+		if ( r_useEntityScissors.GetBool() && !scissorsCalculated ) {
 			// calculate the screen area covered by the entity
 			idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
 			// intersect with the portal crossing scissor rectangle
@@ -1365,7 +1609,7 @@ void R_AddModelSurfaces( void ) {
 					if ( inter->lightDef->viewCount != tr.viewCount ) {
 						continue;
 					}
-					inter->AddActiveInteraction();
+					R_AddActiveInteraction( inter, queueShadowVolumes );
 				}
 			}
 		} else {
@@ -1380,7 +1624,7 @@ void R_AddModelSurfaces( void ) {
 				if ( inter->lightDef->viewCount != tr.viewCount ) {
 					continue;
 				}
-				inter->AddActiveInteraction();
+				R_AddActiveInteraction( inter, queueShadowVolumes );
 			}
 		}
 
@@ -1389,6 +1633,12 @@ void R_AddModelSurfaces( void ) {
 			tr.viewDef->renderView.time = oldTime;
 		}
 	}
+
+	if ( queueShadowVolumes ) {
+		R_LinkPreparedInteractions();
+	}
+
+	tr.pc.addModelsUsec += (int)( Sys_GetTimeMicroseconds() - startTime );
 }
 
 /*
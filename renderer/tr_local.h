@@ -546,10 +546,22 @@ typedef struct frameMemoryBlock_s {
 // contained in a frameData_t.  This entire structure is
 // duplicated so the front and back end can run in parallel
 // on an SMP machine
+
+// memory handed out by R_FrameAlloc after the frame memory block has been used up
+typedef struct frameOverflowBlock_s {
+	struct frameOverflowBlock_s *	next;
+} frameOverflowBlock_t;
+
 typedef struct {
 	std::atomic<int>	frameMemoryAllocated;
 	std::atomic<int>	frameMemoryUsed;
 	byte*				frameMemory;
+	int					frameMemorySize;
+
+	frameOverflowBlock_t *	overflowBlocks;		// freed when the frame is reused
+	int					overflowAllocated;
+
+	int					allocGeneration;	// invalidates the per-thread allocation chunks of the previous use
 
 	srfTriangles_t *	firstDeferredFreeTriSurf;
 	srfTriangles_t *	lastDeferredFreeTriSurf;
@@ -608,6 +620,11 @@ typedef struct {
 	int		c_tangentIndexes;	// R_DeriveTangents()
 	int		c_entityUpdates, c_lightUpdates, c_entityReferences, c_lightReferences;
 	int		c_guiSurfs;
+	int		c_parallelDynamicModels;	// snapshots instantiated on the frontend job list
+	int		addModelsUsec;		// time in R_AddModelSurfaces, summed over all views
+	int		dynamicModelsUsec;	// part of addModelsUsec spent in R_InstantiateDynamicModels
+	int		c_parallelShadowVolumes;	// shadow volumes built on the frontend job list
+	int		shadowVolumesUsec;	// part of addModelsUsec spent in R_BuildQueuedShadowVolumes
 	int		frontEndMsec;		// sum of time in all RE_RenderScene's in a frame
 	int		frontEndMsecLast;		// time in last RE_RenderScene
 } performanceCounters_t;
@@ -764,7 +781,7 @@ public:
 	int						viewCount;		// incremented every view (twice a scene if subviewed)
 											// and every R_MarkFragments call
 
-	int						staticAllocCount;	// running total of bytes allocated
+	std::atomic<int>		staticAllocCount;	// running total of bytes allocated, frontend jobs allocate too
 
 	float					frameShaderTime;	// shader time for all non-world 2D rendering
 
@@ -796,6 +813,8 @@ public:
 
 	performanceCounters_t	pc;					// performance counters
 
+	idParallelJobList *		frontEndJobList;	// dynamic model instantiation in R_AddModelSurfaces
+
 	drawSurfsCommand_t		lockSurfacesCmd;	// use this when r_lockSurfaces = 1
 
 	viewEntity_t			identitySpace;		// can use if we don't know viewDef->worldSpace is valid
@@ -857,6 +876,7 @@ extern idCVar r_useLightPortalFlow;		// 1 = do a more precise area reference det
 extern idCVar r_useShadowSurfaceScissor;// 1 = scissor shadows by the scissor rect of the interaction surfaces
 extern idCVar r_useConstantMaterials;	// 1 = use pre-calculated material registers if possible
 extern idCVar r_useNodeCommonChildren;	// stop pushing reference bounds early when possible
+extern idCVar r_useBinaryProc;			// load maps from a binary copy of the .proc file
 extern idCVar r_useSilRemap;			// 1 = consider verts with the same XYZ, but different ST the same for shadows
 extern idCVar r_useCulling;				// 0 = none, 1 = sphere, 2 = sphere + box
 extern idCVar r_useLightPortalCulling;	// 0 = none, 1 = box, 2 = exact clip of polyhedron faces
@@ -877,6 +897,8 @@ extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
+extern idCVar r_useParallelAddModels;	// 1 = instantiate the visible dynamic models on the frontend job list
+extern idCVar r_useParallelShadowVolumes;	// 1 = build the shadow volumes of new interactions on the frontend job list
 extern idCVar r_useTwoSidedStencil;		// 1 = do stencil shadows in one pass with different ops on each side
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
 extern idCVar r_usePortals;				// 1 = use portals to perform area culling, otherwise draw everything
@@ -1167,6 +1189,8 @@ MAIN
 
 void R_RenderView( viewDef_t &parms );
 
+void R_TestDrawSurfSort_f( const idCmdArgs &args );
+
 bool R_RadiusCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
 bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
 /*
@@ -1477,6 +1501,14 @@ srfTriangles_t *R_CreateShadowVolume( const idRenderEntityLocal *ent,
 									 const srfTriangles_t *tri, const idRenderLightLocal *light,
 									 shadowGen_t optimize, srfCullInfo_t &cullInfo );
 
+// while the queue is open, idInteraction::CreateInteraction hands the turbo shadow
+// volumes to R_QueueShadowVolume instead of building them, and R_BuildQueuedShadowVolumes
+// builds them on the frontend job list and stores them in queue order
+void R_BeginShadowVolumeQueue( void );
+bool R_QueueShadowVolume( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light,
+						  shadowGen_t optimize, surfaceInteraction_t *sint, bool noCapOptimization );
+void R_BuildQueuedShadowVolumes( void );
+
 /*
 ============================================================
 
@@ -1642,11 +1674,18 @@ void R_ToggleSmpFrame( void );
 void *R_FrameAlloc( int bytes );
 void *R_ClearedFrameAlloc( int bytes );
 void R_FrameFree( void *data );
+void R_PrintFrameMemoryStats( void );
 
 void *R_StaticAlloc( int bytes );		// just malloc with error checking
 void *R_ClearedStaticAlloc( int bytes );	// with memset
 void R_StaticFree( void *data );
 
+// frontend jobs count into performance counters of their own instead of tr.pc,
+// the submitting thread adds them to tr.pc after waiting for the jobs
+performanceCounters_t &R_PerfCounters( void );	// tr.pc or the counters of the running job
+void R_SetJobPerfCounters( performanceCounters_t *pc );
+void R_AddPerfCounters( performanceCounters_t &to, const performanceCounters_t &from );
+
 
 /*
 =============================================================
@@ -17,6 +17,8 @@
 #pragma hdrstop
 
 #include "tr_local.h"
+#include <mutex>
+#include <atomic>
 #ifdef __ppc__
 #include <vecLib/vecLib.h>
 #endif
@@ -28,13 +30,44 @@
 
 static const unsigned int NUM_FRAME_DATA = 2;
 static const unsigned int FRAME_ALLOC_ALIGNMENT = 128;
-static const unsigned int MAX_FRAME_MEMORY = 64 * 1024 * 1024;	// larger so that we can noclip on PC for dev purposes
+static const unsigned int INITIAL_FRAME_MEMORY = 64 * 1024 * 1024;	// larger so that we can noclip on PC for dev purposes
+static const unsigned int FRAME_ALLOC_CHUNK_SIZE = 256 * 1024;		// each thread bump allocates from chunks of this size
+static const int MAX_FRAME_ALLOC_THREADS = 32;
 
 frameData_t		smpFrameData[NUM_FRAME_DATA];
 frameData_t* 	frameData;
 frameData_t*	backendFrameData;
 unsigned int	smpFrame;
 
+// the frame memory block size, raised when a frame had to use overflow blocks
+static int		frameMemoryTargetSize = INITIAL_FRAME_MEMORY;
+static std::mutex	frameOverflowMutex;
+
+// the chunk of frame memory a thread is currently allocating from
+typedef struct {
+	frameData_t *	frame;
+	int				generation;
+	byte *			ptr;
+	byte *			end;
+	int				stats;		// index into frameAllocThreadStats
+} frameAllocCursor_t;
+
+static thread_local frameAllocCursor_t frameAllocCursor = { NULL, 0, NULL, NULL, -1 };
+
+// set while a frontend job runs on this thread, see R_PerfCounters
+static thread_local performanceCounters_t *jobPerfCounters = NULL;
+
+// per-thread frame memory statistics for r_showMemory
+typedef struct {
+	std::atomic<int>	frameUsed;		// bytes allocated by the thread in the current frame
+	int					lastFrameUsed;
+	int					highwater;
+	byte				pad[64 - 3 * sizeof( int )];	// keep the threads off each other's cache lines
+} frameAllocThreadStats_t;
+
+static frameAllocThreadStats_t	frameAllocThreadStats[MAX_FRAME_ALLOC_THREADS];
+static std::atomic<int>			numFrameAllocThreads( 0 );
+
 /*
 ======================
 idScreenRect::Clear
@@ -172,6 +205,24 @@ void R_ShowColoredScreenRect( const idScreenRect &rect, int colorIndex ) {
 	}
 }
 
+#define	MEMORY_BLOCK_SIZE	0x100000
+
+/*
+====================
+R_FreeFrameOverflowBlocks
+====================
+*/
+static void R_FreeFrameOverflowBlocks( frameData_t *frame ) {
+	frameOverflowBlock_t *block, *next;
+
+	for ( block = frame->overflowBlocks; block; block = next ) {
+		next = block->next;
+		Mem_Free16( block );
+	}
+	frame->overflowBlocks = NULL;
+	frame->overflowAllocated = 0;
+}
+
 /*
 ====================
 R_ToggleSmpFrame
@@ -179,8 +230,28 @@ R_ToggleSmpFrame
 */
 void R_ToggleSmpFrame( void ) {
 	// update the highwater mark
-	if (frameData->frameMemoryAllocated > frameData->memoryHighwater) {
-		frameData->memoryHighwater = frameData->frameMemoryAllocated;
+	const int frameMemoryAllocated = Min( frameData->frameMemoryAllocated.load(), frameData->frameMemorySize ) + frameData->overflowAllocated;
+	if ( frameMemoryAllocated > frameData->memoryHighwater ) {
+		frameData->memoryHighwater = frameMemoryAllocated;
+	}
+
+	// a frame that didn't fit into the frame memory block makes the
+	// blocks grow, so that the overflow blocks are only needed once
+	if ( frameData->overflowAllocated > 0 ) {
+		const int neededSize = frameData->frameMemorySize + frameData->overflowAllocated;
+		if ( neededSize > frameMemoryTargetSize ) {
+			frameMemoryTargetSize = ( neededSize + MEMORY_BLOCK_SIZE - 1 ) & ~( MEMORY_BLOCK_SIZE - 1 );
+			common->Printf( "R_FrameAlloc: frame memory grown to %d MB\n", frameMemoryTargetSize >> 20 );
+		}
+	}
+
+	const int numStats = Min( numFrameAllocThreads.load(), MAX_FRAME_ALLOC_THREADS );
+	for ( int i = 0; i < numStats; i++ ) {
+		frameAllocThreadStats_t &stats = frameAllocThreadStats[i];
+		stats.lastFrameUsed = stats.frameUsed.exchange( 0 );
+		if ( stats.lastFrameUsed > stats.highwater ) {
+			stats.highwater = stats.lastFrameUsed;
+		}
 	}
 
 	// switch to the next frame
@@ -190,6 +261,13 @@ void R_ToggleSmpFrame( void ) {
 
 	// reset the memory allocation
 	R_FreeDeferredTriSurfs( frameData );
+	R_FreeFrameOverflowBlocks( frameData );
+
+	if ( frameData->frameMemorySize < frameMemoryTargetSize ) {
+		Mem_Free16( frameData->frameMemory );
+		frameData->frameMemory = (byte*)Mem_Alloc16( frameMemoryTargetSize );
+		frameData->frameMemorySize = frameMemoryTargetSize;
+	}
 
 	// RB: 64 bit fixes, changed unsigned int to uintptr_t
 	const uintptr_t bytesNeededForAlignment = FRAME_ALLOC_ALIGNMENT - ((uintptr_t)frameData->frameMemory & (FRAME_ALLOC_ALIGNMENT - 1));
@@ -198,14 +276,15 @@ void R_ToggleSmpFrame( void ) {
 	frameData->frameMemoryAllocated = bytesNeededForAlignment;
 	frameData->frameMemoryUsed = 0;
 
+	// all threads have to pick up a new chunk from this frame
+	frameData->allocGeneration++;
+
 	R_ClearCommandChain( frameData );
 }
 
 
 //=====================================================
 
-#define	MEMORY_BLOCK_SIZE	0x100000
-
 /*
 =====================
 R_ShutdownFrameData
@@ -215,8 +294,10 @@ void R_ShutdownFrameData( void ) {
 	R_FreeDeferredTriSurfs( frameData );
 	frameData = NULL;
 	for (int i = 0; i < NUM_FRAME_DATA; i++) {
+		R_FreeFrameOverflowBlocks( &smpFrameData[i] );
 		Mem_Free16( smpFrameData[i].frameMemory );
 		smpFrameData[i].frameMemory = NULL;
+		smpFrameData[i].frameMemorySize = 0;
 	}
 }
 
@@ -229,7 +310,8 @@ void R_InitFrameData( void ) {
 	R_ShutdownFrameData();
 
 	for (int i = 0; i < NUM_FRAME_DATA; i++) {
-		smpFrameData[i].frameMemory = (byte*)Mem_Alloc16( MAX_FRAME_MEMORY );
+		smpFrameData[i].frameMemory = (byte*)Mem_Alloc16( frameMemoryTargetSize );
+		smpFrameData[i].frameMemorySize = frameMemoryTargetSize;
 	}
 
 	// must be set before calling R_ToggleSmpFrame()
@@ -275,7 +357,7 @@ R_StaticAlloc
 void *R_StaticAlloc( int bytes ) {
 	void	*buf;
 
-	tr.pc.c_alloc++;
+	R_PerfCounters().c_alloc++;
 
 	tr.staticAllocCount += bytes;
 
@@ -307,10 +389,74 @@ R_StaticFree
 =================
 */
 void R_StaticFree( void *data ) {
-	tr.pc.c_free++;
+	R_PerfCounters().c_free++;
     Mem_Free( data );
 }
 
+/*
+=================
+R_PerfCounters
+=================
+*/
+performanceCounters_t &R_PerfCounters( void ) {
+	return ( jobPerfCounters != NULL ) ? *jobPerfCounters : tr.pc;
+}
+
+/*
+=================
+R_SetJobPerfCounters
+=================
+*/
+void R_SetJobPerfCounters( performanceCounters_t *pc ) {
+	jobPerfCounters = pc;
+}
+
+/*
+=================
+R_AddPerfCounters
+=================
+*/
+void R_AddPerfCounters( performanceCounters_t &to, const performanceCounters_t &from ) {
+	// all the counters are ints
+	int *dst = (int *)&to;
+	const int *src = (const int *)&from;
+	for ( int i = 0; i < (int)( sizeof( performanceCounters_t ) / sizeof( int ) ); i++ ) {
+		dst[i] += src[i];
+	}
+}
+
+/*
+================
+R_ReserveFrameMemory
+
+Takes memory for R_FrameAlloc from the frame memory block, which is
+shared by all threads.  If the block is used up, the memory comes from
+an overflow block instead and the frame memory will be grown at the
+next R_ToggleSmpFrame.
+================
+*/
+static byte *R_ReserveFrameMemory( frameData_t *frame, int bytes ) {
+	// thread safe add
+	int	end = frame->frameMemoryAllocated += bytes;
+	if ( end <= frame->frameMemorySize ) {
+		return frame->frameMemory + end - bytes;
+	}
+
+	std::lock_guard<std::mutex> lock( frameOverflowMutex );
+
+	// Mem_Alloc16 is only 16 byte aligned, leave room to align the memory like the frame memory block
+	frameOverflowBlock_t *block = (frameOverflowBlock_t *)Mem_Alloc16( sizeof( frameOverflowBlock_t ) + FRAME_ALLOC_ALIGNMENT + bytes );
+	if ( !block ) {
+		common->FatalError( "R_FrameAlloc ran out of memory. bytes = %d, highWaterAllocated = %d\n", bytes, frame->memoryHighwater );
+	}
+	block->next = frame->overflowBlocks;
+	frame->overflowBlocks = block;
+	frame->overflowAllocated += bytes;
+
+	const uintptr_t start = (uintptr_t)( block + 1 );
+	return (byte *)( ( start + FRAME_ALLOC_ALIGNMENT - 1 ) & ~(uintptr_t)( FRAME_ALLOC_ALIGNMENT - 1 ) );
+}
+
 /*
 ================
 R_FrameAlloc
@@ -333,19 +479,39 @@ contiguous with previous allocations even
 from this frame.
 
 The memory is NOT zero filled.
+Every thread bump allocates from its own chunk of
+the frame memory block, so the shared atomic is only
+touched once per chunk.
+
 Should part of this be inlined in a macro?
 ================
 */
 void *R_FrameAlloc( int bytes ) {
 	bytes = (bytes + FRAME_ALLOC_ALIGNMENT - 1) & ~(FRAME_ALLOC_ALIGNMENT - 1);
 
-	// thread safe add
-	int	end = frameData->frameMemoryAllocated += bytes;
-	if (end > MAX_FRAME_MEMORY) {
-		idLib::Error( "R_FrameAlloc ran out of memory. bytes = %d, end = %d, highWaterAllocated = %d\n", bytes, end, frameData->memoryHighwater );
+	frameAllocCursor_t &cursor = frameAllocCursor;
+
+	if ( cursor.stats < 0 ) {
+		cursor.stats = Min( numFrameAllocThreads++, MAX_FRAME_ALLOC_THREADS - 1 );
 	}
+	// only this thread adds to its own counter, so there is no contention
+	std::atomic<int> &frameUsed = frameAllocThreadStats[cursor.stats].frameUsed;
+	frameUsed.store( frameUsed.load( std::memory_order_relaxed ) + bytes, std::memory_order_relaxed );
 
-	byte* ptr = frameData->frameMemory + end - bytes;
+	// big allocations don't go through the chunks so they don't waste the rest of one
+	if ( bytes > (int)FRAME_ALLOC_CHUNK_SIZE / 4 ) {
+		return R_ReserveFrameMemory( frameData, bytes );
+	}
+
+	if ( cursor.frame != frameData || cursor.generation != frameData->allocGeneration || cursor.ptr + bytes > cursor.end ) {
+		cursor.frame = frameData;
+		cursor.generation = frameData->allocGeneration;
+		cursor.ptr = R_ReserveFrameMemory( frameData, FRAME_ALLOC_CHUNK_SIZE );
+		cursor.end = cursor.ptr + FRAME_ALLOC_CHUNK_SIZE;
+	}
+
+	byte *ptr = cursor.ptr;
+	cursor.ptr += bytes;
 
 	return ptr;
 }
@@ -379,6 +545,20 @@ to both alloc and free.
 void R_FrameFree( void *data ) {
 }
 
+/*
+==================
+R_PrintFrameMemoryStats
+
+Frame memory used by each thread that called R_FrameAlloc, for r_showMemory
+==================
+*/
+void R_PrintFrameMemoryStats( void ) {
+	const int numStats = Min( numFrameAllocThreads.load(), MAX_FRAME_ALLOC_THREADS );
+	for ( int i = 0; i < numStats; i++ ) {
+		common->Printf( "  thread %d: %i (%i)\n", i, frameAllocThreadStats[i].lastFrameUsed, frameAllocThreadStats[i].highwater );
+	}
+}
+
 
 
 //==========================================================================
@@ -1030,6 +1210,41 @@ DRAWSURF SORTING
 */
 
 
+// draw surface sort values captured for testDrawSurfSort
+static const int				DRAWSURF_CAPTURE_IDLE = -2;
+static const int				DRAWSURF_CAPTURE_ARMED = -1;
+static std::atomic<int>			drawSurfCaptureFrame( DRAWSURF_CAPTURE_IDLE );	// frame being captured
+static std::mutex				drawSurfCaptureMutex;
+static idList< idList<float> >	capturedDrawSurfSorts;
+
+/*
+=======================
+R_CaptureDrawSurfSorts
+
+Records the unsorted draw surface sort values of all views rendered
+in the frame after "testDrawSurfSort capture"
+=======================
+*/
+static void R_CaptureDrawSurfSorts( void ) {
+	std::lock_guard<std::mutex> lock( drawSurfCaptureMutex );
+
+	int captureFrame = drawSurfCaptureFrame;
+	if ( captureFrame == DRAWSURF_CAPTURE_ARMED ) {
+		captureFrame = tr.frameCount;
+		drawSurfCaptureFrame = captureFrame;
+	} else if ( captureFrame != tr.frameCount ) {
+		drawSurfCaptureFrame = DRAWSURF_CAPTURE_IDLE;
+		common->Printf( "captured %d views\n", capturedDrawSurfSorts.Num() );
+		return;
+	}
+
+	idList<float> &sorts = capturedDrawSurfSorts.Alloc();
+	sorts.SetNum( tr.viewDef->numDrawSurfs );
+	for ( int i = 0; i < tr.viewDef->numDrawSurfs; i++ ) {
+		sorts[i] = tr.viewDef->drawSurfs[i]->sort;
+	}
+}
+
 /*
 =======================
 R_QsortSurfaces
@@ -1052,6 +1267,86 @@ static int R_QsortSurfaces( const void *a, const void *b ) {
 }
 
 
+/*
+=======================
+R_DrawSurfSortKey
+
+Maps the float sort value to an unsigned integer with the same
+ordering, flipping all bits of negative values and only the sign
+bit of positive values
+=======================
+*/
+static ID_INLINE unsigned int R_DrawSurfSortKey( float sort ) {
+	unsigned int bits;
+	memcpy( &bits, &sort, sizeof( bits ) );
+	return ( bits & 0x80000000u ) ? ~bits : ( bits | 0x80000000u );
+}
+
+/*
+=======================
+R_RadixSortDrawSurfs
+
+Stable LSD radix sort of the draw surfaces on their sort value.
+The sort key goes into the upper 32 bits of a 64 bit key and the
+original index into the lower 32 bits, so the surfaces can be
+gathered after sorting the contiguous key array.
+Byte passes where all keys share the same value are skipped, which
+is common for the exponent byte.
+
+scratch must hold 3 * numDrawSurfs uint64
+=======================
+*/
+static void R_RadixSortDrawSurfs( drawSurf_t **drawSurfs, int numDrawSurfs, uint64 *scratch ) {
+	if ( numDrawSurfs < 2 ) {
+		return;
+	}
+
+	uint64 *keys = scratch;
+	uint64 *tempKeys = scratch + numDrawSurfs;
+	drawSurf_t **unsorted = reinterpret_cast<drawSurf_t **>( scratch + 2 * numDrawSurfs );
+
+	int counts[4][256];
+	memset( counts, 0, sizeof( counts ) );
+
+	for ( int i = 0; i < numDrawSurfs; i++ ) {
+		const unsigned int key = R_DrawSurfSortKey( drawSurfs[i]->sort );
+		keys[i] = ( (uint64)key << 32 ) | (unsigned int)i;
+		unsorted[i] = drawSurfs[i];
+		counts[0][key & 255]++;
+		counts[1][( key >> 8 ) & 255]++;
+		counts[2][( key >> 16 ) & 255]++;
+		counts[3][key >> 24]++;
+	}
+
+	for ( int pass = 0; pass < 4; pass++ ) {
+		const int shift = 32 + pass * 8;
+		int *count = counts[pass];
+
+		if ( count[( keys[0] >> shift ) & 255] == numDrawSurfs ) {
+			continue;
+		}
+
+		int offset = 0;
+		for ( int i = 0; i < 256; i++ ) {
+			const int c = count[i];
+			count[i] = offset;
+			offset += c;
+		}
+
+		for ( int i = 0; i < numDrawSurfs; i++ ) {
+			tempKeys[count[( keys[i] >> shift ) & 255]++] = keys[i];
+		}
+
+		uint64 *swap = keys;
+		keys = tempKeys;
+		tempKeys = swap;
+	}
+
+	for ( int i = 0; i < numDrawSurfs; i++ ) {
+		drawSurfs[i] = unsorted[keys[i] & 0xFFFFFFFFu];
+	}
+}
+
 /*
 =================
 R_SortDrawSurfs
@@ -1059,10 +1354,125 @@ R_SortDrawSurfs
 */
 static void R_SortDrawSurfs( void ) {
 	// sort the drawsurfs by sort type, then orientation, then shader
-	qsort( tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs, sizeof( tr.viewDef->drawSurfs[0] ),
-		R_QsortSurfaces );
+	if ( tr.viewDef->numDrawSurfs < 2 ) {
+		return;
+	}
+	if ( drawSurfCaptureFrame != DRAWSURF_CAPTURE_IDLE ) {
+		R_CaptureDrawSurfSorts();
+	}
+	uint64 *scratch = (uint64 *)R_FrameAlloc( tr.viewDef->numDrawSurfs * 3 * sizeof( uint64 ) );
+	R_RadixSortDrawSurfs( tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs, scratch );
 }
 
+/*
+=================
+R_TestDrawSurfSort_f
+
+Replays the draw surface lists captured with "testDrawSurfSort capture"
+through qsort and the radix sort and compares the results and timings.
+Uses synthetic lists if nothing has been captured.
+=================
+*/
+void R_TestDrawSurfSort_f( const idCmdArgs &args ) {
+	const int NUM_RUNS = 32;
+
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "capture" ) ) {
+		std::lock_guard<std::mutex> lock( drawSurfCaptureMutex );
+		capturedDrawSurfSorts.Clear();
+		drawSurfCaptureFrame = DRAWSURF_CAPTURE_ARMED;
+		common->Printf( "capturing the draw surfaces of all views in the next frame, run testDrawSurfSort to replay them\n" );
+		return;
+	}
+
+	idList< idList<float> > lists;
+	{
+		std::lock_guard<std::mutex> lock( drawSurfCaptureMutex );
+		lists = capturedDrawSurfSorts;
+	}
+
+	if ( lists.Num() == 0 ) {
+		// a few views with the material sorts of a typical scene
+		static const float materialSorts[] = { SS_SUBVIEW, SS_GUI, SS_OPAQUE, SS_OPAQUE, SS_OPAQUE, SS_OPAQUE, SS_PORTAL_SKY,
+			SS_DECAL, SS_FAR, SS_MEDIUM, SS_MEDIUM, SS_CLOSE, SS_ALMOST_NEAREST, SS_NEAREST, SS_POST_PROCESS };
+		const int numMaterialSorts = sizeof( materialSorts ) / sizeof( materialSorts[0] );
+		static const int listSizes[] = { 64, 512, 2048, 8192 };
+		idRandom random( 0 );
+
+		for ( int i = 0; i < sizeof( listSizes ) / sizeof( listSizes[0] ); i++ ) {
+			idList<float> &sorts = lists.Alloc();
+			sorts.SetNum( listSizes[i] );
+			for ( int j = 0; j < listSizes[i]; j++ ) {
+				sorts[j] = materialSorts[random.RandomInt( numMaterialSorts )] + j * 0.000001f;
+			}
+			// entities add their surfaces in model order, not in sort order
+			for ( int j = listSizes[i] - 1; j > 0; j-- ) {
+				idSwap( sorts[j], sorts[random.RandomInt( j + 1 )] );
+			}
+		}
+		common->Printf( "no captured views, using %d synthetic lists\n", lists.Num() );
+	}
+
+	idList<drawSurf_t> surfs;
+	idList<drawSurf_t *> unsorted, sorted;
+	idList<uint64> scratch;
+	uint64 totalQsort = 0, totalRadix = 0;
+	int failed = 0;
+
+	for ( int i = 0; i < lists.Num(); i++ ) {
+		const idList<float> &sorts = lists[i];
+		const int num = sorts.Num();
+
+		surfs.SetNum( num );
+		unsorted.SetNum( num );
+		sorted.SetNum( num );
+		scratch.SetNum( num * 3 );
+		memset( surfs.Ptr(), 0, num * sizeof( drawSurf_t ) );
+		for ( int j = 0; j < num; j++ ) {
+			surfs[j].sort = sorts[j];
+			unsorted[j] = &surfs[j];
+		}
+
+		uint64 bestQsort = ~(uint64)0, bestRadix = ~(uint64)0;
+		idList<float> qsortResult;
+		qsortResult.SetNum( num );
+
+		for ( int run = 0; run < NUM_RUNS; run++ ) {
+			memcpy( sorted.Ptr(), unsorted.Ptr(), num * sizeof( drawSurf_t * ) );
+			uint64 start = Sys_GetTimeMicroseconds();
+			qsort( sorted.Ptr(), num, sizeof( drawSurf_t * ), R_QsortSurfaces );
+			bestQsort = Min( bestQsort, Sys_GetTimeMicroseconds() - start );
+		}
+		for ( int j = 0; j < num; j++ ) {
+			qsortResult[j] = sorted[j]->sort;
+		}
+
+		for ( int run = 0; run < NUM_RUNS; run++ ) {
+			memcpy( sorted.Ptr(), unsorted.Ptr(), num * sizeof( drawSurf_t * ) );
+			uint64 start = Sys_GetTimeMicroseconds();
+			R_RadixSortDrawSurfs( sorted.Ptr(), num, scratch.Ptr() );
+			bestRadix = Min( bestRadix, Sys_GetTimeMicroseconds() - start );
+		}
+
+		bool ok = true;
+		for ( int j = 0; j < num; j++ ) {
+			if ( sorted[j]->sort != qsortResult[j] ) {
+				ok = false;
+				break;
+			}
+		}
+		if ( !ok ) {
+			failed++;
+		}
+
+		totalQsort += bestQsort;
+		totalRadix += bestRadix;
+		common->Printf( "view %3d: %5d surfs  qsort %6d usec  radix %6d usec %s\n", i, num,
+			(int)bestQsort, (int)bestRadix, ok ? "" : S_COLOR_RED"X" );
+	}
+
+	common->Printf( "total: qsort %d usec  radix %d usec  (%.2fx)  %d views, %d failed\n", (int)totalQsort, (int)totalRadix,
+		totalRadix ? (float)totalQsort / totalRadix : 0.0f, lists.Num(), failed );
+}
 
 
 //========================================================================
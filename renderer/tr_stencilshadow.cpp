@@ -1376,6 +1376,151 @@ srfTriangles_t *R_CreateShadowVolume( const idRenderEntityLocal *ent,
 	return newTri;
 }
 
+/*
+===========================================================================================
+
+PARALLEL SHADOW VOLUMES
+
+Turbo shadow volumes only read the source surface and the light, and write
+their own facing and cull bits, so the volumes of all interactions created
+in a view can be built independently.  The clipped path above works out of
+the file scope buffers and is always built immediately.
+
+===========================================================================================
+*/
+
+typedef struct {
+	const idRenderEntityLocal *	ent;
+	const srfTriangles_t *		tri;
+	const idRenderLightLocal *	light;
+	surfaceInteraction_t *		sint;
+	bool						noCapOptimization;
+	srfTriangles_t *			shadowTris;
+	performanceCounters_t		pc;
+} shadowVolumeJob_t;
+
+static idList<shadowVolumeJob_t>	shadowVolumeJobs;
+static bool							shadowVolumeQueueOpen;
+
+/*
+=================
+R_BeginShadowVolumeQueue
+=================
+*/
+void R_BeginShadowVolumeQueue( void ) {
+	assert( shadowVolumeJobs.Num() == 0 );
+	shadowVolumeQueueOpen = true;
+}
+
+/*
+=================
+R_QueueShadowVolume
+
+Returns false if the queue isn't open or the volume can't be built on a job,
+in which case the caller should call R_CreateShadowVolume itself.
+=================
+*/
+bool R_QueueShadowVolume( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light,
+						  shadowGen_t optimize, surfaceInteraction_t *sint, bool noCapOptimization ) {
+	if ( !shadowVolumeQueueOpen ) {
+		return false;
+	}
+
+	// only the turbo path is safe to run on several threads at once
+	if ( r_shadows.GetInteger() != 1 || optimize != SG_DYNAMIC || !r_useTurboShadow.GetBool() ) {
+		return false;
+	}
+
+	// leave the trivial and the error cases to R_CreateShadowVolume
+	if ( tri->numSilEdges <= 0 || tri->numIndexes <= 0 || tri->numVerts <= 0 ) {
+		return false;
+	}
+
+	tr.pc.c_createShadowVolumes++;
+
+	// the face planes are shared by all the lights touching the surface,
+	// so derive them here instead of racing on them in the jobs
+	if ( !r_useAnonreclaimer.GetBool() && ( !tri->facePlanes || !tri->facePlanesCalculated ) ) {
+		R_DeriveFacePlanes( const_cast<srfTriangles_t *>( tri ) );
+	}
+
+	shadowVolumeJob_t &job = shadowVolumeJobs.Alloc();
+	job.ent = ent;
+	job.tri = tri;
+	job.light = light;
+	job.sint = sint;
+	job.noCapOptimization = noCapOptimization;
+	job.shadowTris = NULL;
+	memset( &job.pc, 0, sizeof( job.pc ) );
+
+	return true;
+}
+
+/*
+=================
+R_CreateQueuedShadowVolume
+=================
+*/
+static void R_CreateQueuedShadowVolume( shadowVolumeJob_t *job ) {
+	R_SetJobPerfCounters( &job->pc );
+	job->shadowTris = R_CreateVertexProgramTurboShadowVolume( job->ent, job->tri, job->light, job->sint->cullInfo );
+	R_SetJobPerfCounters( NULL );
+}
+
+REGISTER_PARALLEL_JOB( R_CreateQueuedShadowVolume, "R_CreateQueuedShadowVolume" );
+
+/*
+=================
+R_BuildQueuedShadowVolumes
+
+Closes the queue, builds all the queued volumes and stores them in the
+surface interactions in the order they were queued.
+=================
+*/
+void R_BuildQueuedShadowVolumes( void ) {
+	shadowVolumeQueueOpen = false;
+
+	const int numJobs = shadowVolumeJobs.Num();
+	if ( numJobs == 0 ) {
+		return;
+	}
+
+	const uint64 startTime = Sys_GetTimeMicroseconds();
+
+	if ( numJobs == 1 ) {
+		R_CreateQueuedShadowVolume( &shadowVolumeJobs[0] );
+	} else {
+		for ( int i = 0; i < numJobs; i++ ) {
+			tr.frontEndJobList->AddJob( (jobRun_t)R_CreateQueuedShadowVolume, &shadowVolumeJobs[i] );
+		}
+		tr.frontEndJobList->Submit();
+		tr.frontEndJobList->Wait();
+		tr.pc.c_parallelShadowVolumes += numJobs;
+	}
+
+	for ( int i = 0; i < numJobs; i++ ) {
+		shadowVolumeJob_t &job = shadowVolumeJobs[i];
+		surfaceInteraction_t *sint = job.sint;
+
+		R_AddPerfCounters( tr.pc, job.pc );
+
+		sint->shadowTris = job.shadowTris;
+		if ( sint->shadowTris && job.noCapOptimization ) {
+			sint->shadowTris->numShadowIndexesNoCaps = sint->shadowTris->numIndexes;
+			sint->shadowTris->numShadowIndexesNoFrontCaps = sint->shadowTris->numIndexes;
+		}
+
+		// free the cull information when it's no longer needed
+		if ( sint->lightTris != LIGHT_TRIS_DEFERRED ) {
+			R_FreeInteractionCullInfo( sint->cullInfo );
+		}
+	}
+
+	shadowVolumeJobs.SetNum( 0, false );
+
+	tr.pc.shadowVolumesUsec += (int)( Sys_GetTimeMicroseconds() - startTime );
+}
+
 void AddPoissonDiskSamples( idList<idVec2> &pts, float dist ) {
 	static const int MaxFailStreak = 1000;
 	idRandom rnd;
@@ -20,6 +20,8 @@
 
 #include "tr_local.h"
 
+#include <mutex>
+
 /*
 ==============================================================================
 
@@ -137,6 +139,13 @@ static idDynamicAlloc<int, 1<<16, 1<<10>				triMirroredVertAllocator;
 static idDynamicAlloc<int, 1<<16, 1<<10>				triDupVertAllocator;
 #endif
 
+// the block allocators above are not thread safe, but dynamic models are instantiated
+// from the frontend job list, so every allocator access and the deferred free list
+// is serialized through this mutex. MD5 snapshots, the bulk of the dynamic models,
+// get their memory in idRenderModel::PrepareDynamicModel before the jobs are submitted,
+// so their jobs don't take it.
+static std::mutex triAllocatorMutex;
+
 
 /*
 ===============
@@ -199,6 +208,7 @@ void R_PurgeTriSurfData( frameData_t *frame ) {
 	R_FreeDeferredTriSurfs( frame );
 
 	// free empty base blocks
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	triVertexAllocator.FreeEmptyBaseBlocks();
 	triIndexAllocator.FreeEmptyBaseBlocks();
 	triShadowVertexAllocator.FreeEmptyBaseBlocks();
@@ -362,6 +372,8 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 
 	R_FreeStaticTriSurfVertexCaches( tri );
 
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
+
 	if ( tri->verts != NULL ) {
 		// R_CreateLightTris points tri->verts at the verts of the ambient surface
 		if ( tri->ambientSurface == NULL || tri->verts != tri->ambientSurface->verts ) {
@@ -489,6 +501,7 @@ void R_FreeStaticTriSurf( srfTriangles_t *tri ) {
 #ifdef ID_DEBUG_MEMORY
 		R_CheckStaticTriSurfMemory( tri );
 #endif
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
 		tri->nextDeferredFree = NULL;
 		if ( frame->lastDeferredFreeTriSurf ) {
 			frame->lastDeferredFreeTriSurf->nextDeferredFree = tri;
@@ -505,6 +518,7 @@ R_AllocStaticTriSurf
 ==============
 */
 srfTriangles_t *R_AllocStaticTriSurf( void ) {
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	srfTriangles_t *tris = srfTrianglesAllocator.Alloc();
 	memset( tris, 0, sizeof( srfTriangles_t ) );
 	return tris;
@@ -538,6 +552,7 @@ R_AllocStaticTriSurfVerts
 */
 void R_AllocStaticTriSurfVerts( srfTriangles_t *tri, int numVerts ) {
 	assert( tri->verts == NULL );
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	tri->verts = triVertexAllocator.Alloc( numVerts );
 }
 
@@ -548,6 +563,7 @@ R_AllocStaticTriSurfIndexes
 */
 void R_AllocStaticTriSurfIndexes( srfTriangles_t *tri, int numIndexes ) {
 	assert( tri->indexes == NULL );
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	tri->indexes = triIndexAllocator.Alloc( numIndexes );
 }
 
@@ -558,6 +574,7 @@ R_AllocStaticTriSurfShadowVerts
 */
 void R_AllocStaticTriSurfShadowVerts( srfTriangles_t *tri, int numVerts ) {
 	assert( tri->shadowVertexes == NULL );
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	tri->shadowVertexes = triShadowVertexAllocator.Alloc( numVerts );
 }
 
@@ -567,6 +584,7 @@ R_AllocStaticTriSurfPlanes
 =================
 */
 void R_AllocStaticTriSurfPlanes( srfTriangles_t *tri, int numIndexes ) {
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	if ( tri->facePlanes ) {
 		triPlaneAllocator.Free( tri->facePlanes );
 	}
@@ -580,6 +598,7 @@ R_ResizeStaticTriSurfVerts
 */
 void R_ResizeStaticTriSurfVerts( srfTriangles_t *tri, int numVerts ) {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	tri->verts = triVertexAllocator.Resize( tri->verts, numVerts );
 #else
 	assert( false );
@@ -593,6 +612,7 @@ R_ResizeStaticTriSurfIndexes
 */
 void R_ResizeStaticTriSurfIndexes( srfTriangles_t *tri, int numIndexes ) {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	tri->indexes = triIndexAllocator.Resize( tri->indexes, numIndexes );
 #else
 	assert( false );
@@ -606,6 +626,7 @@ R_ResizeStaticTriSurfShadowVerts
 */
 void R_ResizeStaticTriSurfShadowVerts( srfTriangles_t *tri, int numVerts ) {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	tri->shadowVertexes = triShadowVertexAllocator.Resize( tri->shadowVertexes, numVerts );
 #else
 	assert( false );
@@ -636,6 +657,7 @@ R_FreeStaticTriSurfSilIndexes
 =================
 */
 void R_FreeStaticTriSurfSilIndexes( srfTriangles_t *tri ) {
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	triSilIndexAllocator.Free( tri->silIndexes );
 	tri->silIndexes = NULL;
 }
@@ -751,6 +773,7 @@ void R_CreateSilIndexes( srfTriangles_t *tri ) {
 	int		*remap;
 
 	if ( tri->silIndexes ) {
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
 		triSilIndexAllocator.Free( tri->silIndexes );
 		tri->silIndexes = NULL;
 	}
@@ -758,7 +781,10 @@ void R_CreateSilIndexes( srfTriangles_t *tri ) {
 	remap = R_CreateSilRemap( tri );
 
 	// remap indexes to the first one
-	tri->silIndexes = triSilIndexAllocator.Alloc( tri->numIndexes );
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		tri->silIndexes = triSilIndexAllocator.Alloc( tri->numIndexes );
+	}
 	for ( i = 0; i < tri->numIndexes; i++ ) {
 		tri->silIndexes[i] = remap[tri->indexes[i]];
 	}
@@ -797,7 +823,10 @@ void R_CreateDupVerts( srfTriangles_t *tri ) {
 		}
 	}
 
-	tri->dupVerts = triDupVertAllocator.Alloc( tri->numDupVerts * 2 );
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		tri->dupVerts = triDupVertAllocator.Alloc( tri->numDupVerts * 2 );
+	}
 	memcpy( tri->dupVerts, tempDupVerts, tri->numDupVerts * 2 * sizeof( tri->dupVerts[0] ) );
 }
 
@@ -1096,7 +1125,10 @@ void R_IdentifySilEdges( srfTriangles_t *tri, bool omitCoplanarEdges ) {
 	}
 
 	tri->numSilEdges = numSilEdges;
-	tri->silEdges = triSilEdgeAllocator.Alloc( numSilEdges );
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		tri->silEdges = triSilEdgeAllocator.Alloc( numSilEdges );
+	}
 	memcpy( tri->silEdges, silEdges, numSilEdges * sizeof( tri->silEdges[0] ) );
 }
 
@@ -1288,15 +1320,24 @@ static void	R_DuplicateMirroredVertexes( srfTriangles_t *tri ) {
 		return;
 	}
 
-	tri->mirroredVerts = triMirroredVertAllocator.Alloc( tri->numMirroredVerts );
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		tri->mirroredVerts = triMirroredVertAllocator.Alloc( tri->numMirroredVerts );
+	}
 
 #ifdef USE_TRI_DATA_ALLOCATOR
-	tri->verts = triVertexAllocator.Resize( tri->verts, totalVerts );
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		tri->verts = triVertexAllocator.Resize( tri->verts, totalVerts );
+	}
 #else
 	idDrawVert *oldVerts = tri->verts;
 	R_AllocStaticTriSurfVerts( tri, totalVerts );
 	memcpy( tri->verts, oldVerts, tri->numVerts * sizeof( tri->verts[0] ) );
-	triVertexAllocator.Free( oldVerts );
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		triVertexAllocator.Free( oldVerts );
+	}
 #endif
 
 	// create the duplicates
@@ -1462,7 +1503,10 @@ void R_BuildDominantTris( srfTriangles_t *tri ) {
 	}
 	qsort( ind, tri->numIndexes, sizeof( *ind ), IndexSort );
 
-	tri->dominantTris = dt = triDominantTrisAllocator.Alloc( tri->numVerts );
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		tri->dominantTris = dt = triDominantTrisAllocator.Alloc( tri->numVerts );
+	}
 	memset( dt, 0, tri->numVerts * sizeof( dt[0] ) );
 
 	for ( i = 0; i < tri->numIndexes; i += j ) {
@@ -1641,7 +1685,7 @@ void R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes ) {
 		return;
 	}
 
-	tr.pc.c_tangentIndexes += tri->numIndexes;
+	R_PerfCounters().c_tangentIndexes += tri->numIndexes;
 
 	if ( !tri->facePlanes && allocFacePlanes ) {
 		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
@@ -2053,12 +2097,15 @@ deformInfo_t *R_BuildDeformInfo( int numVerts, const idDrawVert *verts, int numI
 	deform->numDupVerts = tri.numDupVerts;
 	deform->dupVerts = tri.dupVerts;
 
-	if ( tri.verts ) {
-		triVertexAllocator.Free( tri.verts );
-	}
+	{
+		std::lock_guard<std::mutex> lock( triAllocatorMutex );
+		if ( tri.verts ) {
+			triVertexAllocator.Free( tri.verts );
+		}
 
-	if ( tri.facePlanes ) {
-		triPlaneAllocator.Free( tri.facePlanes );
+		if ( tri.facePlanes ) {
+			triPlaneAllocator.Free( tri.facePlanes );
+		}
 	}
 
 	return deform;
@@ -2070,6 +2117,7 @@ R_FreeDeformInfo
 ===================
 */
 void R_FreeDeformInfo( deformInfo_t *deformInfo ) {
+	std::lock_guard<std::mutex> lock( triAllocatorMutex );
 	if ( deformInfo->indexes != NULL ) {
 		triIndexAllocator.Free( deformInfo->indexes );
 	}
@@ -164,6 +164,110 @@ void idSoundCache::BeginLevelLoad() {
 	soundCacheAllocator.FreeEmptyBaseBlocks();
 }
 
+/*
+====================
+DeferDecode
+
+Returns true if the sample is queued to be decoded at the end of the level load
+====================
+*/
+bool idSoundCache::DeferDecode( idSoundSample *sample ) {
+	if ( !insideLevelLoad ) {
+		return false;
+	}
+	pendingDecodes.AddUnique( sample );
+	return true;
+}
+
+typedef struct {
+	idSoundSample *		sample;
+	short *				dest;
+	bool				decoded;
+	int					msec;
+} soundDecodeJob_t;
+
+/*
+====================
+DecodeSampleJob
+====================
+*/
+static void DecodeSampleJob( soundDecodeJob_t *job ) {
+	idTimer timer;
+
+	timer.Start();
+	job->decoded = idSampleDecoder::DecodeToPCM( job->sample, job->dest );
+	timer.Stop();
+
+	job->msec = timer.Milliseconds();
+}
+
+REGISTER_PARALLEL_JOB( DecodeSampleJob, "DecodeSampleJob" );
+
+/*
+====================
+DecodePendingSamples
+
+Decodes the OGG samples queued by DeferDecode on the job threads, the OpenAL
+buffers are created here afterwards. Returns the number of decoded samples.
+====================
+*/
+int idSoundCache::DecodePendingSamples( int &decodeMsec ) {
+	idList<soundDecodeJob_t> jobs;
+
+	decodeMsec = 0;
+
+	jobs.Resize( pendingDecodes.Num() );
+	for ( int i = 0; i < pendingDecodes.Num(); i++ ) {
+		idSoundSample *sample = pendingDecodes[i];
+
+		// skip samples that were purged or reloaded in the meantime
+		if ( sample->purged || sample->hardwareBuffer || sample->objectInfo.wFormatTag != WAVE_FORMAT_TAG_OGG ) {
+			continue;
+		}
+
+		// the cache allocator isn't thread safe
+		soundDecodeJob_t &job = jobs.Alloc();
+		job.sample = sample;
+		job.dest = (short *)soundCacheAllocator.Alloc( sample->objectSize * sizeof( short ) );
+		job.decoded = false;
+		job.msec = 0;
+	}
+	pendingDecodes.Clear();
+
+	if ( idSoundSystemLocal::s_parallelDecode.GetBool() && jobs.Num() > 1 ) {
+		idParallelJobList *jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, jobs.Num(), 0, NULL );
+		for ( int i = 0; i < jobs.Num(); i++ ) {
+			jobList->AddJob( (jobRun_t)DecodeSampleJob, &jobs[i] );
+		}
+		jobList->Submit();
+		jobList->Wait();
+		parallelJobManager->FreeJobList( jobList );
+	} else {
+		for ( int i = 0; i < jobs.Num(); i++ ) {
+			DecodeSampleJob( &jobs[i] );
+		}
+	}
+
+	int count = 0;
+	for ( int i = 0; i < jobs.Num(); i++ ) {
+		soundDecodeJob_t &job = jobs[i];
+
+		// the decoder memory may have run out with too many at the same time, try again alone
+		if ( !job.decoded ) {
+			DecodeSampleJob( &job );
+		}
+		if ( job.decoded ) {
+			job.sample->CreateDecodedBuffer( job.dest );
+			count++;
+		}
+		decodeMsec += job.msec;
+
+		soundCacheAllocator.Free( (byte *)job.dest );
+	}
+
+	return count;
+}
+
 /*
 ====================
 EndLevelLoad
@@ -197,10 +301,20 @@ void idSoundCache::EndLevelLoad() {
 		}
 	}
 
+	// decode the short OGG samples that are still needed
+	idTimer decodeTimer;
+	int decodeMsec;
+	decodeTimer.Start();
+	const int decodeCount = DecodePendingSamples( decodeMsec );
+	decodeTimer.Stop();
+
 	soundCacheAllocator.FreeEmptyBaseBlocks();
 
 	common->Printf( "%5ik referenced\n", useCount / 1024 );
 	common->Printf( "%5ik purged\n", purgeCount / 1024 );
+	if ( decodeCount ) {
+		common->Printf( "%5i samples decoded in %i msec (%i msec decode time)\n", decodeCount, (int)decodeTimer.Milliseconds(), decodeMsec );
+	}
 	common->Printf( "----------------------------------------\n" );
 }
 
@@ -537,66 +651,18 @@ void idSoundSample::Load( void ) {
 				hardwareBuffer = true;
 			}
 		}
-		
-		// OGG decompressed at load time (when smaller than s_decompressionLimit seconds, 6 seconds by default)
-		if ( objectInfo.wFormatTag == WAVE_FORMAT_TAG_OGG ) {
-			if ( ( objectSize < ( ( int ) objectInfo.nSamplesPerSec * idSoundSystemLocal::s_decompressionLimit.GetInteger() ) ) ) {
-				alGetError();
-				alGenBuffers( 1, &openalBuffer );
-				errorCode = alGetError();
-				if (errorCode != AL_NO_ERROR)
-				{
-						IssueSoundSampleFailure("idSoundCache: OGG error generating OpenAL hardware buffer", errorCode, name.c_str());
-				}
-				if ( alIsBuffer( openalBuffer ) ) {
-					idSampleDecoder *decoder = idSampleDecoder::Alloc();
-					float *destData = (float *)soundCacheAllocator.Alloc( ( LengthIn44kHzSamples() + 1 ) * sizeof( float ) );
-					
-					// Decoder *always* outputs 44 kHz data
-					decoder->Decode( this, 0, LengthIn44kHzSamples(), destData );
-
-					// Downsample back to original frequency (save memory)
-					if ( objectInfo.nSamplesPerSec == 11025 ) {
-						for ( int i = 0; i < objectSize; i++ ) {
-							if ( destData[i*4] < -32768.0f )
-								((short *)destData)[i] = -32768;
-							else if ( destData[i*4] > 32767.0f )
-								((short *)destData)[i] = 32767;
-							else
-								((short *)destData)[i] = idMath::FtoiFast( destData[i*4] );
-						}
-					} else if ( objectInfo.nSamplesPerSec == 22050 ) {
-						for ( int i = 0; i < objectSize; i++ ) {
-							if ( destData[i*2] < -32768.0f )
-								((short *)destData)[i] = -32768;
-							else if ( destData[i*2] > 32767.0f )
-								((short *)destData)[i] = 32767;
-							else
-								((short *)destData)[i] = idMath::FtoiFast( destData[i*2] );
-						}
-					} else {
-						for ( int i = 0; i < objectSize; i++ ) {
-							if ( destData[i] < -32768.0f )
-								((short *)destData)[i] = -32768;
-							else if ( destData[i] > 32767.0f )
-								((short *)destData)[i] = 32767;
-							else
-								((short *)destData)[i] = idMath::FtoiFast( destData[i] );
-						}
-					}
-
-					alGetError();
-					alBufferData( openalBuffer, objectInfo.nChannels==1?AL_FORMAT_MONO16:AL_FORMAT_STEREO16, destData, objectSize * sizeof( short ), objectInfo.nSamplesPerSec );
-					ALenum alError = alGetError();
-					if ( alError != AL_NO_ERROR )
-						IssueSoundSampleFailure("idSoundCache Load OGG: error loading data into OpenAL hardware buffer", alError, name.c_str());
-					else {
-						hardwareBuffer = true;
-					}
-
-					soundCacheAllocator.Free( (byte *)destData );
-					idSampleDecoder::Free( decoder );
+	}
+
+	// OGG decompressed at load time (when smaller than s_decompressionLimit seconds, 6 seconds by default)
+	if ( objectInfo.wFormatTag == WAVE_FORMAT_TAG_OGG ) {
+		if ( ( objectSize < ( ( int ) objectInfo.nSamplesPerSec * idSoundSystemLocal::s_decompressionLimit.GetInteger() ) ) ) {
+			// during a level load all of them are decoded together by idSoundCache::EndLevelLoad
+			if ( !soundSystemLocal.soundCache->DeferDecode( this ) ) {
+				short *destData = (short *)soundCacheAllocator.Alloc( objectSize * sizeof( short ) );
+				if ( idSampleDecoder::DecodeToPCM( this, destData ) ) {
+					CreateDecodedBuffer( destData );
 				}
+				soundCacheAllocator.Free( (byte *)destData );
 			}
 		}
 	}
@@ -604,6 +670,32 @@ void idSoundSample::Load( void ) {
 	fh.Close();
 }
 
+/*
+===================
+idSoundSample::CreateDecodedBuffer
+
+Creates the OpenAL buffer of an OGG sample from its samples decoded by idSampleDecoder::DecodeToPCM
+===================
+*/
+void idSoundSample::CreateDecodedBuffer( const short *data ) {
+	alGetError();
+	alGenBuffers( 1, &openalBuffer );
+	ALenum errorCode = alGetError();
+	if ( errorCode != AL_NO_ERROR ) {
+		IssueSoundSampleFailure( "idSoundCache: OGG error generating OpenAL hardware buffer", errorCode, name.c_str() );
+	}
+	if ( alIsBuffer( openalBuffer ) ) {
+		alGetError();
+		alBufferData( openalBuffer, objectInfo.nChannels==1?AL_FORMAT_MONO16:AL_FORMAT_STEREO16, data, objectSize * sizeof( short ), objectInfo.nSamplesPerSec );
+		errorCode = alGetError();
+		if ( errorCode != AL_NO_ERROR ) {
+			IssueSoundSampleFailure( "idSoundCache Load OGG: error loading data into OpenAL hardware buffer", errorCode, name.c_str() );
+		} else {
+			hardwareBuffer = true;
+		}
+	}
+}
+
 /*
 ===================
 idSoundSample::PurgeSoundSample
@@ -20,6 +20,7 @@
 
 #include "snd_local.h"
 #include "../ExtLibs/vorbis.h"
+#include <mutex>
 
 
 /*
@@ -33,16 +34,38 @@
 */
 
 idDynamicBlockAlloc<byte, 1<<20, 128>		decoderMemoryAllocator;
+static std::mutex							decoderMemoryMutex;		// samples are also decoded on the job threads at level load
 
 const int MIN_OGGVORBIS_MEMORY				= 768 * 1024;
 
+static int									decoderMemoryReserved = 0;	// promised to decoders that are being opened or decoded, decoderMemoryMutex
+
+// makes sure there is enough space for another decoder and keeps it from being taken by
+// the other threads until ReleaseDecoderMemory, the check alone would let them all pass together
+static bool ReserveDecoderMemory( void ) {
+	std::lock_guard<std::mutex> lock( decoderMemoryMutex );
+	if ( decoderMemoryAllocator.GetFreeBlockMemory() - decoderMemoryReserved < MIN_OGGVORBIS_MEMORY ) {
+		return false;
+	}
+	decoderMemoryReserved += MIN_OGGVORBIS_MEMORY;
+	return true;
+}
+
+static void ReleaseDecoderMemory( void ) {
+	std::lock_guard<std::mutex> lock( decoderMemoryMutex );
+	decoderMemoryReserved -= MIN_OGGVORBIS_MEMORY;
+	assert( decoderMemoryReserved >= 0 );
+}
+
 void *custom_decoder_malloc( size_t size ) {
+	std::lock_guard<std::mutex> lock( decoderMemoryMutex );
 	void *ptr = decoderMemoryAllocator.Alloc(static_cast<int>(size));
 	assert( size == 0 || ptr != NULL );
 	return ptr;
 }
 
 void *custom_decoder_calloc( size_t num, size_t size ) {
+	std::lock_guard<std::mutex> lock( decoderMemoryMutex );
 	void *ptr = decoderMemoryAllocator.Alloc(static_cast<int>(num * size));
 	assert( ( num * size ) == 0 || ptr != NULL );
 	memset( ptr, 0, num * size );
@@ -50,12 +73,14 @@ void *custom_decoder_calloc( size_t num, size_t size ) {
 }
 
 void *custom_decoder_realloc( void *memblock, size_t size ) {
+	std::lock_guard<std::mutex> lock( decoderMemoryMutex );
 	void *ptr = decoderMemoryAllocator.Resize((byte *)memblock, static_cast<int>(size));
 	assert( size == 0 || ptr != NULL );
 	return ptr;
 }
 
 void custom_decoder_free( void *memblock ) {
+	std::lock_guard<std::mutex> lock( decoderMemoryMutex );
 	decoderMemoryAllocator.Free( (byte *)memblock );
 }
 
@@ -150,13 +175,10 @@ int idWaveFile::OpenOGG( const char* strFileName, waveformatex_t *pwfx ) {
 		return -1;
 	}
 
-	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
-
 	ov = new OggVorbis_File;
 
 	if( ov_openFile( mhmmio, ov ) < 0 ) {
 		delete ov;
-		Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
 		fileSystem->CloseFile( mhmmio );
 		mhmmio = NULL;
 		return -1;
@@ -193,8 +215,6 @@ int idWaveFile::OpenOGG( const char* strFileName, waveformatex_t *pwfx ) {
 
 	memcpy( pwfx, &mpwfx, sizeof( waveformatex_t ) );
 
-	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
-
 	isOgg = true;
 
 	return 0;
@@ -239,10 +259,8 @@ idWaveFile::CloseOGG
 int idWaveFile::CloseOGG( void ) {
 	OggVorbis_File *ov = (OggVorbis_File *) ogg;
 	if ( ov != NULL ) {
-		Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
 		ExtLibs::ov_clear( ov );
 		delete ov;
-		Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
 		fileSystem->CloseFile( mhmmio );
 		mhmmio = NULL;
 		ogg = NULL;
@@ -273,6 +291,9 @@ public:
 	int						DecodeCinematics( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
 
 private:
+	void					CloseDecoder( void );
+
+	std::mutex				decodeMutex;		// a channel is decoded by the sound thread and by the main thread for shakes
 	bool					failed;				// set if decoding failed
 	int						lastFormat;			// last format being decoded
 	idSoundSample *			lastSample;			// last sample being decoded
@@ -284,6 +305,7 @@ private:
 };
 
 idBlockAlloc<idSampleDecoderLocal, 64>		sampleDecoderAllocator;
+static std::mutex							sampleDecoderMutex;
 
 /*
 ====================
@@ -315,7 +337,11 @@ idSampleDecoder::Alloc
 ====================
 */
 idSampleDecoder *idSampleDecoder::Alloc( void ) {
-	idSampleDecoderLocal *decoder = sampleDecoderAllocator.Alloc();
+	idSampleDecoderLocal *decoder;
+	{
+		std::lock_guard<std::mutex> lock( sampleDecoderMutex );
+		decoder = sampleDecoderAllocator.Alloc();
+	}
 	decoder->Clear();
 	return decoder;
 }
@@ -328,6 +354,8 @@ idSampleDecoder::Free
 void idSampleDecoder::Free( idSampleDecoder *decoder ) {
 	idSampleDecoderLocal *localDecoder = static_cast<idSampleDecoderLocal *>( decoder );
 	localDecoder->ClearDecoder();
+
+	std::lock_guard<std::mutex> lock( sampleDecoderMutex );
 	sampleDecoderAllocator.Free( localDecoder );
 }
 
@@ -349,6 +377,54 @@ int idSampleDecoder::GetUsedBlockMemory( void ) {
 	return decoderMemoryAllocator.GetUsedBlockMemory();
 }
 
+/*
+====================
+idSampleDecoder::DecodeToPCM
+
+Decodes a complete OGG sample to 16 bit samples at its own rate, objectSize samples
+are written to dest. Doesn't use any shared decoder state, so several samples can be
+decoded at the same time. Returns false if the sample couldn't be decoded.
+====================
+*/
+bool idSampleDecoder::DecodeToPCM( const idSoundSample *sample, short *dest ) {
+	if ( sample->objectInfo.wFormatTag != WAVE_FORMAT_TAG_OGG || sample->nonCacheData == NULL ) {
+		return false;
+	}
+
+	// the memory stays reserved for the whole decode, the callers retry one at a time if it ran out
+	if ( !ReserveDecoderMemory() ) {
+		return false;
+	}
+
+	idFile_Memory file( sample->name, (const char *)sample->nonCacheData, sample->objectMemSize );
+	OggVorbis_File ogg;
+	if ( ov_openFile( &file, &ogg ) < 0 ) {
+		ReleaseDecoderMemory();
+		return false;
+	}
+
+	char *bufferPtr = (char *)dest;
+	int total = sample->objectSize * sizeof( short );
+	while ( total > 0 ) {
+		int ret = ExtLibs::ov_read( &ogg, bufferPtr, total >= 4096 ? 4096 : total, Swap_IsBigEndian(), 2, 1, &ogg.stream );
+		if ( ret <= 0 ) {
+			break;
+		}
+		bufferPtr += ret;
+		total -= ret;
+	}
+
+	ExtLibs::ov_clear( &ogg );
+	ReleaseDecoderMemory();
+
+	// pad a truncated stream with silence like Decode does
+	if ( total > 0 ) {
+		memset( bufferPtr, 0, total );
+	}
+
+	return true;
+}
+
 /*
 ====================
 idSampleDecoderLocal::Clear
@@ -368,8 +444,18 @@ idSampleDecoderLocal::ClearDecoder
 ====================
 */
 void idSampleDecoderLocal::ClearDecoder( void ) {
-	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+	std::lock_guard<std::mutex> lock( decodeMutex );
+	CloseDecoder();
+}
+
+/*
+====================
+idSampleDecoderLocal::CloseDecoder
 
+Frees the format specific decoder state, decodeMutex must be held.
+====================
+*/
+void idSampleDecoderLocal::CloseDecoder( void ) {
 	switch( lastFormat ) {
 		case WAVE_FORMAT_TAG_PCM: {
 			break;
@@ -382,8 +468,6 @@ void idSampleDecoderLocal::ClearDecoder( void ) {
 	}
 
 	Clear();
-
-	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
 }
 
 /*
@@ -412,8 +496,11 @@ idSampleDecoderLocal::Decode
 void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest ) {
 	int readSamples44k;
 
+	// only this decoder's own state is touched, so different channels are decoded concurrently
+	std::lock_guard<std::mutex> lock( decodeMutex );
+
 	if ( sample->objectInfo.wFormatTag != lastFormat || sample != lastSample ) {
-		ClearDecoder();
+		CloseDecoder();
 	}
 
 	lastDecodeTime = soundSystemLocal.CurrentSoundTime;
@@ -423,9 +510,6 @@ void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, i
 		return;
 	}
 
-	// samples can be decoded both from the sound thread and the main thread for shakes
-	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
-
 	switch( sample->objectInfo.wFormatTag ) {
 		case WAVE_FORMAT_TAG_PCM: {
 			readSamples44k = DecodePCM( sample, sampleOffset44k, sampleCount44k, dest );
@@ -447,8 +531,6 @@ void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, i
 		}
 	}
 
-	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
-
 	if ( readSamples44k < sampleCount44k ) {
 		memset( dest + readSamples44k, 0, ( sampleCount44k - readSamples44k ) * sizeof( dest[0] ) );
 	}
@@ -520,17 +602,20 @@ int idSampleDecoderLocal::DecodeOGG( idSoundSample *sample, int sampleOffset44k,
 
 	// open OGG file if not yet opened
 	if ( lastSample == NULL ) {
-		// make sure there is enough space for another decoder
-		if ( decoderMemoryAllocator.GetFreeBlockMemory() < MIN_OGGVORBIS_MEMORY ) {
-			return 0;
-		}
 		if ( sample->nonCacheData == NULL ) {
 			assert( false );	// this should never happen
 			failed = true;
 			return 0;
 		}
+		// the reservation covers the allocations of opening, the open decoder keeps
+		// what it allocated out of the free memory afterwards
+		if ( !ReserveDecoderMemory() ) {
+			return 0;
+		}
 		file.SetData( (const char *)sample->nonCacheData, sample->objectMemSize );
-		if ( ov_openFile( &file, &ogg ) < 0 ) {
+		const int ret = ov_openFile( &file, &ogg );
+		ReleaseDecoderMemory();
+		if ( ret < 0 ) {
 			failed = true;
 			return 0;
 		}
@@ -234,6 +234,17 @@ void idSoundChannel::ALStop( void ) {
 	}
 }
 
+/*
+===================
+idSoundChannel::HasOpenALResources
+
+True until ALStop has released the source and streaming buffers
+===================
+*/
+bool idSoundChannel::HasOpenALResources( void ) const {
+	return openalSource != 0 || openalStreamingBuffer[0] != 0 || lastopenalStreamingBuffer[0] != 0;
+}
+
 /*
 ===================
 idSoundChannel::GatherChannelSamples
@@ -329,6 +340,7 @@ idSoundEmitterLocal::idSoundEmitterLocal
 idSoundEmitterLocal::idSoundEmitterLocal( void ) {	
 	soundWorld = NULL;
 	index = -1;
+	activeNode.SetOwner( this );
 	Clear();
 }
 
@@ -362,12 +374,15 @@ void idSoundEmitterLocal::Clear( void ) {
 
 	playing = false;
 	hasShakes = false;
+	mixChannels = 0;
+	activeNode.Remove();
 	ampTime = 0;			// last time someone queried
 	amplitude = 0;
 	maxDistance = 10.0f;	// meters
 	minDistance = 0.0f;		// grayman #3042
 	volumeLoss = 0.0f;
 	spatializedOrigin.Zero();
+	spatialCache.valid = false;
 
 	memset( &parms, 0, sizeof( parms ) );
 }
@@ -491,6 +506,38 @@ void idSoundEmitterLocal::CheckForCompletion( int current44kHzTime ) {
 			removeStatus = REMOVE_STATUS_SAMPLEFINISHED;
 		}
 	}
+
+	UpdateActiveState();
+}
+
+/*
+==================
+idSoundEmitterLocal::UpdateActiveState
+
+Keeps the emitter in the active list of the sound world and the channel mask used
+by the mixer in sync with the channels, so the silent emitters are never visited.
+Callers have to hold the sound critical section, the async mixer walks the list inside it.
+==================
+*/
+void idSoundEmitterLocal::UpdateActiveState( void ) {
+	mixChannels = 0;
+	if ( playing ) {
+		for ( int i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
+			// a stopped channel is kept until the mixer has freed its OpenAL source
+			if ( channels[i].triggerState || channels[i].HasOpenALResources() ) {
+				mixChannels |= BIT( i );
+			}
+		}
+	}
+
+	bool active = ( playing || removeStatus == REMOVE_STATUS_WAITSAMPLEFINISHED ) && removeStatus < REMOVE_STATUS_SAMPLEFINISHED;
+	if ( active && soundWorld != NULL ) {
+		if ( !activeNode.InList() ) {
+			activeNode.AddToEnd( soundWorld->activeEmitters );
+		}
+	} else {
+		activeNode.Remove();
+	}
 }
 
 /*
@@ -578,7 +625,22 @@ void idSoundEmitterLocal::Spatialize( idVec3 listenerPos, int listenerArea, idRe
 		volumeLoss = 0; // grayman #3042 - accumulates volume loss via ResolveOrigin() processing
 
 		SoundChainResults results;
-		if ( soundWorld->ResolveOrigin( 0, NULL, soundInArea, 0.0f, 0.0f, origin, origin, this, &results ) ) // grayman #3042
+		bool resolved;
+		if ( CheckSpatialCache( listenerArea, soundInArea, rw ) )
+		{
+			resolved = spatialCache.resolved;
+			results = spatialCache.results;
+			soundWorld->numSpatialCacheHits++;
+		}
+		else
+		{
+			resolved = soundWorld->ResolveOrigin( 0, NULL, soundInArea, 0.0f, 0.0f, origin, origin, this, &results ); // grayman #3042
+			spatialCache.resolved = resolved;
+			spatialCache.results = results;
+			soundWorld->numSpatialRecomputes++;
+		}
+
+		if ( resolved )
 		{
 			// get results
 			spatializedOrigin = results.spatializedOrigin;
@@ -597,6 +659,60 @@ void idSoundEmitterLocal::Spatialize( idVec3 listenerPos, int listenerArea, idRe
 	}
 }
 
+/*
+===================
+idSoundEmitterLocal::CheckSpatialCache
+
+Returns true if the last portal flood is still valid, otherwise the cache key is
+updated for the new ResolveOrigin result.
+===================
+*/
+bool idSoundEmitterLocal::CheckSpatialCache( int listenerArea, int soundArea, idRenderWorld *rw ) {
+	float grid = idSoundSystemLocal::s_spatialCacheGrid.GetFloat();
+	if ( grid <= 0.0f ) {
+		spatialCache.valid = false;
+		return false;
+	}
+
+	int listenerCell[3], soundCell[3];
+	for ( int i = 0; i < 3; i++ ) {
+		listenerCell[i] = idMath::Ftoi( idMath::Floor( soundWorld->listenerQU[i] / grid ) );
+		soundCell[i] = idMath::Ftoi( idMath::Floor( origin[i] / grid ) );
+	}
+
+	int portalGeneration = rw->GetPortalSoundGeneration();
+	float diffractionMax = idSoundSystemLocal::s_diffractionMax.GetFloat();
+	bool quadraticFalloff = idSoundSystemLocal::s_quadraticFalloff.GetBool();
+
+	if ( spatialCache.valid
+		&& spatialCache.listenerArea == listenerArea
+		&& spatialCache.soundArea == soundArea
+		&& spatialCache.portalGeneration == portalGeneration
+		&& memcmp( spatialCache.listenerCell, listenerCell, sizeof( listenerCell ) ) == 0
+		&& memcmp( spatialCache.soundCell, soundCell, sizeof( soundCell ) ) == 0
+		&& spatialCache.minDistance == minDistance
+		&& spatialCache.maxDistance == maxDistance
+		&& spatialCache.volume == parms.volume
+		&& spatialCache.diffractionMax == diffractionMax
+		&& spatialCache.quadraticFalloff == quadraticFalloff ) {
+		return true;
+	}
+
+	spatialCache.valid = true;
+	spatialCache.listenerArea = listenerArea;
+	spatialCache.soundArea = soundArea;
+	spatialCache.portalGeneration = portalGeneration;
+	memcpy( spatialCache.listenerCell, listenerCell, sizeof( listenerCell ) );
+	memcpy( spatialCache.soundCell, soundCell, sizeof( soundCell ) );
+	spatialCache.minDistance = minDistance;
+	spatialCache.maxDistance = maxDistance;
+	spatialCache.volume = parms.volume;
+	spatialCache.diffractionMax = diffractionMax;
+	spatialCache.quadraticFalloff = quadraticFalloff;
+
+	return false;
+}
+
 /*
 ===========================================================================================
 
@@ -657,11 +773,16 @@ void idSoundEmitterLocal::Free( bool immediate ) {
 		soundWorld->writeDemo->WriteInt( immediate );
 	}
 
+	// the active list is walked by the async mixer
+	Sys_EnterCriticalSection();
 	if ( !immediate ) {
 		removeStatus = REMOVE_STATUS_WAITSAMPLEFINISHED;
+		// the next update releases it once the last channel has finished
+		UpdateActiveState();
 	} else {
 		Clear();
 	}
+	Sys_LeaveCriticalSection();
 }
 
 /*
@@ -864,6 +985,7 @@ int idSoundEmitterLocal::StartSound( const idSoundShader *shader, const s_channe
 
 	// we need to start updating the def and mixing it in
 	playing = true;
+	UpdateActiveState();
 
 	// spatialize it immediately, so it will start the next mix block
 	// even if that happens before the next PlaceOrigin()
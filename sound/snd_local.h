@@ -357,6 +357,7 @@ public:
 	void				Stop( void );
 	void				GatherChannelSamples( int sampleOffset44k, int sampleCount44k, float *dest ) const;
 	void				ALStop( void );			// free OpenAL resources if any
+	bool				HasOpenALResources( void ) const;
 
 	bool				triggerState;
 	int					trigger44kHzTime;		// hardware time sample the channel started
@@ -390,6 +391,25 @@ public:
 	float				spatialDistance; // distance back to the spacializedOrigin
 };
 
+// The last portal flood of an emitter, Spatialize reuses it while the areas, the portal
+// losses, the falloff parameters and the snapped listener and sound positions stay the same
+typedef struct {
+	bool				valid;
+	int					listenerArea;
+	int					soundArea;
+	int					portalGeneration;
+	int					listenerCell[3];
+	int					soundCell[3];
+	float				minDistance;
+	float				maxDistance;
+	float				volume;
+	float				diffractionMax;
+	bool				quadraticFalloff;
+
+	bool				resolved;			// ResolveOrigin found an open path
+	SoundChainResults	results;
+} soundSpatialCache_t;
+
 class idSoundEmitterLocal : public idSoundEmitter {
 public:
 
@@ -430,7 +450,9 @@ public:
 
 	void				OverrideParms( const soundShaderParms_t *base, const soundShaderParms_t *over, soundShaderParms_t *out );
 	void				CheckForCompletion( int current44kHzTime );
+	void				UpdateActiveState( void );
 	void				Spatialize( idVec3 listenerPos, int listenerArea, idRenderWorld *rw );
+	bool				CheckSpatialCache( int listenerArea, int soundArea, idRenderWorld *rw );
 
 	idSoundWorldLocal *	soundWorld;				// the world that holds this emitter
 
@@ -449,8 +471,11 @@ public:
 	int					lastValidPortalArea;		// so an emitter that slides out of the world continues playing
 	bool				playing;					// if false, no channel is active
 	bool				hasShakes;
+	int					mixChannels;				// bit for each channel that is triggered or still holds OpenAL resources
+	idLinkList<idSoundEmitterLocal>	activeNode;		// in soundWorld->activeEmitters while playing or waiting to be freed
 	idVec3				spatializedOrigin;			// the virtual sound origin, either the real sound origin,
 													// or a point through a portal chain
+	soundSpatialCache_t	spatialCache;
 	float				realDistance;				// in meters
 	float				distance;					// in meters, this may be the straight-line distance, or
 													// it may go through a chain of portals.  If there
@@ -604,6 +629,15 @@ public:
 	int						lastAVI44kHz;		// determine when we need to mix and write another block
 
 	idList<idSoundEmitterLocal *>emitters;
+	idLinkList<idSoundEmitterLocal>	activeEmitters;	// only these are updated and mixed
+	int						numEmittersVisited;	// by the last ForegroundUpdate
+	int						numEmittersMixed;	// by the last MixLoop
+	int						numSpatialCacheHits;	// since the last ForegroundUpdate
+	int						numSpatialRecomputes;
+
+	// EFX effect resolved for the listener area, looked up again when the area changes
+	int						efxListenerArea;
+	idStr					efxListenerAreaName;
 
 	idSoundFade				soundClassFade[SOUND_MAX_CLASSES];	// for global sound fading
 
@@ -774,12 +808,15 @@ public:
 	static idCVar			s_globalFraction;
 	static idCVar			s_doorDistanceAdd;
 	static idCVar			s_singleEmitter;
+	static idCVar			s_showEmitterStats;
+	static idCVar			s_spatialCacheGrid;
 	static idCVar			s_numberOfSpeakers;
 	static idCVar			s_force22kHz;
 	static idCVar			s_clipVolumes;
 	static idCVar			s_realTimeDecoding;
 	static idCVar			s_useEAXReverb;
 	static idCVar			s_decompressionLimit;
+	static idCVar			s_parallelDecode;
 
 	static idCVar			s_slowAttenuate;
 
@@ -834,6 +871,7 @@ public:
 	void					Reload( bool force );		// reloads if timestamp has changed, or always if force
 	void					PurgeSoundSample();			// frees all data
 	void					CheckForDownSample();		// down sample if required
+	void					CreateDecodedBuffer( const short *data );	// hardware buffer from a decoded OGG sample
 	bool					FetchFromCache( int offset, const byte **output, int *position, int *size, const bool allowIO );
 
 	//stgatilov #4534: for playing sound from a video
@@ -859,6 +897,7 @@ public:
 	static void				Free( idSampleDecoder *decoder );
 	static int				GetNumUsedBlocks( void );
 	static int				GetUsedBlockMemory( void );
+	static bool				DecodeToPCM( const idSoundSample *sample, short *dest );
 
 	virtual					~idSampleDecoder( void ) {}
 	virtual void			Decode( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest ) = 0;
@@ -891,11 +930,17 @@ public:
 	void					BeginLevelLoad();
 	void					EndLevelLoad();
 
+	// queues a short OGG sample to be decoded at the end of the level load
+	bool					DeferDecode( idSoundSample *sample );
+
 	void					PrintMemInfo( MemInfo_t *mi );
 
 private:
+	int						DecodePendingSamples( int &decodeMsec );
+
 	bool					insideLevelLoad;
 	idList<idSoundSample*>	listCache;
+	idList<idSoundSample*>	pendingDecodes;
 };
 
 #endif /* !__SND_LOCAL_H__ */
@@ -47,10 +47,13 @@ idCVar idSoundSystemLocal::s_subFraction( "s_subFraction", "0.75", CVAR_SOUND |
 idCVar idSoundSystemLocal::s_globalFraction( "s_globalFraction", "0.8", CVAR_SOUND | CVAR_ARCHIVE | CVAR_FLOAT, "volume to all speakers when not spatialized" );
 idCVar idSoundSystemLocal::s_doorDistanceAdd( "s_doorDistanceAdd", "450", CVAR_SOUND | CVAR_ARCHIVE | CVAR_FLOAT, "reduce sound volume with this distance when going through a door" );
 idCVar idSoundSystemLocal::s_singleEmitter( "s_singleEmitter", "0", CVAR_SOUND | CVAR_INTEGER, "mute all sounds but this emitter" );
+idCVar idSoundSystemLocal::s_showEmitterStats( "s_showEmitterStats", "0", CVAR_SOUND | CVAR_BOOL, "print the number of sound emitters visited by each update" );
+idCVar idSoundSystemLocal::s_spatialCacheGrid( "s_spatialCacheGrid", "4", CVAR_SOUND | CVAR_FLOAT, "reuse the portal flooding of an emitter while the listener and the sound stay in the same cell of this size, 0 = always flood" );
 idCVar idSoundSystemLocal::s_numberOfSpeakers( "s_numberOfSpeakers", "2", CVAR_SOUND | CVAR_ARCHIVE, "number of speakers" );
 idCVar idSoundSystemLocal::s_force22kHz( "s_force22kHz", "0", CVAR_SOUND | CVAR_BOOL, ""  );
 idCVar idSoundSystemLocal::s_clipVolumes( "s_clipVolumes", "1", CVAR_SOUND | CVAR_BOOL, ""  );
 idCVar idSoundSystemLocal::s_realTimeDecoding( "s_realTimeDecoding", "1", CVAR_SOUND | CVAR_BOOL | CVAR_INIT, "" );
+idCVar idSoundSystemLocal::s_parallelDecode( "s_parallelDecode", "1", CVAR_SOUND | CVAR_BOOL, "decode the short OGG samples of a level on the job threads" );
 
 idCVar idSoundSystemLocal::s_slowAttenuate( "s_slowAttenuate", "1", CVAR_SOUND | CVAR_BOOL, "slowmo sounds attenuate over shorted distance" );
 idCVar idSoundSystemLocal::s_enviroSuitCutoffFreq( "s_enviroSuitCutoffFreq", "2000", CVAR_SOUND | CVAR_FLOAT, "" );
@@ -90,6 +93,8 @@ void SoundReloadSounds_f( const idCmdArgs &args ) {
 		force = true;
 	}
 	soundSystem->SetMute( true );
+	// loose sounds might have been added in front of the paks
+	fileSystem->ClearDirCache();
 	soundSystemLocal.soundCache->ReloadSounds( force );
 	if (soundSystemLocal.useEFXReverb) {
 		bool ok = soundSystemLocal.EFXDatabase.Reload();
@@ -240,6 +245,172 @@ void ListSoundDecoders_f( const idCmdArgs &args ) {
 	common->Printf( "%d kB decoder memory in %d blocks\n", idSampleDecoder::GetUsedBlockMemory() >> 10, idSampleDecoder::GetNumUsedBlocks() );
 }
 
+typedef struct {
+	idSampleDecoder *	decoder;
+	idSoundSample *		sample;
+	float *				buffer;
+	int					numBlocks;
+	unsigned int		checksum;
+	int					starvedBlocks;	// blocks without decoder memory to open the stream
+} soundDecoderTestJob_t;
+
+/*
+===============
+TestSoundDecoderJob
+
+Decodes a looping sample block by block like a streaming channel does
+===============
+*/
+static void TestSoundDecoderJob( soundDecoderTestJob_t *job ) {
+	const int blockSize = MIXBUFFER_SAMPLES * job->sample->objectInfo.nChannels;
+	const int length = job->sample->LengthIn44kHzSamples();
+	int offset = 0;
+
+	job->checksum = 0;
+	job->starvedBlocks = 0;
+
+	for ( int i = 0; i < job->numBlocks; i++ ) {
+		job->decoder->Decode( job->sample, offset, blockSize, job->buffer );
+		if ( job->decoder->GetSample() == NULL ) {
+			job->starvedBlocks++;
+		}
+
+		const unsigned int *bits = (const unsigned int *)job->buffer;
+		for ( int j = 0; j < blockSize; j++ ) {
+			job->checksum = job->checksum * 31 + bits[j];
+		}
+
+		offset += blockSize;
+		if ( offset >= length ) {
+			offset = 0;
+		}
+	}
+}
+
+REGISTER_PARALLEL_JOB( TestSoundDecoderJob, "TestSoundDecoderJob" );
+
+/*
+===============
+RunSoundDecoderTest
+
+Returns the time in msec to run all jobs with a fresh decoder each
+===============
+*/
+static double RunSoundDecoderTest( idList<soundDecoderTestJob_t> &jobs, bool parallel ) {
+	idTimer timer;
+
+	for ( int i = 0; i < jobs.Num(); i++ ) {
+		jobs[i].decoder = idSampleDecoder::Alloc();
+	}
+
+	timer.Start();
+	if ( parallel ) {
+		idParallelJobList *jobList = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, jobs.Num(), 0, NULL );
+		for ( int i = 0; i < jobs.Num(); i++ ) {
+			jobList->AddJob( (jobRun_t)TestSoundDecoderJob, &jobs[i] );
+		}
+		jobList->Submit();
+		jobList->Wait();
+		parallelJobManager->FreeJobList( jobList );
+	} else {
+		for ( int i = 0; i < jobs.Num(); i++ ) {
+			TestSoundDecoderJob( &jobs[i] );
+		}
+	}
+	timer.Stop();
+
+	for ( int i = 0; i < jobs.Num(); i++ ) {
+		idSampleDecoder::Free( jobs[i].decoder );
+		jobs[i].decoder = NULL;
+	}
+
+	return timer.Milliseconds();
+}
+
+/*
+===============
+TestSoundDecoders_f
+
+Stress test for concurrent decoding: streams the loaded OGG samples on many channels
+at once on the job threads and compares the output with decoding them one by one.
+
+  this is called from the main thread
+===============
+*/
+void TestSoundDecoders_f( const idCmdArgs &args ) {
+	int numChannels = ( args.Argc() > 1 ) ? atoi( args.Argv( 1 ) ) : 64;
+	int numBlocks = ( args.Argc() > 2 ) ? atoi( args.Argv( 2 ) ) : 64;
+
+	if ( numChannels <= 0 || numBlocks <= 0 ) {
+		common->Printf( "Usage: testSoundDecoders [numChannels] [numBlocks]\n" );
+		return;
+	}
+	if ( !soundSystemLocal.soundCache ) {
+		common->Printf( "No sound.\n" );
+		return;
+	}
+
+	// only samples that are not decoded to an OpenAL buffer are streamed by the decoders
+	idList<idSoundSample *> samples;
+	for ( int i = 0; i < soundSystemLocal.soundCache->GetNumObjects(); i++ ) {
+		const idSoundSample *sample = soundSystemLocal.soundCache->GetObject( i );
+		if ( sample == NULL || sample->purged || sample->hardwareBuffer || sample->nonCacheData == NULL ) {
+			continue;
+		}
+		if ( sample->objectInfo.wFormatTag != WAVE_FORMAT_TAG_OGG ) {
+			continue;
+		}
+		samples.Append( const_cast<idSoundSample *>( sample ) );
+	}
+	if ( samples.Num() == 0 ) {
+		common->Printf( "No streamed OGG samples loaded, enable s_realTimeDecoding and load a map first.\n" );
+		return;
+	}
+
+	idList<soundDecoderTestJob_t> jobs;
+	jobs.SetNum( numChannels );
+	for ( int i = 0; i < numChannels; i++ ) {
+		soundDecoderTestJob_t &job = jobs[i];
+		job.decoder = NULL;
+		job.sample = samples[i % samples.Num()];
+		job.buffer = (float *)Mem_Alloc16( MIXBUFFER_SAMPLES * job.sample->objectInfo.nChannels * sizeof( float ) );
+		job.numBlocks = numBlocks;
+	}
+
+	// reference output
+	double serialMsec = RunSoundDecoderTest( jobs, false );
+	idList<unsigned int> checksums;
+	idList<int> starved;
+	checksums.SetNum( numChannels );
+	starved.SetNum( numChannels );
+	for ( int i = 0; i < numChannels; i++ ) {
+		checksums[i] = jobs[i].checksum;
+		starved[i] = jobs[i].starvedBlocks;
+	}
+
+	double parallelMsec = RunSoundDecoderTest( jobs, true );
+
+	int numMismatches = 0;
+	int numStarved = 0;
+	for ( int i = 0; i < numChannels; i++ ) {
+		soundDecoderTestJob_t &job = jobs[i];
+
+		// channels that had to wait for decoder memory produce silence for a while, don't compare those
+		if ( starved[i] != 0 || job.starvedBlocks != 0 ) {
+			numStarved++;
+		} else if ( checksums[i] != job.checksum ) {
+			common->Warning( "testSoundDecoders: channel %d decoded %s differently", i, job.sample->name.c_str() );
+			numMismatches++;
+		}
+		Mem_Free16( job.buffer );
+	}
+
+	common->Printf( "%d channels on %d samples, %d blocks of %d samples each\n", numChannels, samples.Num(), numBlocks, MIXBUFFER_SAMPLES );
+	common->Printf( "%8.1f msec decoding one channel after another\n", serialMsec );
+	common->Printf( "%8.1f msec decoding all channels concurrently\n", parallelMsec );
+	common->Printf( "%d mismatches, %d channels ran out of decoder memory\n", numMismatches, numStarved );
+}
+
 /*
 ===============
 TestSound_f
@@ -451,6 +622,7 @@ void idSoundSystemLocal::Init() {
 
 	cmdSystem->AddCommand( "listSounds", ListSounds_f, CMD_FL_SOUND, "lists all sounds" );
 	cmdSystem->AddCommand( "listSoundDecoders", ListSoundDecoders_f, CMD_FL_SOUND, "list active sound decoders" );
+	cmdSystem->AddCommand( "testSoundDecoders", TestSoundDecoders_f, CMD_FL_SOUND | CMD_FL_CHEAT, "decodes the streamed sounds on many channels at once" );
 	cmdSystem->AddCommand( "reloadSounds", SoundReloadSounds_f, CMD_FL_SOUND|CMD_FL_CHEAT, "reloads all sounds" );
 	cmdSystem->AddCommand( "testSound", TestSound_f, CMD_FL_SOUND | CMD_FL_CHEAT, "tests a sound", idCmdSystem::ArgCompletion_SoundName );
 	cmdSystem->AddCommand( "s_restart", SoundSystemRestart_f, CMD_FL_SOUND, "restarts the sound system" );
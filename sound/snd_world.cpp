@@ -37,6 +37,12 @@ void idSoundWorldLocal::Init( idRenderWorld *renderWorld ) {
 	listenerArea = 0;
 	listenerAreaName = "Undefined";
 	listenerEffect = AL_EFFECTSLOT_NULL;
+	efxListenerArea = -1;
+	efxListenerAreaName.Clear();
+	numEmittersVisited = 0;
+	numEmittersMixed = 0;
+	numSpatialCacheHits = 0;
+	numSpatialRecomputes = 0;
 
 	if (idSoundSystemLocal::useEFXReverb) {
 		if (!soundSystemLocal.alIsAuxiliaryEffectSlot(listenerSlot)) {
@@ -211,10 +217,13 @@ idSoundEmitterLocal *idSoundWorldLocal::AllocLocalSoundEmitter() {
 		}
 	}
 
+	// Clear takes a reused emitter out of the active list the async thread mixes
+	Sys_EnterCriticalSection();
 	def->Clear();
 	def->index = index;
 	def->removeStatus = REMOVE_STATUS_ALIVE;
 	def->soundWorld = this;
+	Sys_LeaveCriticalSection();
 
 	return def;
 }
@@ -326,10 +335,12 @@ void idSoundWorldLocal::ProcessDemoCommand( idDemoFile *readDemo ) {
 			emitters.Append( def );
 		}
 		def = emitters[ index ];
+		Sys_EnterCriticalSection();
 		def->Clear();
 		def->index = index;
 		def->removeStatus = REMOVE_STATUS_ALIVE;
 		def->soundWorld = this;
+		Sys_LeaveCriticalSection();
 		break;
 	case SCMD_FREE:
 		{
@@ -430,8 +441,7 @@ float idSoundWorldLocal::CurrentShakeAmplitudeForPosition( const int time, const
 
 	localTime = soundSystemLocal.GetCurrent44kHzTime();
 
-	for ( int i = 1; i < emitters.Num(); i++ ) {
-		idSoundEmitterLocal *sound = emitters[i];
+	for ( idSoundEmitterLocal *sound = activeEmitters.Next(); sound != NULL; sound = sound->activeNode.Next() ) {
 		if ( !sound->hasShakes ) {
 			continue;
 		}
@@ -453,7 +463,7 @@ for AVIdemo writing
 ===================
 */
 void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *finalMixBuffer ) {
-	int i, j;
+	int j;
 	idSoundEmitterLocal *sound;
 
 	// if noclip flying outside the world, leave silence
@@ -484,25 +494,32 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 	alListenerfv(AL_ORIENTATION, listenerOrientation);
 
 	if (idSoundSystemLocal::useEFXReverb && soundSystemLocal.efxloaded) {
-		ALuint effect = AL_EFFECTSLOT_NULL;
-		idStr s(listenerArea);
+		bool justReloaded = soundSystemLocal.EFXDatabase.IsAfterReload();
 
-		bool found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
-		if (!found) {
-			s = listenerAreaName;
-			found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
-		}
-		if (!found) {
-			s = "default";
-			found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
-		}
+		// the effect only has to be looked up again when the listener changes areas
+		if (justReloaded || listenerArea != efxListenerArea || listenerAreaName != efxListenerAreaName) {
+			ALuint effect = AL_EFFECTSLOT_NULL;
+			idStr s(listenerArea);
 
-		bool justReloaded = soundSystemLocal.EFXDatabase.IsAfterReload();
-		// only update if change in settings
-		if (listenerEffect != effect || justReloaded) {
-			common->Printf("Switching to EFX '%s' (#%u)\n", s.c_str(), effect);
-			listenerEffect = effect;
-			soundSystemLocal.alAuxiliaryEffectSloti(listenerSlot, AL_EFFECTSLOT_EFFECT, effect);
+			bool found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
+			if (!found) {
+				s = listenerAreaName;
+				found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
+			}
+			if (!found) {
+				s = "default";
+				found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
+			}
+
+			efxListenerArea = listenerArea;
+			efxListenerAreaName = listenerAreaName;
+
+			// only update if change in settings
+			if (listenerEffect != effect || justReloaded) {
+				common->Printf("Switching to EFX '%s' (#%u)\n", s.c_str(), effect);
+				listenerEffect = effect;
+				soundSystemLocal.alAuxiliaryEffectSloti(listenerSlot, AL_EFFECTSLOT_EFFECT, effect);
+			}
 		}
 	}
 
@@ -515,6 +532,10 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 			for ( j = 0; j < SOUND_MAX_CHANNELS ; j++ ) {
 				idSoundChannel	*chan = &sound->channels[j];
 
+				if ( !( sound->mixChannels & BIT( j ) ) ) {
+					continue;
+				}
+
 				// see if we have a sound triggered on this channel
 				if ( !chan->triggerState ) {
 					chan->ALStop();
@@ -527,20 +548,23 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 		return;
 	}
 
-	for ( i = 1; i < emitters.Num(); i++ ) {
-		sound = emitters[i];
-
-		if ( !sound ) {
-			continue;
-		}
+	// the active list is only changed inside the critical section the mixer runs in
+	numEmittersMixed = 0;
+	for ( sound = activeEmitters.Next(); sound != NULL; sound = sound->activeNode.Next() ) {
 		// if no channels are active, do nothing
 		if ( !sound->playing ) {
 			continue;
 		}
-		// run through all the channels
+		numEmittersMixed++;
+
+		// run through the channels that were triggered or still have to release their source
 		for ( j = 0; j < SOUND_MAX_CHANNELS ; j++ ) {
 			idSoundChannel	*chan = &sound->channels[j];
 
+			if ( !( sound->mixChannels & BIT( j ) ) ) {
+				continue;
+			}
+
 			// see if we have a sound triggered on this channel
 			if ( !chan->triggerState ) {
 				chan->ALStop();
@@ -1154,8 +1178,8 @@ idSoundWorldLocal::ForegroundUpdate
 ==================
 */
 void idSoundWorldLocal::ForegroundUpdate( int current44kHzTime ) {
-	int j, k;
-	idSoundEmitterLocal	*def;
+	int k;
+	idSoundEmitterLocal	*def, *next;
 
 	if ( !soundSystemLocal.isInitialized ) {
 		return;
@@ -1173,15 +1197,18 @@ void idSoundWorldLocal::ForegroundUpdate( int current44kHzTime ) {
 	// speed up by checking maxdistance to origin
 	// although the sound may still need to play if it has
 	// just become occluded so it can ramp down to 0
+	// only the emitters that are playing or waiting to be freed are in the active list
 	//
-	for ( j = 1; j < emitters.Num(); j++ ) {
-		def = emitters[j];
+	numEmittersVisited = 0;
+	for ( def = activeEmitters.Next(); def != NULL; def = next ) {
+		next = def->activeNode.Next();
+		numEmittersVisited++;
 
 		if ( def->removeStatus >= REMOVE_STATUS_SAMPLEFINISHED ) {
 			continue;
 		}
 
-		// see if our last channel just finished
+		// see if our last channel just finished, this drops it from the active list
 		def->CheckForCompletion( current44kHzTime );
 
 		if ( !def->playing ) {
@@ -1236,6 +1263,13 @@ void idSoundWorldLocal::ForegroundUpdate( int current44kHzTime ) {
 		}
 	}
 
+	if ( idSoundSystemLocal::s_showEmitterStats.GetBool() ) {
+		common->Printf( "sound emitters: %d allocated, %d visited, %d mixed\n", emitters.Num() - 1, numEmittersVisited, numEmittersMixed );
+		common->Printf( "sound spatialization: %d cached, %d portal floods\n", numSpatialCacheHits, numSpatialRecomputes );
+	}
+	numSpatialCacheHits = 0;
+	numSpatialRecomputes = 0;
+
 	Sys_LeaveCriticalSection();
 
 	//
@@ -1524,6 +1558,8 @@ void idSoundWorldLocal::ReadFromSaveGame( idFile *savefile ) {
 			// next command
 			savefile->ReadInt( channel );
 		}
+
+		def->UpdateActiveState();
 	}
 
 	if ( session->GetSaveGameVersion() >= 17 ) {
@@ -187,6 +187,50 @@ void Sys_Mkdir( const char *path ) {
 	mkdir(path, 0777);
 }
 
+/*
+================
+Sys_MapFile
+
+Reading a page of the mapping raises SIGBUS instead of returning an error if the
+file was truncated in place after mapping it. The mission downloader replaces pk4s
+by removing the old file and renaming the new one, which keeps the mapped inode
+alive, so only outside tools rewriting a pk4 in place while the game runs hit this.
+================
+*/
+const void *Sys_MapFile( const char *path, int *length ) {
+	int fd = open( path, O_RDONLY );
+	if ( fd == -1 ) {
+		return NULL;
+	}
+
+	struct stat st;
+	if ( fstat( fd, &st ) == -1 || st.st_size <= 0 || st.st_size > 0x7fffffff ) {
+		close( fd );
+		return NULL;
+	}
+
+	void *data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	// the mapping stays valid after closing the descriptor
+	close( fd );
+	if ( data == MAP_FAILED ) {
+		return NULL;
+	}
+
+	*length = (int)st.st_size;
+	return data;
+}
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile( const void *data, int length ) {
+	if ( data ) {
+		munmap( const_cast<void *>( data ), length );
+	}
+}
+
 /*
 ================
 Sys_ListFiles
@@ -123,6 +123,13 @@ sysEvent_t	Sys_GetEvent( void ) {
 void	Sys_Mkdir( const char *path ) {
 }
 
+const void *Sys_MapFile( const char *path, int *length ) {
+	return NULL;
+}
+
+void	Sys_UnmapFile( const void *data, int length ) {
+}
+
 const char *Sys_DefaultCDPath(void) {
 	return "";
 }
@@ -387,6 +387,9 @@ void			Sys_ShowConsole( int visLevel, bool quitOnClose );
 
 void			Sys_Mkdir( const char *path );
 ID_TIME_T		Sys_FileTimeStamp( FILE *fp );
+// maps a whole file read only into memory, returns NULL on failure
+const void *	Sys_MapFile( const char *path, int *length );
+void			Sys_UnmapFile( const void *data, int length );
 ID_TIME_T       Sys_DosToUnixTime( unsigned long dostime );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
@@ -1029,3 +1029,95 @@ void RunReach_f( const idCmdArgs &args ) {
 	common->SetRefreshOnPrint( false );
 	common->PrintWarnings();
 }
+
+/*
+============
+ConvertAASFile
+
+Writes the binary copy of a single text AAS file, returns false if the file could not be loaded.
+============
+*/
+static bool ConvertAASFile( const idStr &fileName ) {
+	idAASFileLocal file;
+
+	if ( file.LoadBinary( fileName, 0 ) ) {
+		common->Printf( "%s is up to date\n", fileName.c_str() );
+		return true;
+	}
+	if ( !file.Load( fileName, 0 ) ) {
+		common->Warning( "Unable to load %s", fileName.c_str() );
+		return false;
+	}
+	// loading the text file already wrote the copy unless that is disabled
+	if ( !aas_useBinaryFile.GetBool() ) {
+		file.WriteBinary( fileName );
+	}
+	return true;
+}
+
+/*
+============
+ConvertAAS_f
+============
+*/
+void ConvertAAS_f( const idCmdArgs &args ) {
+	idAASSettings settings;
+	idStr mapName, fileName;
+	idFileList *aasFiles;
+	int i, numFiles;
+
+	if ( args.Argc() > 2 ) {
+		common->Printf( "convertAAS [mapfile]\n"
+					"writes binary copies of the AAS files of a map, or of all maps if none is given\n" );
+		return;
+	}
+
+	if ( args.Argc() == 2 ) {
+		mapName = args.Argv( 1 );
+		mapName.BackSlashesToSlashes();
+		if ( mapName.Icmpn( "maps/", 4 ) != 0 ) {
+			mapName = "maps/" + mapName;
+		}
+	}
+
+	// get the aas settings definitions
+	const idDict *dict = gameEdit->FindEntityDefDict( "aas_types", false );
+	if ( !dict ) {
+		common->Error( "Unable to find entityDef for 'aas_types'" );
+	}
+
+	idTimer timer;
+	timer.Start();
+
+	numFiles = 0;
+	const idKeyValue *kv = dict->MatchPrefix( "type" );
+	while( kv != NULL ) {
+		const idDict *settingsDict = gameEdit->FindEntityDefDict( kv->GetValue(), false );
+		if ( !settingsDict ) {
+			common->Warning( "Unable to find '%s' in def/aas.def", kv->GetValue().c_str() );
+		} else {
+			settings.FromDict( kv->GetValue(), settingsDict );
+			if ( mapName.Length() ) {
+				fileName = mapName;
+				fileName.SetFileExtension( settings.fileExtension );
+				// not every map has a file for every size
+				if ( fileSystem->ReadFile( fileName, NULL ) >= 0 && ConvertAASFile( fileName ) ) {
+					numFiles++;
+				}
+			} else {
+				aasFiles = fileSystem->ListFiles( "maps", idStr( "." ) + settings.fileExtension, true, true );
+				for ( i = 0; i < aasFiles->GetNumFiles(); i++ ) {
+					if ( ConvertAASFile( aasFiles->GetFile( i ) ) ) {
+						numFiles++;
+					}
+				}
+				fileSystem->FreeFileList( aasFiles );
+			}
+		}
+
+		kv = dict->MatchPrefix( "type", kv );
+	}
+
+	timer.Stop();
+	common->Printf( "%d AAS files converted in %.0f ms\n", numFiles, timer.Milliseconds() );
+}
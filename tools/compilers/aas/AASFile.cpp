@@ -553,6 +553,11 @@ bool idAASSettings::ValidEntity( const char *classname ) const {
 #define AAS_VERTEX_GRANULARITY	4096
 #define AAS_EDGE_GRANULARITY	4096
 
+#define AAS_BINARY_FILEID		"DewmAASBinary"
+#define AAS_BINARY_FILEVERSION	1
+
+idCVar aas_useBinaryFile( "aas_useBinaryFile", "1", CVAR_SYSTEM | CVAR_BOOL, "load AAS files from a binary copy, written when the text file is loaded" );
+
 /*
 ================
 idAASFileLocal::idAASFileLocal
@@ -1097,6 +1102,11 @@ bool idAASFileLocal::Load( const idStr &fileName, const unsigned int mapFileCRC
 	common->Printf( "[Load AAS]\n" );
 	common->Printf( "loading %s\n", name.c_str() );
 
+	if ( aas_useBinaryFile.GetBool() && LoadBinary( name, mapFileCRC ) ) {
+		common->Printf( "done.\n" );
+		return true;
+	}
+
 	if ( !src.LoadFile( name ) ) {
 		return false;
 	}
@@ -1121,6 +1131,7 @@ bool idAASFileLocal::Load( const idStr &fileName, const unsigned int mapFileCRC
 		common->Warning( "AAS file '%s' is out of date (mapFileCRC %u vs. token CRC %u)", name.c_str(), mapFileCRC, c );
 		return false;
 	}
+	crc = c;
 
 	// clear the file in memory
 	Clear();
@@ -1180,11 +1191,299 @@ bool idAASFileLocal::Load( const idStr &fileName, const unsigned int mapFileCRC
 		src.Error( "idAASFileLocal::Load: tree depth = %d", depth );
 	}
 
+	if ( aas_useBinaryFile.GetBool() ) {
+		WriteBinary( name );
+	}
+
 	common->Printf( "done.\n" );
 
 	return true;
 }
 
+/*
+===============================================================================
+
+	Binary AAS file
+
+	A copy of the text file written after it was parsed. All arrays are stored
+	as they are in memory and read back with a single read each, reachabilities
+	are stored as one array of flat records. The copy is only used while the
+	text file it was made from is unchanged and ends with a CRC of its contents.
+
+===============================================================================
+*/
+
+typedef struct aasBinaryReach_s {
+	int							travelType;
+	int							toAreaNum;
+	idVec3						start;
+	idVec3						end;
+	int							edgeNum;
+	int							travelTime;
+} aasBinaryReach_t;
+
+/*
+================
+AAS_BinaryFileName
+
+maps/name.aas32 is stored as maps/name.baas32
+================
+*/
+static idStr AAS_BinaryFileName( const idStr &fileName ) {
+	idStr extension, binaryName;
+
+	fileName.ExtractFileExtension( extension );
+	binaryName = fileName;
+	binaryName.SetFileExtension( "b" + extension );
+	return binaryName;
+}
+
+/*
+================
+AAS_WriteList
+================
+*/
+template< class type >
+static void AAS_WriteList( idFile *fp, const idList<type> &list ) {
+	fp->WriteInt( list.Num() );
+	fp->Write( list.Ptr(), list.Num() * sizeof( type ) );
+}
+
+/*
+================
+AAS_ReadList
+================
+*/
+template< class type >
+static bool AAS_ReadList( idFile *fp, idList<type> &list ) {
+	int num;
+
+	if ( fp->ReadInt( num ) != sizeof( num ) || num < 0 || num > ( fp->Length() - fp->Tell() ) / (int)sizeof( type ) ) {
+		return false;
+	}
+	list.SetNum( num );
+	return fp->Read( list.Ptr(), num * sizeof( type ) ) == num * (int)sizeof( type );
+}
+
+/*
+================
+idAASFileLocal::WriteBinary
+
+Writes the binary copy of the text AAS file with the given name.
+================
+*/
+bool idAASFileLocal::WriteBinary( const idStr &fileName ) const {
+	idStr binaryName;
+	ID_TIME_T timestamp;
+	int i, length, numReach;
+	idReachability *reach;
+
+	length = fileSystem->ReadFile( fileName, NULL, &timestamp );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	binaryName = AAS_BinaryFileName( fileName );
+
+	idFile_Memory fp( binaryName );
+	fp.SetGranularity( 1 << 20 );
+
+	fp.WriteString( AAS_BINARY_FILEID );
+	fp.WriteInt( AAS_BINARY_FILEVERSION );
+	fp.WriteUnsignedInt( crc );
+	// the text file this copy was made from
+	fp.WriteInt( length );
+	fp.Write( &timestamp, sizeof( timestamp ) );
+	// the arrays are stored as they are in memory
+	fp.WriteInt( sizeof( aasArea_t ) );
+	fp.WriteInt( sizeof( aasFace_t ) );
+
+	// the settings are small, keep them in the text format
+	idFile_Memory settingsText( "settings" );
+	settings.WriteToFile( &settingsText );
+	fp.WriteInt( settingsText.Length() );
+	fp.Write( settingsText.GetDataPtr(), settingsText.Length() );
+
+	AAS_WriteList( &fp, planeList );
+	AAS_WriteList( &fp, vertices );
+	AAS_WriteList( &fp, edges );
+	AAS_WriteList( &fp, edgeIndex );
+	AAS_WriteList( &fp, faces );
+	AAS_WriteList( &fp, faceIndex );
+	AAS_WriteList( &fp, areas );
+	AAS_WriteList( &fp, nodes );
+	AAS_WriteList( &fp, portals );
+	AAS_WriteList( &fp, portalIndex );
+	AAS_WriteList( &fp, clusters );
+
+	// reachabilities per area in list order
+	idList<int> areaNumReach;
+	idList<aasBinaryReach_t> binaryReach;
+	areaNumReach.SetNum( areas.Num() );
+	binaryReach.SetGranularity( 4096 );
+	for ( i = 0; i < areas.Num(); i++ ) {
+		for ( numReach = 0, reach = areas[i].reach; reach; reach = reach->next ) {
+			aasBinaryReach_t &r = binaryReach.Alloc();
+			r.travelType = reach->travelType;
+			r.toAreaNum = reach->toAreaNum;
+			r.start = reach->start;
+			r.end = reach->end;
+			r.edgeNum = reach->edgeNum;
+			r.travelTime = reach->travelTime;
+			numReach++;
+		}
+		areaNumReach[i] = numReach;
+	}
+	AAS_WriteList( &fp, areaNumReach );
+	AAS_WriteList( &fp, binaryReach );
+
+	// special reachabilities keep their key/values
+	for ( i = 0; i < areas.Num(); i++ ) {
+		for ( reach = areas[i].reach; reach; reach = reach->next ) {
+			if ( reach->travelType == TFL_SPECIAL ) {
+				static_cast<idReachability_Special *>(reach)->dict.WriteToFileHandle( &fp );
+			}
+		}
+	}
+
+	fp.WriteUnsignedInt( CRC32_BlockChecksum( fp.GetDataPtr(), fp.Length() ) );
+
+	return fileSystem->WriteFile( binaryName, fp.GetDataPtr(), fp.Length() ) == fp.Length();
+}
+
+/*
+================
+idAASFileLocal::LoadBinary
+
+Loads the binary copy of the text AAS file with the given name.
+Returns false if there is no valid copy for the current text file.
+================
+*/
+bool idAASFileLocal::LoadBinary( const idStr &fileName, const unsigned int mapFileCRC ) {
+	idStr binaryName, ident;
+	char *buffer;
+	ID_TIME_T timestamp, textTimestamp;
+	int i, j, length, textLength, version, areaSize, faceSize, settingsLength, numReach;
+	unsigned int fileCRC, storedCRC;
+	bool valid;
+
+	binaryName = AAS_BinaryFileName( fileName );
+
+	length = fileSystem->ReadFile( binaryName, (void **)&buffer );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	// the lists are filled straight from the file, so the whole file has to match its checksum
+	storedCRC = 0;
+	if ( length >= (int)sizeof( storedCRC ) ) {
+		length -= sizeof( storedCRC );
+		memcpy( &storedCRC, buffer + length, sizeof( storedCRC ) );
+	}
+	if ( length <= 0 || CRC32_BlockChecksum( buffer, length ) != storedCRC ) {
+		common->Warning( "AAS file '%s' is broken", binaryName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	idFile_Memory fp( binaryName, (const char *)buffer, length );
+
+	fp.ReadString( ident );
+	fp.ReadInt( version );
+	fp.ReadUnsignedInt( fileCRC );
+	fp.ReadInt( textLength );
+	fp.Read( &timestamp, sizeof( timestamp ) );
+	fp.ReadInt( areaSize );
+	fp.ReadInt( faceSize );
+	if ( ident != AAS_BINARY_FILEID || version != AAS_BINARY_FILEVERSION ||
+			areaSize != sizeof( aasArea_t ) || faceSize != sizeof( aasFace_t ) ) {
+		common->Printf( "AAS file '%s' has a different version\n", binaryName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	// a missing text file is fine, otherwise the copy has to be made from the current one
+	if ( mapFileCRC && fileCRC != mapFileCRC ) {
+		common->Printf( "AAS file '%s' is out of date\n", binaryName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+	length = fileSystem->ReadFile( fileName, NULL, &textTimestamp );
+	if ( length >= 0 && ( length != textLength || textTimestamp != timestamp ) ) {
+		common->Printf( "AAS file '%s' is out of date\n", binaryName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	Clear();
+	crc = fileCRC;
+
+	fp.ReadInt( settingsLength );
+	idLexer src( buffer + fp.Tell(), settingsLength, binaryName, LEXFL_NOFATALERRORS | LEXFL_NOSTRINGESCAPECHARS | LEXFL_NOSTRINGCONCAT | LEXFL_ALLOWPATHNAMES );
+	valid = settings.FromParser( src );
+	fp.Seek( settingsLength, FS_SEEK_CUR );
+
+	valid = valid && AAS_ReadList( &fp, planeList );
+	valid = valid && AAS_ReadList( &fp, vertices );
+	valid = valid && AAS_ReadList( &fp, edges );
+	valid = valid && AAS_ReadList( &fp, edgeIndex );
+	valid = valid && AAS_ReadList( &fp, faces );
+	valid = valid && AAS_ReadList( &fp, faceIndex );
+	valid = valid && AAS_ReadList( &fp, areas );
+	valid = valid && AAS_ReadList( &fp, nodes );
+	valid = valid && AAS_ReadList( &fp, portals );
+	valid = valid && AAS_ReadList( &fp, portalIndex );
+	valid = valid && AAS_ReadList( &fp, clusters );
+
+	idList<int> areaNumReach;
+	idList<aasBinaryReach_t> binaryReach;
+	valid = valid && AAS_ReadList( &fp, areaNumReach ) && areaNumReach.Num() == areas.Num();
+	valid = valid && AAS_ReadList( &fp, binaryReach );
+
+	for ( i = 0; i < areas.Num(); i++ ) {
+		areas[i].reach = NULL;
+		areas[i].rev_reach = NULL;
+	}
+
+	if ( valid ) {
+		const aasBinaryReach_t *r = binaryReach.Ptr();
+		for ( i = 0; i < areas.Num(); i++ ) {
+			idReachability **tail = &areas[i].reach;
+			for ( j = 0, numReach = areaNumReach[i]; j < numReach; j++, r++ ) {
+				idReachability *newReach;
+				if ( r->travelType == TFL_SPECIAL ) {
+					idReachability_Special *special = new idReachability_Special();
+					special->dict.ReadFromFileHandle( &fp );
+					newReach = special;
+				} else {
+					newReach = new idReachability();
+				}
+				newReach->travelType = r->travelType;
+				newReach->toAreaNum = r->toAreaNum;
+				newReach->start = r->start;
+				newReach->end = r->end;
+				newReach->edgeNum = r->edgeNum;
+				newReach->travelTime = r->travelTime;
+				newReach->fromAreaNum = i;
+				newReach->next = NULL;
+				*tail = newReach;
+				tail = &newReach->next;
+			}
+		}
+		LinkReversedReachability();
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !valid ) {
+		common->Warning( "AAS file '%s' is broken", binaryName.c_str() );
+		Clear();
+		return false;
+	}
+
+	return true;
+}
+
 /*
 ================
 idAASFileLocal::MemorySize
@@ -51,6 +51,8 @@ public:
 public:
 	bool						Load( const idStr &fileName, const unsigned int mapFileCRC );
 	bool						Write( const idStr &fileName, const unsigned int mapFileCRC );
+	bool						LoadBinary( const idStr &fileName, const unsigned int mapFileCRC );
+	bool						WriteBinary( const idStr &fileName ) const;
 
 	int							MemorySize( void ) const;
 	void						ReportRoutingEfficiency( void ) const;
@@ -83,4 +85,6 @@ private:
 	int							NumReachabilities( void ) const;
 };
 
+extern idCVar aas_useBinaryFile;
+
 #endif /* !__AASFILELOCAL_H__ */